@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bump allocator over one zeroed, cache-line aligned reservation made up front.
+// Every allocation starts on its own cache line and nothing is freed until the
+// arena goes away. A default-constructed arena reserves nothing and only counts,
+// so the exact size of a set of objects can be measured before reserving it.
+class Arena
+{
+public:
+    static constexpr size_t ALIGN = 64;
+
+    Arena() : base(nullptr), capacity(0), offset(0) {}
+    explicit Arena(size_t bytes) : base(nullptr), capacity(round(bytes)), offset(0)
+    {
+        if (capacity > 0)
+        {
+            base = (unsigned char *)::operator new(capacity, std::align_val_t(ALIGN));
+            std::memset(base, 0, capacity); // Touch every page now, not on the audio thread
+        }
+    }
+    ~Arena()
+    {
+        if (base)
+            ::operator delete(base, std::align_val_t(ALIGN));
+    }
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // Zeroed storage for `count` objects; T must be trivially constructible.
+    // Returns nullptr from a measuring arena.
+    template <typename T>
+    T *allocate(size_t count)
+    {
+        size_t start = offset;
+        offset += round(count * sizeof(T));
+        if (!base)
+            return nullptr;
+        if (offset > capacity)
+            throw std::bad_alloc();
+        return (T *)(base + start);
+    }
+
+    bool measuring() const { return base == nullptr; }
+    size_t used() const { return offset; }
+    size_t size() const { return capacity; }
+
+    // Bytes a T built as T(arena, args...) takes from its arena
+    template <typename T, typename... Args>
+    static size_t footprint(Args &&...args)
+    {
+        Arena counter;
+        T probe(counter, std::forward<Args>(args)...);
+        return counter.used();
+    }
+
+private:
+    unsigned char *base;
+    size_t capacity;
+    size_t offset;
+
+    static size_t round(size_t bytes) { return (bytes + ALIGN - 1) / ALIGN * ALIGN; }
+};
+
+// Fixed set of slots for objects created and destroyed at run time. Storage
+// comes from an arena; acquire/release are O(1) through an index free list.
+// Objects still live when the pool goes away are simply dropped with the arena.
+template <typename T>
+class Pool
+{
+    static_assert(std::is_trivially_destructible<T>::value, "pooled objects are never destroyed");
+
+public:
+    Pool(Arena &arena, int capacity)
+        : slots(arena.allocate<Slot>(capacity)), next(arena.allocate<int>(capacity)),
+          capacity(capacity), freeHead(-1), live(0)
+    {
+        if (!slots)
+            return;
+        for (int i = capacity - 1; i >= 0; --i)
+        {
+            next[i] = freeHead;
+            freeHead = i;
+        }
+    }
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    // nullptr when every slot is taken; the caller decides what to steal
+    template <typename... Args>
+    T *acquire(Args &&...args)
+    {
+        if (freeHead < 0)
+            return nullptr;
+        int i = freeHead;
+        freeHead = next[i];
+        ++live;
+        return new (&slots[i]) T(std::forward<Args>(args)...);
+    }
+
+    void release(T *object)
+    {
+        int i = (int)((Slot *)object - slots);
+        next[i] = freeHead;
+        freeHead = i;
+        --live;
+    }
+
+    int size() const { return live; }
+    int getCapacity() const { return capacity; }
+
+private:
+    struct alignas(T) Slot
+    {
+        unsigned char bytes[sizeof(T)];
+    };
+
+    Slot *slots;
+    int *next;
+    int capacity;
+    int freeHead;
+    int live;
+};
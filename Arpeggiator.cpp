@@ -0,0 +1,124 @@
+#include "Arpeggiator.hpp"
+#include <algorithm>
+
+Arpeggiator::Arpeggiator()
+    : enabled(false), mode(Mode::Up), octaves(1), bpm(120.0f), stepsPerBeat(4), gate(0.5f),
+      sampleRate(44100.0f), held(), velocities(), count(0), position(0), playing(-1),
+      nextStep(0.0), nextOff(NEVER), rng(0x9E3779B9u) {}
+
+void Arpeggiator::prepare(float sr)
+{
+    sampleRate = sr;
+}
+
+void Arpeggiator::noteOn(int note, int velocity, uint64_t now)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (held[i] == note)
+            return;
+    }
+    if (count == MAX_NOTES)
+        return;
+    // First key of a new phrase starts the grid right here
+    if (count == 0)
+    {
+        nextStep = (double)now;
+        position = 0;
+    }
+    held[count] = (int8_t)note;
+    velocities[count] = (uint8_t)velocity;
+    ++count;
+}
+
+void Arpeggiator::noteOff(int note)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (held[i] == note)
+        {
+            std::copy(held + i + 1, held + count, held + i);
+            std::copy(velocities + i + 1, velocities + count, velocities + i);
+            --count;
+            return;
+        }
+    }
+}
+
+void Arpeggiator::clear()
+{
+    count = 0;
+}
+
+int Arpeggiator::noteAt(int index, int &velocity) const
+{
+    // Order is rebuilt from the held set each step; at most MAX_NOTES entries
+    int8_t order[MAX_NOTES];
+    uint8_t vel[MAX_NOTES];
+    std::copy(held, held + count, order);
+    std::copy(velocities, velocities + count, vel);
+    if (mode != Mode::AsPlayed)
+    {
+        // Insertion sort, ascending; the set is tiny
+        for (int i = 1; i < count; ++i)
+        {
+            for (int j = i; j > 0 && order[j - 1] > order[j]; --j)
+            {
+                std::swap(order[j - 1], order[j]);
+                std::swap(vel[j - 1], vel[j]);
+            }
+        }
+    }
+
+    int length = count * octaveCount();
+    if (mode == Mode::Down)
+        index = length - 1 - index;
+    int octave = index / count;
+    int i = index % count;
+    velocity = vel[i];
+    return std::min(order[i] + 12 * octave, 127);
+}
+
+int Arpeggiator::process(uint64_t now, Event *out)
+{
+    int n = 0;
+    if (playing >= 0 && nextOff <= now)
+    {
+        out[n++] = {now, EventType::NoteOff, 0, (uint8_t)playing, 0, 0.0f};
+        playing = -1;
+        nextOff = NEVER;
+    }
+
+    if (count > 0 && (uint64_t)nextStep <= now)
+    {
+        // A step that starts before the last note ended cuts it
+        if (playing >= 0)
+            out[n++] = {now, EventType::NoteOff, 0, (uint8_t)playing, 0, 0.0f};
+
+        int length = count * octaveCount();
+        int index;
+        if (mode == Mode::Random)
+        {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            index = (int)(rng % (uint32_t)length);
+        }
+        else
+        {
+            index = position % length;
+            position = (position + 1) % length;
+        }
+
+        int velocity;
+        playing = noteAt(index, velocity);
+        out[n++] = {now, EventType::NoteOn, 0, (uint8_t)playing, (uint8_t)velocity, 0.0f};
+
+        double step = stepLength();
+        nextOff = now + std::max<uint64_t>(1, (uint64_t)(step * std::min(std::max(gate, 0.05f), 1.0f)));
+        nextStep += step;
+        if ((uint64_t)nextStep <= now) // Tempo jumped; resync instead of firing a burst
+            nextStep = (double)now + step;
+    }
+    return n;
+}
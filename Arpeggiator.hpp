@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include "Event.hpp"
+
+// Tempo-synced arpeggiator that runs inside Engine::render. Incoming note
+// events update the held set; process() returns the note events due at the
+// current sample, and nextEventTime() tells the engine where to split the
+// block so each step lands on its exact sample.
+class Arpeggiator
+{
+public:
+    enum class Mode : uint8_t
+    {
+        Up,
+        Down,
+        Random,
+        AsPlayed
+    };
+
+    static constexpr int MAX_NOTES = 16;
+    static constexpr int MAX_OCTAVES = 4;
+    static constexpr uint64_t NEVER = ~(uint64_t)0;
+
+    bool enabled;
+    Mode mode;
+    int octaves;      // 1..MAX_OCTAVES
+    float bpm;
+    int stepsPerBeat; // 4 = sixteenths
+    float gate;       // Note length as a fraction of a step
+
+    Arpeggiator();
+    void prepare(float sampleRate);
+    void noteOn(int note, int velocity, uint64_t now);
+    void noteOff(int note);
+    // Forgets the held set; the sounding note still gets its note-off from process()
+    void clear();
+    bool sounding() const { return playing >= 0; }
+
+    // Writes the events due at `now` (at most two: a note-off and a note-on) and returns the count
+    int process(uint64_t now, Event *out);
+    uint64_t nextEventTime() const { return std::min(nextOff, stepTime()); }
+
+private:
+    float sampleRate;
+    int8_t held[MAX_NOTES]; // In the order they were pressed
+    uint8_t velocities[MAX_NOTES];
+    int count;
+    int position; // Index into the current order
+    int playing;  // Note currently sounding, or -1
+    double nextStep; // Sample time of the next step; double so the tempo grid never drifts
+    uint64_t nextOff;
+    uint32_t rng;
+
+    uint64_t stepTime() const { return count > 0 ? (uint64_t)nextStep : NEVER; }
+    double stepLength() const { return sampleRate * 60.0 / (bpm * stepsPerBeat); }
+    int octaveCount() const { return std::max(1, std::min(octaves, MAX_OCTAVES)); }
+    int noteAt(int index, int &velocity) const;
+};
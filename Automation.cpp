@@ -0,0 +1,154 @@
+#include "Automation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    const char MAGIC[4] = {'G', 'S', 'A', 'U'};
+
+    // LEB128: seven bits per byte, high bit set on all but the last
+    size_t readVarint(const uint8_t *p, size_t size, size_t offset, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; offset < size && shift < 64; shift += 7)
+        {
+            uint8_t b = p[offset++];
+            value |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return offset;
+        }
+        return 0; // Truncated
+    }
+}
+
+Automation::Reader::Reader(const Automation &automation)
+    : data(automation.data.data()), size(automation.data.size()), offset(0), time(0) {}
+
+uint64_t Automation::Reader::nextTime() const
+{
+    uint64_t delta;
+    readVarint(data, size, offset, delta);
+    return time + delta;
+}
+
+Automation::Point Automation::Reader::next()
+{
+    uint64_t delta;
+    offset = readVarint(data, size, offset, delta);
+    time += delta;
+    Point p{time, (Param)data[offset], (data[offset + 1] | (data[offset + 2] << 8)) / 65535.0f};
+    offset += 3;
+    return p;
+}
+
+Automation::Automation() : count(0), lastTime(0), laneMask(0), lastValue() {}
+
+void Automation::record(uint64_t time, Param param, float value)
+{
+    uint16_t q = (uint16_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f);
+    if (hasLane(param) && lastValue[(int)param] == q)
+        return;
+    append(std::max(time, lastTime), param, q);
+}
+
+void Automation::append(uint64_t time, Param param, uint16_t value)
+{
+    for (uint64_t delta = time - lastTime; ; delta >>= 7)
+    {
+        uint8_t b = delta & 0x7f;
+        if (delta < 0x80)
+        {
+            data.push_back(b);
+            break;
+        }
+        data.push_back(b | 0x80);
+    }
+    data.push_back((uint8_t)param);
+    data.push_back((uint8_t)value);
+    data.push_back((uint8_t)(value >> 8));
+
+    lastTime = time;
+    laneMask |= 1u << (int)param;
+    lastValue[(int)param] = value;
+    ++count;
+}
+
+void Automation::clear()
+{
+    data.clear();
+    count = 0;
+    lastTime = 0;
+    laneMask = 0;
+}
+
+void Automation::clearLane(Param param)
+{
+    if (!hasLane(param))
+        return;
+    // Re-encode the other lanes; their deltas change around the removed points
+    Automation kept;
+    kept.data.reserve(data.size());
+    for (Reader r(*this); !r.done();)
+    {
+        Point p = r.next();
+        if (p.param != param)
+            kept.append(p.time, p.param, (uint16_t)std::lround(p.value * 65535.0f));
+    }
+    *this = std::move(kept);
+}
+
+bool Automation::save(const std::string &path, std::string &error) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "cannot create " + path;
+        return false;
+    }
+    file.write(MAGIC, sizeof(MAGIC));
+    file.write((const char *)data.data(), data.size());
+    if (!file)
+    {
+        error = "write failed for " + path;
+        return false;
+    }
+    return true;
+}
+
+bool Automation::load(const std::string &path, std::string &error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < sizeof(MAGIC) || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0)
+    {
+        error = "not an automation file";
+        return false;
+    }
+
+    // Rebuild through append() so a damaged stream is caught here, not on the audio thread
+    Automation loaded;
+    uint64_t time = 0;
+    for (size_t offset = sizeof(MAGIC); offset < bytes.size();)
+    {
+        uint64_t delta;
+        offset = readVarint(bytes.data(), bytes.size(), offset, delta);
+        if (offset == 0 || offset + 3 > bytes.size() || bytes[offset] >= (uint8_t)Param::Count)
+        {
+            error = "corrupt automation data in " + path;
+            return false;
+        }
+        time += delta;
+        loaded.append(time, (Param)bytes[offset], (uint16_t)(bytes[offset + 1] | (bytes[offset + 2] << 8)));
+        offset += 3;
+    }
+    *this = std::move(loaded);
+    return true;
+}
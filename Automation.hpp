@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Event.hpp"
+
+// Recorded parameter movements, one lane per Param, stored as a single
+// time-ordered byte stream: a varint sample delta, the parameter, and the value
+// as 16 bits of its 0..1 range. Points that repeat a lane's last value are not
+// stored. Replay walks the stream with a Reader, so its cost follows the number
+// of points, not the number of lanes.
+class Automation
+{
+public:
+    struct Point
+    {
+        uint64_t time; // Samples from the start of the take
+        Param param;
+        float value;   // 0..1 within the parameter's range
+    };
+
+    // Forward cursor over the stream; no allocation, safe on the audio thread
+    class Reader
+    {
+    public:
+        Reader() : data(nullptr), size(0), offset(0), time(0) {}
+        explicit Reader(const Automation &automation);
+        bool done() const { return offset >= size; }
+        uint64_t nextTime() const; // Time of the next point; only valid while !done()
+        Point next();
+
+    private:
+        const uint8_t *data;
+        size_t size;
+        size_t offset;
+        uint64_t time; // Of the last point read
+    };
+
+    Automation();
+    // Times must not go backwards
+    void record(uint64_t time, Param param, float value);
+    void clear();
+    void clearLane(Param param);
+    bool hasLane(Param param) const { return laneMask & (1u << (int)param); }
+    size_t points() const { return count; }
+    size_t bytes() const { return data.size(); }
+    uint64_t length() const { return lastTime; }
+
+    bool save(const std::string &path, std::string &error) const;
+    bool load(const std::string &path, std::string &error);
+
+private:
+    std::vector<uint8_t> data;
+    size_t count;
+    uint64_t lastTime;
+    unsigned laneMask;                   // Bit per Param with at least one point
+    uint16_t lastValue[(int)Param::Count]; // Per lane, for dropping repeats
+
+    void append(uint64_t time, Param param, uint16_t value);
+};
@@ -0,0 +1,806 @@
+#include "Benchmark.hpp"
+#include "Synth.hpp"
+#include "RenderKernels.hpp"
+#include "EffectsChain.hpp"
+#include "ConvolutionReverb.hpp"
+#include "Limiter.hpp"
+#include "Resampler.hpp"
+#include "Sampler.hpp"
+#include "Sequencer.hpp"
+#include "Engine.hpp"
+#include "Stereo.hpp"
+#include "FastMath.hpp"
+#include <memory>
+#include "WavFile.hpp"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const char *waveNames[4] = {"SINE", "SQUARE", "TRIANGLE", "SAW"};
+    const char *targetNames[4] = {"OFF", "PITCH", "AMP", "FILTER"};
+
+    // Nanoseconds per rendered frame for `frames` frames produced by `render`
+    template <typename Fn>
+    double timePerFrame(int frames, Fn render)
+    {
+        auto start = std::chrono::steady_clock::now();
+        render();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / frames;
+    }
+
+    void setupSynth(Synth &synth, WaveForm::Type wave, LFOTarget target, WaveForm::Type lfoWave)
+    {
+        synth.waveType = wave;
+        synth.lfo.target = target;
+        synth.lfo.waveform = lfoWave;
+        synth.lfo.enabled = (target != LFOTarget::None);
+        synth.setFrequency(440.0f);
+        synth.env.noteOn();
+    }
+
+    void benchRenderKernels(int sampleRate)
+    {
+        const int seconds = 2;
+        const int frames = sampleRate * seconds;
+        const float dt = 1.0f / sampleRate;
+        float block[Synth::MAX_BLOCK];
+        double sink = 0.0;
+
+        std::cout << "== Render kernels: branching Synth::process vs block kernel (ns/frame)\n";
+        std::cout << std::left << std::setw(10) << "wave" << std::setw(8) << "target" << std::setw(10) << "lfo wave"
+                  << std::right << std::setw(10) << "branch" << std::setw(10) << "kernel" << std::setw(10) << "speed-up" << "\n";
+
+        for (int w = 0; w < RenderKernels::NUM_WAVES; ++w)
+        {
+            for (int t = 0; t < RenderKernels::NUM_TARGETS; ++t)
+            {
+                for (int l = 0; l < RenderKernels::NUM_WAVES; ++l)
+                {
+                    auto wave = static_cast<WaveForm::Type>(w);
+                    auto target = static_cast<LFOTarget>(t);
+                    auto lfoWave = static_cast<WaveForm::Type>(l);
+
+                    Synth branching;
+                    setupSynth(branching, wave, target, lfoWave);
+                    double branchNs = timePerFrame(frames, [&]
+                                                   {
+                        for (int i = 0; i < frames; ++i)
+                            sink += branching.process(dt); });
+
+                    Synth blocked;
+                    setupSynth(blocked, wave, target, lfoWave);
+                    double kernelNs = timePerFrame(frames, [&]
+                                                   {
+                        for (int done = 0; done < frames; done += Synth::MAX_BLOCK)
+                        {
+                            blocked.processBlock(block, Synth::MAX_BLOCK, dt);
+                            sink += block[0];
+                        } });
+
+                    std::cout << std::left << std::setw(10) << waveNames[w] << std::setw(8) << targetNames[t]
+                              << std::setw(10) << waveNames[l] << std::right << std::fixed << std::setprecision(2)
+                              << std::setw(10) << branchNs << std::setw(10) << kernelNs
+                              << std::setw(9) << branchNs / kernelNs << "x\n";
+                }
+            }
+        }
+        std::cout << "(checksum " << sink << ")\n\n";
+    }
+
+    void benchUnison(int sampleRate)
+    {
+        const int numVoices = 16;
+        const int blocks = 400;
+        const float dt = 1.0f / sampleRate;
+        const double budgetNs = 1e9 * Synth::MAX_BLOCK / sampleRate;
+        const int stacks[3] = {1, 8, 16};
+        float block[Synth::MAX_BLOCK];
+        double sink = 0.0;
+
+        std::cout << "== Unison: " << numVoices << " voices, " << Synth::MAX_BLOCK << "-frame blocks\n";
+        std::cout << std::left << std::setw(10) << "wave" << std::setw(8) << "unison"
+                  << std::right << std::setw(14) << "us/block" << std::setw(10) << "load" << "\n";
+
+        for (int w = 0; w < RenderKernels::NUM_WAVES; ++w)
+        {
+            for (int stack : stacks)
+            {
+                Synth voices[numVoices];
+                for (int v = 0; v < numVoices; ++v)
+                {
+                    setupSynth(voices[v], static_cast<WaveForm::Type>(w), LFOTarget::Pitch, WaveForm::Sine);
+                    voices[v].setFrequency(110.0f * (1 + v));
+                    voices[v].unison.voices = stack;
+                    voices[v].noteOn();
+                }
+                double ns = timePerFrame(blocks, [&]
+                                         {
+                    for (int b = 0; b < blocks; ++b)
+                        for (int v = 0; v < numVoices; ++v)
+                        {
+                            voices[v].processBlock(block, Synth::MAX_BLOCK, dt);
+                            sink += block[0];
+                        } });
+                std::cout << std::left << std::setw(10) << waveNames[w] << std::setw(8) << stack << std::right
+                          << std::fixed << std::setprecision(2) << std::setw(14) << ns / 1000.0
+                          << std::setw(9) << 100.0 * ns / budgetNs << "%\n";
+            }
+        }
+        std::cout << "(checksum " << sink << ")\n\n";
+    }
+
+    void benchFM(int sampleRate)
+    {
+        const int numVoices = 16;
+        const int blocks = 400;
+        const float dt = 1.0f / sampleRate;
+        const double budgetNs = 1e9 * Synth::MAX_BLOCK / sampleRate;
+        float block[Synth::MAX_BLOCK];
+        double sink = 0.0;
+
+        // The operator sine on its own, against libm on the same arguments
+        std::vector<float> x(1 << 16), y(x.size());
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = -4.0f + 8.0f * i / x.size();
+        double libmNs = timePerFrame((int)x.size(), [&]
+                                     {
+            for (size_t i = 0; i < x.size(); ++i)
+                y[i] = std::sin(2.0f * (float)M_PI * x[i]); });
+        sink += y[1];
+        double sineNs = timePerFrame((int)x.size(), [&]
+                                     { FM::sine(x.data(), y.data(), (int)x.size()); });
+        sink += y[1];
+
+        std::cout << "== FM: " << numVoices << " four-operator voices, " << Synth::MAX_BLOCK << "-frame blocks\n";
+        std::cout << std::fixed << std::setprecision(2) << "sine: std::sin " << libmNs << " ns, FM::sine " << sineNs
+                  << " ns per value\n";
+        std::cout << std::left << std::setw(14) << "algorithm" << std::setw(10) << "feedback" << std::right
+                  << std::setw(14) << "us/block" << std::setw(10) << "load" << "\n";
+        for (int a : {0, 4, 7})
+        {
+            for (float feedback : {0.0f, 0.3f})
+            {
+                Synth voices[numVoices];
+                for (int v = 0; v < numVoices; ++v)
+                {
+                    voices[v].fm.enabled = true;
+                    voices[v].fm.algorithm = a;
+                    voices[v].fm.op[3].feedback = feedback;
+                    voices[v].setFrequency(110.0f * (1 + v));
+                    voices[v].noteOn();
+                }
+                double ns = timePerFrame(blocks, [&]
+                                         {
+                    for (int b = 0; b < blocks; ++b)
+                        for (int v = 0; v < numVoices; ++v)
+                        {
+                            voices[v].processBlock(block, Synth::MAX_BLOCK, dt);
+                            sink += block[0];
+                        } });
+                std::cout << std::left << std::setw(14) << FM::ALGORITHM_NAMES[a] << std::setw(10) << feedback
+                          << std::right << std::setw(14) << ns / 1000.0 << std::setw(9) << 100.0 * ns / budgetNs
+                          << "%\n";
+            }
+        }
+        std::cout << "(checksum " << sink << ")\n\n";
+    }
+
+    // ns per call of fn over xs, as throughput: the calls are independent, as they are in a block.
+    // Best of three passes, so a stray interrupt does not land in the table.
+    template <typename Fn>
+    double timePerCall(const std::vector<float> &xs, double &sink, Fn fn)
+    {
+        std::vector<float> ys(xs.size());
+        double ns = 1e30;
+        for (int pass = 0; pass < 3; ++pass)
+            ns = std::min(ns, timePerFrame((int)xs.size(), [&]
+                                           {
+                for (size_t i = 0; i < xs.size(); ++i)
+                    ys[i] = fn(xs[i]); }));
+        sink += ys[ys.size() / 3];
+        return ns;
+    }
+
+    template <typename Libm, typename Fast, typename Balanced, typename Accurate>
+    void benchMathRow(const char *name, float lo, float hi, double &sink, Libm libm, Fast fast, Balanced balanced,
+                      Accurate accurate)
+    {
+        std::vector<float> xs(1 << 16);
+        for (size_t i = 0; i < xs.size(); ++i)
+            xs[i] = lo + (hi - lo) * i / xs.size();
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << timePerCall(xs, sink, libm) << std::setw(10) << timePerCall(xs, sink, fast)
+                  << std::setw(10) << timePerCall(xs, sink, balanced) << std::setw(10) << timePerCall(xs, sink, accurate)
+                  << "\n";
+    }
+
+    void benchFastMath()
+    {
+        using P = FastMath::Precision;
+        double sink = 0.0;
+        std::cout << "== FastMath: ns per call, float libm vs each tier\n";
+        std::cout << std::left << std::setw(12) << "function" << std::right << std::setw(10) << "libm"
+                  << std::setw(10) << "fast" << std::setw(10) << "balanced" << std::setw(10) << "accurate" << "\n";
+        benchMathRow("exp2", -24.0f, 24.0f, sink, [](float x) { return std::exp2(x); },
+                     [](float x) { return FastMath::exp2<P::Fast>(x); },
+                     [](float x) { return FastMath::exp2<P::Balanced>(x); },
+                     [](float x) { return FastMath::exp2<P::Accurate>(x); });
+        benchMathRow("log2", 1e-4f, 1e4f, sink, [](float x) { return std::log2(x); },
+                     [](float x) { return FastMath::log2<P::Fast>(x); },
+                     [](float x) { return FastMath::log2<P::Balanced>(x); },
+                     [](float x) { return FastMath::log2<P::Accurate>(x); });
+        benchMathRow("sin", -100.0f, 100.0f, sink, [](float x) { return std::sin(x); },
+                     [](float x) { return FastMath::sin<P::Fast>(x); },
+                     [](float x) { return FastMath::sin<P::Balanced>(x); },
+                     [](float x) { return FastMath::sin<P::Accurate>(x); });
+        {
+            // The LFO and unison variant: Fast tier only, for phases that are never negative
+            std::vector<float> xs(1 << 16);
+            for (size_t i = 0; i < xs.size(); ++i)
+                xs[i] = 100.0f * i / xs.size();
+            std::cout << std::left << std::setw(12) << "sin, x >= 0" << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(10) << timePerCall(xs, sink, [](float x) { return std::sin(x); }) << std::setw(10)
+                      << timePerCall(xs, sink, [](float x) { return FastMath::sinPositive(x); }) << std::setw(10) << "-"
+                      << std::setw(10) << "-" << "\n";
+        }
+        benchMathRow("tanh", -5.0f, 5.0f, sink, [](float x) { return std::tanh(x); },
+                     [](float x) { return FastMath::tanh<P::Fast>(x); },
+                     [](float x) { return FastMath::tanh<P::Balanced>(x); },
+                     [](float x) { return FastMath::tanh<P::Accurate>(x); });
+        benchMathRow("dbToGain", -96.0f, 12.0f, sink, [](float x) { return std::pow(10.0f, x / 20.0f); },
+                     [](float x) { return FastMath::dbToGain<P::Fast>(x); },
+                     [](float x) { return FastMath::dbToGain<P::Balanced>(x); },
+                     [](float x) { return FastMath::dbToGain<P::Accurate>(x); });
+        benchMathRow("gainToDb", 1e-4f, 4.0f, sink, [](float x) { return 20.0f * std::log10(x); },
+                     [](float x) { return FastMath::gainToDb<P::Fast>(x); },
+                     [](float x) { return FastMath::gainToDb<P::Balanced>(x); },
+                     [](float x) { return FastMath::gainToDb<P::Accurate>(x); });
+        std::cout << "(checksum " << sink << ")\n\n";
+    }
+
+    void benchStereo(int sampleRate)
+    {
+        const int blocks = 20000;
+        const int frames = Synth::MAX_BLOCK;
+        const float dt = 1.0f / sampleRate;
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK], out[Synth::MAX_BLOCK * 2];
+        for (int i = 0; i < frames; ++i)
+        {
+            left[i] = std::sin(i * 0.01f);
+            right[i] = std::cos(i * 0.01f);
+        }
+        double sink = 0.0;
+
+        std::cout << "== Stereo output: " << frames << "-frame blocks (ns/frame)\n";
+        double interleaveNs = timePerFrame(blocks * frames, [&]
+                                           {
+            for (int b = 0; b < blocks; ++b)
+            {
+                left[b % frames] += 1e-9f; // Keep the compiler from hoisting the loop
+                Stereo::interleave(left, right, out, frames);
+                sink += out[b % (frames * 2)];
+            } });
+        std::cout << std::fixed << std::setprecision(3) << "interleave         " << interleaveNs << "\n";
+
+        // What keeping the unison stack stereo costs over folding it to mono
+        Synth mono, stereo;
+        for (Synth *s : {&mono, &stereo})
+        {
+            setupSynth(*s, WaveForm::Saw, LFOTarget::Filter, WaveForm::Sine);
+            s->unison.voices = 8;
+            s->noteOn();
+        }
+        stereo.pan = 0.3f;
+        double monoNs = timePerFrame(blocks * frames / 10, [&]
+                                     {
+            for (int b = 0; b < blocks / 10; ++b)
+            {
+                mono.processBlock(left, frames, dt);
+                sink += left[0];
+            } });
+        double stereoNs = timePerFrame(blocks * frames / 10, [&]
+                                       {
+            for (int b = 0; b < blocks / 10; ++b)
+            {
+                stereo.processBlock(left, right, frames, dt);
+                sink += left[0] + right[0];
+            } });
+        std::cout << std::setprecision(3) << "unison 8 mono      " << monoNs
+                  << "\nunison 8 stereo    " << stereoNs << "\n";
+        std::cout << "(checksum " << sink << ")\n\n";
+    }
+
+    void benchEffects(int sampleRate)
+    {
+        const int blocks = 2000;
+        const double budgetNs = 1e9 * Synth::MAX_BLOCK / sampleRate;
+        const char *names[5] = {"bypass", "chorus", "delay", "reverb", "all"};
+        float input[Synth::MAX_BLOCK];
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+        double sink = 0.0;
+
+        for (int i = 0; i < Synth::MAX_BLOCK; ++i)
+            input[i] = 2.0f * (i % 100) / 100.0f - 1.0f;
+
+        std::cout << "== Effects chain: cost per " << Synth::MAX_BLOCK << "-frame stereo block\n";
+        std::cout << std::left << std::setw(10) << "effect" << std::right << std::setw(14) << "us/block"
+                  << std::setw(10) << "load" << "\n";
+
+        for (int e = 0; e < 5; ++e)
+        {
+            Arena arena(Arena::footprint<EffectsChain>(sampleRate));
+            EffectsChain chain(arena, sampleRate);
+            chain.prepare((float)sampleRate);
+            chain.chorus.enabled = (e == 1 || e == 4);
+            chain.delay.enabled = (e == 2 || e == 4);
+            chain.reverb.enabled = (e == 3 || e == 4);
+
+            double ns = timePerFrame(blocks, [&]
+                                     {
+                for (int b = 0; b < blocks; ++b)
+                {
+                    std::copy(input, input + Synth::MAX_BLOCK, left);
+                    std::copy(input, input + Synth::MAX_BLOCK, right);
+                    chain.process(left, right, Synth::MAX_BLOCK);
+                    sink += left[0] + right[Synth::MAX_BLOCK - 1];
+                } });
+            std::cout << std::left << std::setw(10) << names[e] << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << ns / 1000.0 << std::setw(9) << 100.0 * ns / budgetNs << "%\n";
+        }
+        // The master stage, on a saw twice full scale so it is limiting the whole time
+        for (bool clip : {false, true})
+        {
+            Arena arena(Arena::footprint<Limiter>());
+            Limiter limiter(arena);
+            limiter.prepare((float)sampleRate);
+            limiter.enabled = true;
+            limiter.softClip = clip;
+            double ns = timePerFrame(blocks, [&]
+                                     {
+                for (int b = 0; b < blocks; ++b)
+                {
+                    for (int i = 0; i < Synth::MAX_BLOCK; ++i)
+                        left[i] = right[i] = 2.0f * input[i];
+                    limiter.process(left, right, Synth::MAX_BLOCK);
+                    sink += left[0] + right[Synth::MAX_BLOCK - 1];
+                } });
+            std::cout << std::left << std::setw(10) << (clip ? "lim+clip" : "limiter") << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(14) << ns / 1000.0 << std::setw(9) << 100.0 * ns / budgetNs
+                      << "%\n";
+        }
+        std::cout << "(checksum " << sink << ")\n\n";
+    }
+
+    // 3-second stereo impulse at 48 kHz driven with 64-frame buffers, as in a low-latency setup
+    void benchConvolution()
+    {
+        const int rate = 48000;
+        const int block = 64;
+        const int irLength = 3 * rate;
+        const double budgetNs = 1e9 * block / rate;
+
+        std::vector<float> irL(irLength), irR(irLength);
+        std::srand(1);
+        for (int i = 0; i < irLength; ++i)
+        {
+            float decay = std::exp(-6.9f * i / irLength); // -60 dB over the length
+            irL[i] = (std::rand() / (float)RAND_MAX - 0.5f) * decay;
+            irR[i] = (std::rand() / (float)RAND_MAX - 0.5f) * decay;
+        }
+
+        float left[block], right[block];
+        double sink = 0.0;
+        std::cout << "== Convolution: 3 s stereo IR at " << rate << " Hz, " << block << "-frame buffers, latency "
+                  << ConvolutionReverb::HEAD_BLOCK << " frames\n";
+
+        // Whole cost on one thread (head + tail inline), averaged over 10 s of audio
+        {
+            ConvolutionReverb conv;
+            conv.prepare((float)rate);
+            conv.synchronous = true;
+            conv.enabled = true;
+            conv.setImpulse(irL, irR, (float)rate);
+            const int blocks = 10 * rate / block;
+            double ns = timePerFrame(blocks, [&]
+                                     {
+                for (int b = 0; b < blocks; ++b)
+                {
+                    for (int i = 0; i < block; ++i)
+                        left[i] = right[i] = (i == 0) ? 1.0f : 0.0f;
+                    conv.process(left, right, block);
+                    sink += left[block - 1];
+                } });
+            std::cout << "head+tail inline   " << std::fixed << std::setprecision(2) << std::setw(10) << ns / 1000.0
+                      << " us/block" << std::setw(9) << 100.0 * ns / budgetNs << "% of one core\n";
+        }
+
+        // Real-time paced run: audio-thread cost with the tail on the worker, plus late tail blocks
+        {
+            ConvolutionReverb conv;
+            conv.prepare((float)rate);
+            conv.enabled = true;
+            conv.start();
+            conv.setImpulse(irL, irR, (float)rate);
+            const int blocks = 3 * rate / block;
+            double worst = 0.0, total = 0.0;
+            auto deadline = std::chrono::steady_clock::now();
+            for (int b = 0; b < blocks; ++b)
+            {
+                for (int i = 0; i < block; ++i)
+                    left[i] = right[i] = (i == 0) ? 1.0f : 0.0f;
+                double ns = timePerFrame(1, [&]
+                                         { conv.process(left, right, block); });
+                sink += left[block - 1];
+                total += ns;
+                worst = std::max(worst, ns);
+                deadline += std::chrono::nanoseconds((long long)budgetNs);
+                std::this_thread::sleep_until(deadline);
+            }
+            conv.stop();
+            std::cout << "audio thread       " << std::setw(10) << total / blocks / 1000.0 << " us/block avg, "
+                      << worst / 1000.0 << " us worst, budget " << budgetNs / 1000.0 << " us\n";
+            std::cout << "tail worker        " << conv.tailJobs << " jobs, " << conv.tailLate << " late\n";
+        }
+        std::cout << "(checksum " << sink << ")\n\n";
+    }
+
+    void benchSequencer(int sampleRate)
+    {
+        // Worst case editor state: every pattern full, every step locked, all chained
+        Sequencer seq;
+        seq.chain.clear();
+        for (int p = 0; p < Sequencer::MAX_PATTERNS; ++p)
+        {
+            Sequencer::Pattern &pattern = seq.patterns[p];
+            pattern.length = Sequencer::MAX_STEPS;
+            for (int t = 0; t < Sequencer::MAX_TRACKS; ++t)
+            {
+                pattern.tracks[t].length = Sequencer::MAX_STEPS - t;
+                pattern.tracks[t].channel = (uint8_t)t;
+                for (int s = 0; s < Sequencer::MAX_STEPS; ++s)
+                {
+                    Sequencer::Step &step = pattern.tracks[t].steps[s];
+                    step.note = (int8_t)(36 + (s * 7 + t) % 48);
+                    step.lock((Param)(s % (int)Param::Count), (s % 10) / 10.0f);
+                }
+            }
+            seq.chain.push_back(p);
+        }
+
+        const int runs = 20;
+        size_t events = 0;
+        double ns = timePerFrame(runs, [&]
+                                 {
+            for (int r = 0; r < runs; ++r)
+            {
+                std::unique_ptr<SequenceTimeline> timeline(seq.compile((float)sampleRate));
+                events = timeline->events.size();
+            } });
+
+        // Playback cost is the cursor walk inside Engine::render
+        std::unique_ptr<Engine> engine(new Engine());
+        engine->prepare((float)sampleRate);
+        engine->publishSequence(seq.compile((float)sampleRate));
+        engine->playSequence(true);
+        const int blocks = 2000;
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+        double renderNs = timePerFrame(blocks, [&]
+                                       {
+            for (int b = 0; b < blocks; ++b)
+                engine->render(left, right, Synth::MAX_BLOCK); });
+
+        std::cout << "== Sequencer: " << Sequencer::MAX_PATTERNS << " chained patterns x " << Sequencer::MAX_TRACKS
+                  << " tracks x " << Sequencer::MAX_STEPS << " steps, all locked\n";
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "compile            " << std::setw(10) << ns / 1000.0 << " us, " << events << " events\n";
+        std::cout << "engine render      " << std::setw(10) << renderNs / 1000.0 << " us/block while playing\n\n";
+    }
+
+    void benchAutomation(int sampleRate)
+    {
+        const int blocks = 2000;
+        const uint64_t frames = (uint64_t)blocks * Synth::MAX_BLOCK;
+        const int spacings[3] = {0, 1024, 64}; // Samples between moves per lane; 0 = no automation
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+
+        std::cout << "== Automation: " << (int)Param::Count << " lanes, " << Synth::MAX_BLOCK << "-frame blocks\n";
+        std::cout << std::left << std::setw(12) << "spacing" << std::right << std::setw(10) << "points"
+                  << std::setw(12) << "bytes/pt" << std::setw(12) << "us/block" << "\n";
+        for (int spacing : spacings)
+        {
+            std::unique_ptr<Automation> lanes(new Automation());
+            for (uint64_t t = 0; spacing && t < frames; t += spacing)
+                for (int p = 0; p < (int)Param::Count; ++p)
+                    lanes->record(t + p, (Param)p, ((t / spacing + p) % 17) / 16.0f);
+            size_t points = lanes->points(), bytes = lanes->bytes();
+
+            std::unique_ptr<Engine> engine(new Engine());
+            engine->prepare((float)sampleRate);
+            engine->publishAutomation(lanes.release());
+            engine->playAutomation(true);
+            engine->handleEvent({0, EventType::NoteOn, 0, 60, 100, 0.0f});
+            double ns = timePerFrame(blocks, [&]
+                                     {
+                for (int b = 0; b < blocks; ++b)
+                    engine->render(left, right, Synth::MAX_BLOCK); });
+            std::cout << std::left << std::setw(12) << (spacing ? std::to_string(spacing) : std::string("off"))
+                      << std::right << std::setw(10) << points << std::fixed << std::setprecision(2)
+                      << std::setw(12) << (points ? (double)bytes / points : 0.0) << std::setw(12) << ns / 1000.0 << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    void benchParts(int sampleRate)
+    {
+        const int blocks = 2000;
+        const double budgetNs = 1e9 * Synth::MAX_BLOCK / sampleRate;
+        const int helpers = std::max(1, std::min(3, (int)std::thread::hardware_concurrency() - 1));
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+
+        std::cout << "== Parts: " << Part::MAX_VOICES << " held notes per sounding part, 5-voice unison, "
+                  << Synth::MAX_BLOCK << "-frame blocks\n";
+        std::cout << std::left << std::setw(10) << "sounding" << std::right << std::setw(14) << "serial us"
+                  << std::setw(10) << "budget" << std::setw(14) << (std::to_string(helpers) + "+1 thr us") << std::setw(10)
+                  << "budget" << "\n";
+        for (int sounding : {0, 1, 4, Engine::MAX_PARTS})
+        {
+            double ns[2];
+            for (int parallel = 0; parallel < 2; ++parallel)
+            {
+                std::unique_ptr<Engine> engine(new Engine());
+                engine->prepare((float)sampleRate);
+                for (Part &part : engine->parts)
+                {
+                    part.polyphony = Part::MAX_VOICES;
+                    part.patch.unison.voices = 5;
+                    part.patch.unison.configure();
+                }
+                for (int p = 0; p < sounding; ++p)
+                    for (int v = 0; v < Part::MAX_VOICES; ++v)
+                        engine->handleEvent({0, EventType::NoteOn, (uint8_t)p, (uint8_t)(40 + p * 5 + v * 3), 100, 0.0f});
+                engine->startWorkers(parallel ? helpers : 0);
+                ns[parallel] = timePerFrame(blocks, [&]
+                                            {
+                    for (int b = 0; b < blocks; ++b)
+                        engine->render(left, right, Synth::MAX_BLOCK); });
+                engine->stopWorkers();
+            }
+            std::cout << std::left << std::setw(10) << sounding << std::right << std::fixed << std::setprecision(2);
+            for (double t : ns)
+                std::cout << std::setw(14) << t / 1000.0 << std::setw(9) << 100.0 * t / budgetNs << "%";
+            std::cout << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    // What each quality governor level buys on a patch that exercises every knob it turns
+    void benchQuality(int sampleRate)
+    {
+        const int blocks = 1000;
+        const double budgetNs = 1e9 * Synth::MAX_BLOCK / sampleRate;
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+
+        std::cout << "== Quality levels: " << Engine::MAX_PARTS << " parts x " << Part::MAX_VOICES
+                  << " notes, 16-voice unison, vibrato, reverb\n";
+        std::cout << std::left << std::setw(34) << "level" << std::right << std::setw(12) << "us/block" << std::setw(10)
+                  << "budget" << "\n";
+        for (int level = 0; level < QualityGovernor::LEVELS; ++level)
+        {
+            std::unique_ptr<Engine> engine(new Engine());
+            engine->prepare((float)sampleRate);
+            engine->effects.reverb.enabled = true;
+            for (Part &part : engine->parts)
+            {
+                part.polyphony = Part::MAX_VOICES;
+                part.patch.unison.voices = Unison::MAX_VOICES;
+                part.patch.unison.configure();
+                part.patch.lfo.enabled = true;
+                part.patch.lfo.target = LFOTarget::Pitch;
+            }
+            // The caps apply from the next render and bind at note-on
+            engine->quality.setLevel(level);
+            engine->render(left, right, Synth::MAX_BLOCK);
+            for (int p = 0; p < Engine::MAX_PARTS; ++p)
+                for (int v = 0; v < Part::MAX_VOICES; ++v)
+                    engine->handleEvent({0, EventType::NoteOn, (uint8_t)p, (uint8_t)(40 + p * 5 + v * 3), 100, 0.0f});
+            double ns = timePerFrame(blocks, [&]
+                                     {
+                for (int b = 0; b < blocks; ++b)
+                    engine->render(left, right, Synth::MAX_BLOCK); });
+            std::cout << std::left << std::setw(34) << (std::to_string(level) + " " + QualityGovernor::settings(level).name)
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(12) << ns / 1000.0 << std::setw(9)
+                      << 100.0 * ns / budgetNs << "%\n";
+        }
+        std::cout << "\n";
+    }
+
+    // Engine rate to each device rate, pulled a device buffer at a time
+    void benchResampler(int sampleRate)
+    {
+        const int taps[] = {32, 64, 128};
+        const int rates[] = {48000, 96000, 192000, 22050, 48001};
+        const int seconds = 2;
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+        double sink = 0.0;
+        auto source = [&](float *l, float *r, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                l[i] = r[i] = (float)((i * 7) % 13) * 0.1f;
+        };
+
+        std::cout << "== Resampler from " << sampleRate << " Hz, per output frame\n";
+        std::cout << std::left << std::setw(10) << "to Hz" << std::right << std::setw(6) << "taps" << std::setw(8)
+                  << "phases" << std::setw(12) << "latency ms" << std::setw(10) << "ns/frame" << std::setw(10) << "core"
+                  << "\n";
+        for (int rate : rates)
+        {
+            for (int t : taps)
+            {
+                Resampler resampler;
+                std::string error;
+                if (!resampler.configure(sampleRate, rate, t, 0.9f, error))
+                    continue;
+                const int frames = seconds * rate;
+                double ns = timePerFrame(frames, [&]
+                                         {
+                    for (int done = 0; done < frames; done += Synth::MAX_BLOCK)
+                    {
+                        resampler.pull(left, right, Synth::MAX_BLOCK, source);
+                        sink += left[0] + right[Synth::MAX_BLOCK - 1];
+                    } });
+                std::cout << std::left << std::setw(10) << rate << std::right << std::setw(6) << t << std::setw(8)
+                          << (std::to_string(resampler.phases()) + (resampler.exact() ? "" : "~")) << std::fixed
+                          << std::setprecision(3) << std::setw(12) << 1000.0 * resampler.latencySeconds()
+                          << std::setprecision(2) << std::setw(10) << ns << std::setw(9) << ns * rate / 1e7 << "%\n";
+            }
+        }
+        std::cout << "(~ interpolated; checksum " << sink << ")\n\n";
+    }
+
+    void benchGranular(int sampleRate)
+    {
+        const int blocks = 1000;
+        const double budgetNs = 1e9 * Synth::MAX_BLOCK / sampleRate;
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+
+        std::cout << "== Granular: one voice, 100 ms grains, " << Synth::MAX_BLOCK << "-frame blocks\n";
+        std::cout << std::left << std::setw(10) << "grains" << std::right << std::setw(14) << "us/block"
+                  << std::setw(10) << "load" << std::setw(16) << "ns/grain-frame" << "\n";
+        for (int target : {100, 400, 1000})
+        {
+            std::unique_ptr<Engine> engine(new Engine());
+            engine->prepare((float)sampleRate);
+            Granular &g = engine->granular;
+            Granular::Source *source = new Granular::Source();
+            source->frames = sampleRate * 4;
+            source->left.resize(source->frames);
+            source->right.resize(source->frames);
+            for (int i = 0; i < source->frames; ++i)
+            {
+                source->left[i] = std::sin(i * 0.05f);
+                source->right[i] = std::sin(i * 0.07f);
+            }
+            g.publishSource(source);
+            g.part = 0;
+            g.size = 0.1f;
+            g.density = target / g.size;
+            g.positionSpray = 0.3f;
+            g.pitchSpray = 12.0f;
+            engine->render(left, right, 1); // Picks up the source
+            engine->handleEvent({0, EventType::NoteOn, 0, 60, 100, 0.0f});
+            for (int b = 0; b < 40; ++b) // Fill the cloud before timing
+                engine->render(left, right, Synth::MAX_BLOCK);
+            double grains = 0.0;
+            double ns = timePerFrame(blocks, [&]
+                                     {
+                for (int b = 0; b < blocks; ++b)
+                {
+                    engine->render(left, right, Synth::MAX_BLOCK);
+                    grains += g.grains();
+                } });
+            grains /= blocks;
+            std::cout << std::left << std::setw(10) << (int)grains << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << ns / 1000.0 << std::setw(9) << 100.0 * ns / budgetNs << "%" << std::setw(16)
+                      << ns / (grains * Synth::MAX_BLOCK) << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    void benchSampler(int sampleRate)
+    {
+        // Throwaway library: 8 zones of 10 s stereo noise, far more than the preload
+        namespace fs = std::filesystem;
+        fs::path dir = fs::temp_directory_path() / "synth_bench_samples";
+        fs::create_directories(dir);
+        const int zoneSeconds = 10;
+        std::string error;
+        std::srand(2);
+        for (int z = 0; z < 8; ++z)
+        {
+            WavFile wav;
+            wav.sampleRate = sampleRate;
+            wav.channels = 2;
+            wav.samples.resize((size_t)zoneSeconds * sampleRate * 2);
+            for (float &x : wav.samples)
+                x = (std::rand() / (float)RAND_MAX - 0.5f) * 0.5f;
+            wav.save((dir / ("bench_" + std::to_string(36 + z * 6) + ".wav")).string(), error);
+        }
+
+        const int block = Synth::MAX_BLOCK;
+        const double budgetNs = 1e9 * block / sampleRate;
+        Arena arena(Arena::footprint<Sampler>());
+        Sampler sampler(arena);
+        if (!sampler.load(dir.string(), error))
+        {
+            std::cout << "== Sampler: " << error << "\n\n";
+            return;
+        }
+        sampler.prepare((float)sampleRate);
+        sampler.start();
+
+        // Real-time paced: all voices busy, one retriggered every 100 ms so the streamer keeps seeking
+        float left[block], right[block];
+        double sink = 0.0, worst = 0.0, total = 0.0;
+        for (int v = 0; v < Sampler::MAX_VOICES; ++v)
+            sampler.noteOn(36 + v * 3, 100);
+        const int blocks = 2 * sampleRate / block;
+        const int retrigger = sampleRate / 10 / block;
+        auto deadline = std::chrono::steady_clock::now();
+        for (int b = 0; b < blocks; ++b)
+        {
+            if (b % retrigger == 0)
+                sampler.noteOn(36 + (b / retrigger) % 48, 100);
+            std::fill(left, left + block, 0.0f);
+            std::fill(right, right + block, 0.0f);
+            double ns = timePerFrame(1, [&]
+                                     { sampler.process(left, right, block); });
+            sink += left[block - 1];
+            total += ns;
+            worst = std::max(worst, ns);
+            deadline += std::chrono::nanoseconds((long long)budgetNs);
+            std::this_thread::sleep_until(deadline);
+        }
+        Sampler::Footprint fp = sampler.footprint();
+        sampler.stop();
+
+        std::cout << "== Sampler: " << Sampler::MAX_VOICES << " voices streaming from mapped WAV, "
+                  << block << "-frame buffers\n";
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "audio thread       " << std::setw(10) << total / blocks / 1000.0 << " us/block avg, "
+                  << worst / 1000.0 << " us worst, budget " << budgetNs / 1000.0 << " us\n";
+        std::cout << "underruns          " << sampler.underruns << "\n";
+        std::cout << "footprint          " << fp.mappedBytes / 1048576.0 << " MB mapped, "
+                  << fp.residentBytes / 1048576.0 << " MB resident, "
+                  << fp.preloadBytes / 1048576.0 << " MB preload, " << fp.ringBytes / 1048576.0 << " MB rings\n";
+        std::cout << "(checksum " << sink << ")\n\n";
+        fs::remove_all(dir);
+    }
+}
+
+int runBenchmarks(int sampleRate)
+{
+    benchFastMath();
+    benchRenderKernels(sampleRate);
+    benchUnison(sampleRate);
+    benchFM(sampleRate);
+    benchStereo(sampleRate);
+    benchEffects(sampleRate);
+    benchConvolution();
+    benchSequencer(sampleRate);
+    benchAutomation(sampleRate);
+    benchParts(sampleRate);
+    benchQuality(sampleRate);
+    benchResampler(sampleRate);
+    benchGranular(sampleRate);
+    benchSampler(sampleRate);
+    return 0;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Offline performance report, run with `synth --bench`. No audio device is opened.
+int runBenchmarks(int sampleRate);
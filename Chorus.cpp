@@ -0,0 +1,53 @@
+#include "Chorus.hpp"
+#include <cmath>
+
+Chorus::Chorus(Arena &arena, int maxSampleRate)
+    : enabled(false), rate(0.8f), depth(0.003f), delay(0.012f), mix(0.5f),
+      lineL(arena, (int)(MAX_SECONDS * maxSampleRate) + 2), lineR(arena, (int)(MAX_SECONDS * maxSampleRate) + 2),
+      sampleRate(44100.0f), sinState(0.0f), cosState(1.0f) {}
+
+void Chorus::prepare(float sr)
+{
+    sampleRate = sr;
+    lineL.setLength((int)(MAX_SECONDS * sr) + 2);
+    lineR.setLength((int)(MAX_SECONDS * sr) + 2);
+    reset();
+}
+
+void Chorus::reset()
+{
+    lineL.clear();
+    lineR.clear();
+    sinState = 0.0f;
+    cosState = 1.0f;
+}
+
+void Chorus::process(float *left, float *right, int frames)
+{
+    const float w = 2.0f * (float)M_PI * rate / sampleRate;
+    const float centre = delay * sampleRate;
+    const float swing = depth * sampleRate;
+    const float maxDelay = (float)(lineL.getLength() - 2);
+
+    float s = sinState, c = cosState;
+    for (int i = 0; i < frames; ++i)
+    {
+        // Magic-circle oscillator: s and c stay in quadrature
+        s += w * c;
+        c -= w * s;
+
+        float dL = std::fmin(std::fmax(centre + swing * s, 1.0f), maxDelay);
+        float dR = std::fmin(std::fmax(centre + swing * c, 1.0f), maxDelay);
+        lineL.write(left[i]);
+        lineR.write(right[i]);
+        float wetL = lineL.readLinear(dL);
+        float wetR = lineR.readLinear(dR);
+        left[i] = left[i] * (1.0f - 0.5f * mix) + wetL * mix;
+        right[i] = right[i] * (1.0f - 0.5f * mix) + wetR * mix;
+    }
+
+    // Renormalise once per block so rounding cannot grow the amplitude
+    float norm = 1.0f / std::sqrt(s * s + c * c);
+    sinState = s * norm;
+    cosState = c * norm;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "DelayLine.hpp"
+
+// Stereo chorus: one modulated delay per side, modulators 90 degrees apart
+class Chorus
+{
+public:
+    static constexpr float MAX_SECONDS = 0.05f;
+
+    bool enabled;
+    float rate;  // Modulation rate (Hz)
+    float depth; // Modulation depth (seconds)
+    float delay; // Centre delay (seconds)
+    float mix;
+
+    Chorus(Arena &arena, int maxSampleRate);
+    void prepare(float sampleRate);
+    void reset();
+    void process(float *left, float *right, int frames);
+
+private:
+    DelayLine lineL, lineR;
+    float sampleRate;
+    float sinState, cosState; // Quadrature oscillator, no std::sin per sample
+};
@@ -0,0 +1,373 @@
+#include "ConvolutionReverb.hpp"
+#include "WavFile.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// One channel of one uniformly partitioned stage (overlap-save with a
+// frequency-domain delay line of input spectra)
+struct ConvolutionReverb::Stage
+{
+    int block = 0;
+    int parts = 0;
+    int bins = 0;
+    std::vector<float> hRe, hIm; // Partition spectra, parts * bins
+    std::vector<float> xRe, xIm; // Input spectra ring, parts * bins
+    std::vector<float> frame;    // Previous and current input block
+    int fdlPos = 0;
+};
+
+// Everything that depends on one impulse response, allocated off the audio thread
+struct ConvolutionReverb::Impulse
+{
+    Stage head[2], tail[2];
+    std::vector<float> accum[2];      // Tail input being collected by the audio thread
+    std::vector<float> tailIn[2][2];  // [slot][channel]
+    std::vector<float> tailOut[2][2]; // [slot][channel]
+    std::atomic<long> slotJob[2];     // Job whose result is in each output slot
+    std::atomic<long> submitted;
+    long workerDone = -1;
+    long headBlocks = 0;
+    bool tailValid = false;
+
+    Impulse() : submitted(-1)
+    {
+        slotJob[0] = slotJob[1] = -1;
+    }
+};
+
+ConvolutionReverb::ConvolutionReverb()
+    : enabled(false), mix(0.5f), synchronous(false), tailJobs(0), tailLate(0),
+      sampleRate(44100.0f), current(nullptr), pending(nullptr), retired(nullptr),
+      jobImpulse(nullptr), busy(nullptr),
+      headFFT(2 * HEAD_BLOCK), tailFFT(2 * TAIL_BLOCK), syncTailFFT(2 * TAIL_BLOCK),
+      pos(0), running(false)
+{
+    for (Scratch *s : {&headScratch, &tailScratch, &syncScratch})
+    {
+        s->re.resize(TAIL_BLOCK + 1);
+        s->im.resize(TAIL_BLOCK + 1);
+        s->time.resize(2 * TAIL_BLOCK);
+    }
+    for (int c = 0; c < 2; ++c)
+    {
+        std::fill(inBlock[c], inBlock[c] + HEAD_BLOCK, 0.0f);
+        std::fill(outBlock[c], outBlock[c] + HEAD_BLOCK, 0.0f);
+    }
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    stop();
+    delete current;
+    delete pending.load();
+    delete retired.load();
+}
+
+void ConvolutionReverb::prepare(float sr)
+{
+    sampleRate = sr;
+    pos = 0;
+}
+
+void ConvolutionReverb::start()
+{
+    if (running)
+        return;
+    running = true;
+    loaderThread = std::thread(&ConvolutionReverb::loaderLoop, this);
+    workerThread = std::thread(&ConvolutionReverb::workerLoop, this);
+}
+
+void ConvolutionReverb::stop()
+{
+    if (!running)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        running = false;
+    }
+    loadCondition.notify_all();
+    loaderThread.join();
+    workerThread.join();
+}
+
+void ConvolutionReverb::loadAsync(const std::string &path)
+{
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        requestPath = path;
+    }
+    loadCondition.notify_all();
+}
+
+void ConvolutionReverb::buildStage(Stage &stage, const float *ir, int length, const FFT &fft)
+{
+    stage.block = fft.size() / 2;
+    stage.bins = fft.bins();
+    stage.parts = length > 0 ? (length + stage.block - 1) / stage.block : 0;
+    size_t total = (size_t)stage.parts * stage.bins;
+    stage.hRe.assign(total, 0.0f);
+    stage.hIm.assign(total, 0.0f);
+    stage.xRe.assign(total, 0.0f);
+    stage.xIm.assign(total, 0.0f);
+    stage.frame.assign(fft.size(), 0.0f);
+    stage.fdlPos = 0;
+
+    std::vector<float> padded(fft.size());
+    for (int p = 0; p < stage.parts; ++p)
+    {
+        std::fill(padded.begin(), padded.end(), 0.0f);
+        int n = std::min(stage.block, length - p * stage.block);
+        std::copy(ir + p * stage.block, ir + p * stage.block + n, padded.begin());
+        fft.forward(padded.data(), &stage.hRe[(size_t)p * stage.bins], &stage.hIm[(size_t)p * stage.bins]);
+    }
+}
+
+void ConvolutionReverb::runStage(Stage &stage, const FFT &fft, const float *in, float *out, Scratch &scratch)
+{
+    const int B = stage.block;
+    if (stage.parts == 0)
+    {
+        std::fill(out, out + B, 0.0f);
+        return;
+    }
+    const int bins = stage.bins;
+
+    std::copy(stage.frame.begin() + B, stage.frame.end(), stage.frame.begin());
+    std::copy(in, in + B, stage.frame.begin() + B);
+    fft.forward(stage.frame.data(), &stage.xRe[(size_t)stage.fdlPos * bins], &stage.xIm[(size_t)stage.fdlPos * bins]);
+
+    float *accRe = scratch.re.data(), *accIm = scratch.im.data();
+    std::fill(accRe, accRe + bins, 0.0f);
+    std::fill(accIm, accIm + bins, 0.0f);
+    for (int p = 0; p < stage.parts; ++p)
+    {
+        int slot = stage.fdlPos - p;
+        if (slot < 0)
+            slot += stage.parts;
+        const float *xr = &stage.xRe[(size_t)slot * bins], *xi = &stage.xIm[(size_t)slot * bins];
+        const float *hr = &stage.hRe[(size_t)p * bins], *hi = &stage.hIm[(size_t)p * bins];
+        for (int k = 0; k < bins; ++k)
+        {
+            accRe[k] += xr[k] * hr[k] - xi[k] * hi[k];
+            accIm[k] += xr[k] * hi[k] + xi[k] * hr[k];
+        }
+    }
+
+    fft.inverse(accRe, accIm, scratch.time.data());
+    std::copy(scratch.time.begin() + B, scratch.time.begin() + 2 * B, out); // Overlap-save: second half is valid
+    stage.fdlPos = (stage.fdlPos + 1) % stage.parts;
+}
+
+void ConvolutionReverb::setImpulse(const std::vector<float> &left, const std::vector<float> &right, float irRate)
+{
+    const std::vector<float> *src[2] = {&left, right.empty() ? &left : &right};
+    std::vector<float> ir[2];
+
+    // Resample to the engine rate and normalise to unit energy on the louder side
+    double energy = 0.0;
+    for (int c = 0; c < 2; ++c)
+    {
+        const std::vector<float> &in = *src[c];
+        double ratio = irRate / sampleRate;
+        int length = (int)(in.size() / ratio);
+        ir[c].resize(length);
+        for (int i = 0; i < length; ++i)
+        {
+            double x = i * ratio;
+            size_t j = (size_t)x;
+            float frac = (float)(x - j);
+            float a = in[j], b = j + 1 < in.size() ? in[j + 1] : 0.0f;
+            ir[c][i] = a + frac * (b - a);
+        }
+        double e = 0.0;
+        for (float v : ir[c])
+            e += (double)v * v;
+        energy = std::max(energy, e);
+    }
+    float gain = energy > 0.0 ? (float)(1.0 / std::sqrt(energy)) : 0.0f;
+
+    Impulse *imp = new Impulse();
+    FFT headBuild(2 * HEAD_BLOCK), tailBuild(2 * TAIL_BLOCK);
+    for (int c = 0; c < 2; ++c)
+    {
+        for (float &v : ir[c])
+            v *= gain;
+        int length = (int)ir[c].size();
+        int headLength = std::min(length, HEAD_LENGTH);
+        buildStage(imp->head[c], ir[c].data(), headLength, headBuild);
+        buildStage(imp->tail[c], ir[c].data() + headLength, length - headLength, tailBuild);
+        imp->accum[c].assign(TAIL_BLOCK, 0.0f);
+        for (int s = 0; s < 2; ++s)
+        {
+            imp->tailIn[s][c].assign(TAIL_BLOCK, 0.0f);
+            imp->tailOut[s][c].assign(TAIL_BLOCK, 0.0f);
+        }
+    }
+
+    // An impulse the audio thread never picked up can be replaced and freed here
+    delete pending.exchange(imp);
+}
+
+void ConvolutionReverb::swapIfPending()
+{
+    // Only swap when the retired slot is free; the loader thread empties it
+    if (retired.load() != nullptr)
+        return;
+    Impulse *next = pending.exchange(nullptr);
+    if (!next)
+        return;
+    if (current)
+        retired.store(current);
+    current = next;
+    jobImpulse.store(next);
+}
+
+void ConvolutionReverb::runTail(Impulse &imp, long job, const FFT &fft, Scratch &scratch)
+{
+    int slot = (int)(job % 2);
+    for (int c = 0; c < 2; ++c)
+        runStage(imp.tail[c], fft, imp.tailIn[slot][c].data(), imp.tailOut[slot][c].data(), scratch);
+    imp.slotJob[slot].store(job);
+}
+
+void ConvolutionReverb::processHeadBlock()
+{
+    swapIfPending();
+    Impulse *imp = current;
+    if (!imp)
+    {
+        for (int c = 0; c < 2; ++c)
+            std::fill(outBlock[c], outBlock[c] + HEAD_BLOCK, 0.0f);
+        return;
+    }
+
+    for (int c = 0; c < 2; ++c)
+        runStage(imp->head[c], headFFT, inBlock[c], outBlock[c], headScratch);
+
+    if (imp->tail[0].parts == 0)
+        return;
+
+    const int perTail = TAIL_BLOCK / HEAD_BLOCK;
+    long block = imp->headBlocks++;
+    long period = block / perTail;
+    int offset = (int)(block % perTail) * HEAD_BLOCK;
+
+    // The tail result for this period was computed from the input two periods ago
+    if (offset == 0)
+    {
+        imp->tailValid = period >= 2 && imp->slotJob[period % 2].load() == period - 2;
+        if (period >= 2 && !imp->tailValid)
+            ++tailLate;
+    }
+    if (imp->tailValid)
+    {
+        int slot = (int)(period % 2);
+        for (int c = 0; c < 2; ++c)
+        {
+            const float *tail = imp->tailOut[slot][c].data() + offset;
+            for (int i = 0; i < HEAD_BLOCK; ++i)
+                outBlock[c][i] += tail[i];
+        }
+    }
+
+    for (int c = 0; c < 2; ++c)
+        std::copy(inBlock[c], inBlock[c] + HEAD_BLOCK, imp->accum[c].begin() + offset);
+
+    if (offset + HEAD_BLOCK == TAIL_BLOCK)
+    {
+        int slot = (int)(period % 2);
+        for (int c = 0; c < 2; ++c)
+            std::copy(imp->accum[c].begin(), imp->accum[c].end(), imp->tailIn[slot][c].begin());
+        ++tailJobs;
+        if (synchronous)
+            runTail(*imp, period, syncTailFFT, syncScratch);
+        else
+            imp->submitted.store(period);
+    }
+}
+
+void ConvolutionReverb::process(float *left, float *right, int frames)
+{
+    if (!enabled)
+        return;
+
+    // Wet signal comes out one head block late; the dry signal is not delayed
+    for (int i = 0; i < frames; ++i)
+    {
+        inBlock[0][pos] = left[i];
+        inBlock[1][pos] = right[i];
+        left[i] += mix * outBlock[0][pos];
+        right[i] += mix * outBlock[1][pos];
+        if (++pos == HEAD_BLOCK)
+        {
+            processHeadBlock();
+            pos = 0;
+        }
+    }
+}
+
+void ConvolutionReverb::collectRetired()
+{
+    Impulse *r = retired.load();
+    if (r && jobImpulse.load() != r && busy.load() != r)
+    {
+        delete r;
+        retired.store(nullptr);
+    }
+}
+
+void ConvolutionReverb::loaderLoop()
+{
+    while (running)
+    {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(loadMutex);
+            loadCondition.wait_for(lock, std::chrono::milliseconds(50),
+                                   [this]
+                                   { return !requestPath.empty() || !running; });
+            path.swap(requestPath);
+        }
+
+        if (!path.empty())
+        {
+            WavFile wav;
+            std::string error;
+            if (!wav.load(path, error))
+            {
+                std::cerr << "Impulse load failed: " << error << "\n";
+            }
+            else
+            {
+                setImpulse(wav.channel(0), wav.channels > 1 ? wav.channel(1) : std::vector<float>(), (float)wav.sampleRate);
+                std::cout << "Impulse loaded: " << path << " (" << wav.frames() / (float)wav.sampleRate << " s, "
+                          << wav.channels << " ch)\n";
+            }
+        }
+        collectRetired();
+    }
+}
+
+void ConvolutionReverb::workerLoop()
+{
+    while (running)
+    {
+        // Publish the impulse we are about to touch, then confirm it is still current
+        Impulse *imp = jobImpulse.load();
+        busy.store(imp);
+        if (imp && jobImpulse.load() == imp)
+        {
+            long target = imp->submitted.load();
+            while (imp->workerDone < target)
+            {
+                runTail(*imp, imp->workerDone + 1, tailFFT, tailScratch);
+                ++imp->workerDone;
+            }
+        }
+        busy.store(nullptr);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
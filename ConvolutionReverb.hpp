@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FFT.hpp"
+
+// Convolution with long impulse responses split into two uniformly partitioned
+// stages: HEAD_BLOCK partitions on the audio thread cover the first HEAD_LENGTH
+// samples, TAIL_BLOCK partitions on a worker thread cover the rest. Because the
+// tail starts HEAD_LENGTH = 2 * TAIL_BLOCK into the response, the worker has a
+// whole tail block period to deliver each result. Impulses are read and
+// pre-transformed on a loader thread and swapped in at a block boundary.
+class ConvolutionReverb
+{
+public:
+    static constexpr int HEAD_BLOCK = 64;
+    static constexpr int TAIL_BLOCK = 1024;
+    static constexpr int HEAD_LENGTH = 2 * TAIL_BLOCK;
+
+    bool enabled;
+    float mix;
+    bool synchronous; // Run tail jobs inline instead of on the worker (offline rendering)
+
+    std::atomic<unsigned long> tailJobs; // Tail blocks handed to the worker
+    std::atomic<unsigned long> tailLate; // Tail blocks that were not ready in time
+
+    ConvolutionReverb();
+    ~ConvolutionReverb();
+    void prepare(float sampleRate);
+    void start(); // Launches the loader and tail worker threads
+    void stop();
+    void loadAsync(const std::string &path);
+    // Pre-transforms an impulse on the calling thread and queues it for the audio thread
+    void setImpulse(const std::vector<float> &left, const std::vector<float> &right, float irRate);
+    void process(float *left, float *right, int frames);
+    int latency() const { return HEAD_BLOCK; }
+
+private:
+    struct Stage;
+    struct Impulse;
+    struct Scratch
+    {
+        std::vector<float> re, im, time;
+    };
+
+    float sampleRate;
+    Impulse *current; // Owned by the audio thread
+    std::atomic<Impulse *> pending;
+    std::atomic<Impulse *> retired;
+    std::atomic<Impulse *> jobImpulse; // Impulse the worker should serve
+    std::atomic<Impulse *> busy;       // Impulse the worker is touching right now
+
+    FFT headFFT, tailFFT, syncTailFFT;
+    Scratch headScratch, tailScratch, syncScratch;
+    float inBlock[2][HEAD_BLOCK];
+    float outBlock[2][HEAD_BLOCK];
+    int pos;
+
+    std::atomic<bool> running;
+    std::thread loaderThread, workerThread;
+    std::mutex loadMutex;
+    std::condition_variable loadCondition;
+    std::string requestPath;
+
+    void processHeadBlock();
+    void swapIfPending();
+    void runTail(Impulse &imp, long job, const FFT &fft, Scratch &scratch);
+    void collectRetired();
+    void loaderLoop();
+    void workerLoop();
+    static void buildStage(Stage &stage, const float *ir, int length, const FFT &fft);
+    static void runStage(Stage &stage, const FFT &fft, const float *in, float *out, Scratch &scratch);
+};
@@ -0,0 +1,47 @@
+#include "Delay.hpp"
+
+Delay::Delay(Arena &arena, int maxSampleRate, float maxSeconds)
+    : enabled(false), bpm(120.0f), beats(0.75f), feedback(0.4f), mix(0.35f), pingPong(true),
+      lineL(arena, (int)(maxSeconds * maxSampleRate) + 2), lineR(arena, (int)(maxSeconds * maxSampleRate) + 2),
+      sampleRate(44100.0f), maxSeconds(maxSeconds) {}
+
+void Delay::prepare(float sr)
+{
+    sampleRate = sr;
+    lineL.setLength((int)(maxSeconds * sr) + 2);
+    lineR.setLength((int)(maxSeconds * sr) + 2);
+    reset();
+}
+
+void Delay::reset()
+{
+    lineL.clear();
+    lineR.clear();
+}
+
+void Delay::process(float *left, float *right, int frames)
+{
+    // Delay time is resolved once per block
+    int d = (int)(60.0f / bpm * beats * sampleRate);
+    d = std::max(1, std::min(d, lineL.getLength() - 1));
+    const float fb = std::min(feedback, 0.95f);
+
+    for (int i = 0; i < frames; ++i)
+    {
+        float yL = lineL.read(d);
+        float yR = lineR.read(d);
+        if (pingPong)
+        {
+            // Mono input enters on the left and bounces between the sides
+            lineL.write(0.5f * (left[i] + right[i]) + yR * fb);
+            lineR.write(yL * fb);
+        }
+        else
+        {
+            lineL.write(left[i] + yL * fb);
+            lineR.write(right[i] + yR * fb);
+        }
+        left[i] += yL * mix;
+        right[i] += yR * mix;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "DelayLine.hpp"
+
+// Tempo-synced stereo delay with optional ping-pong feedback
+class Delay
+{
+public:
+    bool enabled;
+    float bpm;      // Tempo the delay time is locked to
+    float beats;    // Delay time in beats (0.5 = eighth note)
+    float feedback; // 0-0.95
+    float mix;      // Wet level added to the dry signal
+    bool pingPong;
+
+    Delay(Arena &arena, int maxSampleRate, float maxSeconds);
+    void prepare(float sampleRate);
+    void reset();
+    void process(float *left, float *right, int frames);
+
+private:
+    DelayLine lineL, lineR;
+    float sampleRate;
+    float maxSeconds; // Longest delay time the lines were sized for
+};
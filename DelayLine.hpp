@@ -0,0 +1,49 @@
+#pragma once
+#include <algorithm>
+#include "Arena.hpp"
+
+// Circular buffer sized once for the largest delay at the highest supported
+// sample rate, taken from the engine arena. setLength() only changes the wrap
+// point, so nothing is allocated after construction.
+class DelayLine
+{
+public:
+    DelayLine() : buffer(nullptr), capacity(0), length(1), writePos(0) {}
+    DelayLine(Arena &arena, int capacity)
+        : buffer(arena.allocate<float>(std::max(capacity, 1))), capacity(std::max(capacity, 1)), length(this->capacity), writePos(0) {}
+
+    void setLength(int samples)
+    {
+        length = std::max(1, std::min(samples, capacity));
+        writePos %= length;
+    }
+    int getLength() const { return length; }
+    void clear() { std::fill(buffer, buffer + length, 0.0f); }
+
+    inline void write(float x)
+    {
+        buffer[writePos] = x;
+        if (++writePos == length)
+            writePos = 0;
+    }
+    // delay: 1..length samples back from the next write position
+    inline float read(int delay) const
+    {
+        int p = writePos - delay;
+        if (p < 0)
+            p += length;
+        return buffer[p];
+    }
+    inline float readLinear(float delay) const
+    {
+        int d = (int)delay;
+        float frac = delay - d;
+        return read(d) + frac * (read(d + 1) - read(d));
+    }
+
+private:
+    float *buffer;
+    int capacity;
+    int length;
+    int writePos;
+};
@@ -0,0 +1,38 @@
+#include "EffectsChain.hpp"
+
+namespace
+{
+    template <typename Effect>
+    void run(Effect &fx, bool &active, float *left, float *right, int frames)
+    {
+        if (!fx.enabled)
+        {
+            active = false;
+            return;
+        }
+        if (!active)
+        {
+            fx.reset(); // Don't replay a stale tail from the last time it was on
+            active = true;
+        }
+        fx.process(left, right, frames);
+    }
+}
+
+EffectsChain::EffectsChain(Arena &arena, int maxSampleRate, float maxDelaySeconds)
+    : chorus(arena, maxSampleRate), delay(arena, maxSampleRate, maxDelaySeconds), reverb(arena, maxSampleRate),
+      chorusActive(false), delayActive(false), reverbActive(false) {}
+
+void EffectsChain::prepare(float sampleRate)
+{
+    chorus.prepare(sampleRate);
+    delay.prepare(sampleRate);
+    reverb.prepare(sampleRate);
+}
+
+void EffectsChain::process(float *left, float *right, int frames)
+{
+    run(chorus, chorusActive, left, right, frames);
+    run(delay, delayActive, left, right, frames);
+    run(reverb, reverbActive, left, right, frames);
+}
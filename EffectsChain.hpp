@@ -0,0 +1,23 @@
+#pragma once
+#include "Chorus.hpp"
+#include "Delay.hpp"
+#include "Reverb.hpp"
+
+// Post-synth stereo effects: chorus -> delay -> reverb. Every buffer is taken
+// from the arena in the constructor, sized for maxSampleRate; process() never
+// allocates. A disabled effect is skipped entirely and is cleared when it is
+// switched back on.
+class EffectsChain
+{
+public:
+    Chorus chorus;
+    Delay delay;
+    Reverb reverb;
+
+    EffectsChain(Arena &arena, int maxSampleRate, float maxDelaySeconds = 2.0f);
+    void prepare(float sampleRate);
+    void process(float *left, float *right, int frames);
+
+private:
+    bool chorusActive, delayActive, reverbActive;
+};
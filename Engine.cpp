@@ -0,0 +1,693 @@
+#include "Engine.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // The arena is sized by building the arena-backed members once against a counting arena
+    struct Layout
+    {
+        EffectsChain effects;
+        Sampler sampler;
+        Granular granular;
+        Limiter limiter;
+        Part::VoicePool voices;
+        Layout(Arena &arena, const EngineConfig &config)
+            : effects(arena, config.maxSampleRate, config.maxDelaySeconds), sampler(arena), granular(arena), limiter(arena),
+              voices(arena, Engine::MAX_PARTS * Part::MAX_VOICES)
+        {
+            arena.allocate<float>(Engine::MAX_PARTS * 2 * Synth::MAX_BLOCK);
+            arena.allocate<float>(2 * Synth::MAX_BLOCK);
+            arena.allocate<Event>(Engine::INBOX_SIZE);
+        }
+    };
+
+    inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    // How long a worker keeps spinning for the next generation before it parks
+    constexpr auto WORKER_SPIN = std::chrono::microseconds(1000);
+
+    // Sleeps while word still holds seen. Elsewhere than Linux, a short nap
+    // instead: the audio thread takes any job a late worker has not.
+    void parkOn(std::atomic<uint32_t> &word, uint32_t seen)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, seen, nullptr, nullptr, 0);
+#else
+        if (word.load(std::memory_order_acquire) == seen)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+#endif
+    }
+
+    // Non-blocking; only called when someone is parked
+    void wakeAll(std::atomic<uint32_t> &word)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+        (void)word;
+#endif
+    }
+}
+
+Engine::Engine(const EngineConfig &config)
+    : config(config), arena(Arena::footprint<Layout>(config)), parts(), synth(parts[0].patch),
+      effects(arena, config.maxSampleRate, config.maxDelaySeconds), convolution(), sampler(arena), granular(arena), limiter(arena), sampleRate(44100.0f), sampleTime(0),
+      timeline(nullptr), cursor(0), voicePool(arena, MAX_PARTS * Part::MAX_VOICES), voiceAge(0),
+      partBus(arena.allocate<float>(MAX_PARTS * 2 * Synth::MAX_BLOCK)), scratch(arena.allocate<float>(2 * Synth::MAX_BLOCK)),
+      workersReady(0), workersRunning(false), jobClaim(0), jobGeneration(0), workersParked(0), jobsDone(0), jobParts(), jobFrames(0), jobDt(0.0f),
+      lockValue(), lockMask(0), sequenceLockValue(), sequenceLockMask(0),
+      sampleTimeShared(0), automation(nullptr), pendingAutomation(nullptr), retiredAutomation(nullptr),
+      automationRequested(false), automationActive(false), automationStart(0), automationValue(), automationMask(0),
+      tuning(nullptr), pendingTuning(nullptr), retiredTuning(nullptr),
+      sequence(nullptr), pendingSequence(nullptr), retiredSequence(nullptr), sequenceRequested(false),
+      sequencePositionShared(0), sequenceActive(false), sequencePos(0), sequenceCursor(0), sequenceNote(-1),
+      inbox(arena.allocate<Event>(INBOX_SIZE)), inboxWrite(0), inboxRead(0), arpActive(false), qualityApplied(0)
+{
+    for (int p = 0; p < MAX_PARTS; ++p)
+        parts[p].channel = (uint8_t)p;
+    parts[0].polyphony = 1; // The original mono synth: last note wins
+
+    // Knobs start where the synth already is, so nothing changes until the UI moves one
+    params[(int)Param::Volume] = synth.amplitude;
+    params[(int)Param::Cutoff] = synth.baseCutoff;
+    params[(int)Param::Attack] = synth.env.attack;
+    params[(int)Param::Decay] = synth.env.decay;
+    params[(int)Param::Release] = synth.env.release;
+    params[(int)Param::LfoDepth] = synth.lfo.depth;
+    params[(int)Param::Pan] = synth.pan;
+    params[(int)Param::LfoRate] = synth.lfo.rate;
+    params[(int)Param::Sustain] = synth.env.sustain;
+}
+
+Engine::~Engine()
+{
+    stopWorkers();
+    delete sequence;
+    delete pendingSequence.load();
+    delete retiredSequence.load();
+    delete automation;
+    delete pendingAutomation.load();
+    delete retiredAutomation.load();
+    delete tuning;
+    delete pendingTuning.load();
+    delete retiredTuning.load();
+}
+
+void Engine::prepare(float sr)
+{
+    sampleRate = sr;
+    effects.prepare(sr);
+    convolution.prepare(sr);
+    sampler.prepare(sr);
+    granular.prepare(sr);
+    arp.prepare(sr);
+    limiter.prepare(sr);
+}
+
+void Engine::setTimeline(const std::vector<Event> *events)
+{
+    timeline = events;
+    cursor = 0;
+    // Skip anything already in the past so a late start does not fire a burst of events
+    if (timeline)
+    {
+        while (cursor < timeline->size() && (*timeline)[cursor].time < sampleTime)
+            ++cursor;
+    }
+}
+
+bool Engine::timelineFinished() const
+{
+    return !timeline || cursor >= timeline->size();
+}
+
+Part &Engine::partFor(uint8_t channel)
+{
+    for (Part &part : parts)
+    {
+        if (part.enabled && part.channel == channel)
+            return part;
+    }
+    return parts[0];
+}
+
+bool Engine::postEvent(const Event &event)
+{
+    uint32_t w = inboxWrite.load(std::memory_order_relaxed);
+    if (w - inboxRead.load(std::memory_order_acquire) >= (uint32_t)INBOX_SIZE)
+        return false;
+    inbox[w % INBOX_SIZE] = event;
+    inboxWrite.store(w + 1, std::memory_order_release);
+    return true;
+}
+
+void Engine::handleEvent(const Event &event)
+{
+    // While the arpeggiator runs it owns the notes; it plays them back through dispatch()
+    if (arpActive)
+    {
+        if (event.type == EventType::NoteOn)
+        {
+            arp.noteOn(event.note, event.velocity, sampleTime);
+            return;
+        }
+        if (event.type == EventType::NoteOff)
+        {
+            arp.noteOff(event.note);
+            return;
+        }
+        if (event.type == EventType::Controller && (event.note == 120 || event.note == 123))
+            arp.clear();
+    }
+    dispatch(event);
+}
+
+void Engine::setLocks(const Event &event, unsigned &mask, float *values)
+{
+    for (int p = 0; p < (int)Param::Count; ++p)
+    {
+        if (paramController[p] != event.note)
+            continue;
+        if (event.value < 0.0f)
+            mask &= ~(1u << p);
+        else
+        {
+            mask |= 1u << p;
+            values[p] = event.value;
+        }
+    }
+}
+
+void Engine::dispatch(const Event &event)
+{
+    if (event.type == EventType::Controller)
+        setLocks(event, lockMask, lockValue);
+
+    Part &part = partFor(event.channel);
+    if (granular.hasSource() && granular.part == (int)(&part - parts))
+    {
+        if (event.type == EventType::NoteOn)
+            granular.noteOn(event.note, event.velocity);
+        else if (event.type == EventType::NoteOff)
+            granular.noteOff(event.note);
+        else if (event.type == EventType::Controller && (event.note == 120 || event.note == 123))
+            granular.allNotesOff();
+        return;
+    }
+    if (sampler.loaded() && &part == &parts[0])
+    {
+        if (event.type == EventType::NoteOn)
+            sampler.noteOn(event.note, event.velocity);
+        else if (event.type == EventType::NoteOff)
+            sampler.noteOff(event.note);
+        else if (event.type == EventType::Controller && (event.note == 120 || event.note == 123))
+            sampler.allNotesOff();
+        return;
+    }
+
+    switch (event.type)
+    {
+    case EventType::NoteOn:
+        part.noteOn(voicePool, event.note, ++voiceAge);
+        break;
+    case EventType::NoteOff:
+        part.noteOff(event.note);
+        break;
+    case EventType::PitchBend:
+        part.setPitchBend(event.value);
+        break;
+    case EventType::Controller:
+        if (event.note == 120 || event.note == 123) // All sound / all notes off
+            part.allNotesOff();
+        break;
+    }
+}
+
+void Engine::applyParams()
+{
+    float v[(int)Param::Count];
+    for (int p = 0; p < (int)Param::Count; ++p)
+    {
+        if (sequenceLockMask & (1u << p))
+            v[p] = paramMin[p] + sequenceLockValue[p] * (paramMax[p] - paramMin[p]);
+        else if (lockMask & (1u << p))
+            v[p] = paramMin[p] + lockValue[p] * (paramMax[p] - paramMin[p]);
+        else if (automationMask & (1u << p))
+            v[p] = paramMin[p] + automationValue[p] * (paramMax[p] - paramMin[p]);
+        else
+            v[p] = params[p];
+    }
+
+    synth.amplitude = v[(int)Param::Volume];
+    sampler.gain = v[(int)Param::Volume];
+    synth.baseCutoff = v[(int)Param::Cutoff];
+    if (synth.lfo.target != LFOTarget::Filter)
+        synth.filter.setCutoff(v[(int)Param::Cutoff]);
+    synth.env.attack = v[(int)Param::Attack];
+    synth.env.decay = v[(int)Param::Decay];
+    synth.env.release = v[(int)Param::Release];
+    synth.lfo.depth = v[(int)Param::LfoDepth];
+    synth.pan = v[(int)Param::Pan];
+    synth.lfo.rate = v[(int)Param::LfoRate];
+    synth.env.sustain = v[(int)Param::Sustain];
+}
+
+void Engine::publishSequence(SequenceTimeline *next)
+{
+    delete retiredSequence.exchange(nullptr);
+    // A sequence the audio thread never picked up is replaced and freed here
+    delete pendingSequence.exchange(next);
+}
+
+void Engine::swapSequence()
+{
+    // Only swap when the retired slot is free; the UI thread empties it
+    if (retiredSequence.load() != nullptr)
+        return;
+    SequenceTimeline *next = pendingSequence.exchange(nullptr);
+    if (!next)
+        return;
+    retiredSequence.store(sequence);
+    sequence = next;
+
+    // Same place in the loop, first event not yet played
+    const std::vector<Event> &events = sequence->events;
+    sequencePos %= sequence->length;
+    sequenceCursor = std::lower_bound(events.begin(), events.end(), sequencePos, [](const Event &e, uint64_t t)
+                                      { return e.time < t; }) -
+                     events.begin();
+
+    // A held note whose note-off was edited away would ring forever
+    if (sequenceNote >= 0)
+    {
+        bool released = false;
+        for (size_t i = sequenceCursor; i < events.size(); ++i)
+        {
+            if (events[i].note == sequenceNote && events[i].type != EventType::Controller)
+            {
+                released = events[i].type == EventType::NoteOff;
+                break;
+            }
+        }
+        if (!released)
+        {
+            handleEvent({sampleTime, EventType::NoteOff, 0, (uint8_t)sequenceNote, 0, 0.0f});
+            sequenceNote = -1;
+        }
+    }
+    // Step locks are re-sent by the new sequence from its next step on; controller overrides stay
+    sequenceLockMask = 0;
+}
+
+void Engine::publishAutomation(Automation *next)
+{
+    delete retiredAutomation.exchange(nullptr);
+    delete pendingAutomation.exchange(next);
+}
+
+void Engine::swapAutomation()
+{
+    if (retiredAutomation.load() != nullptr)
+        return;
+    Automation *next = pendingAutomation.exchange(nullptr);
+    if (!next)
+        return;
+    retiredAutomation.store(automation);
+    automation = next;
+    automationActive = false; // Restarts from the top of the new take
+}
+
+void Engine::publishTuning(Tuning *next)
+{
+    delete retiredTuning.exchange(nullptr);
+    delete pendingTuning.exchange(next);
+}
+
+void Engine::swapTuning()
+{
+    if (retiredTuning.load() != nullptr)
+        return;
+    Tuning *next = pendingTuning.exchange(nullptr);
+    if (!next)
+        return;
+    retiredTuning.store(tuning);
+    tuning = next;
+    for (Part &part : parts)
+        part.setTuning(tuning);
+    sampler.setTuning(tuning);
+    granular.setTuning(tuning);
+}
+
+int Engine::runAutomation(int frames)
+{
+    bool play = automationRequested.load(std::memory_order_relaxed) && automation;
+    if (play != automationActive)
+    {
+        automationActive = play;
+        automationMask = 0; // Knobs take over again when replay stops
+        if (play)
+        {
+            automationReader = Automation::Reader(*automation);
+            automationStart = sampleTime;
+        }
+    }
+    if (!automationActive)
+        return frames;
+
+    // Lanes hold their last value once the take has run out
+    uint64_t position = sampleTime - automationStart;
+    while (!automationReader.done() && automationReader.nextTime() <= position)
+    {
+        Automation::Point p = automationReader.next();
+        automationValue[(int)p.param] = p.value;
+        automationMask |= 1u << (int)p.param;
+    }
+    if (automationReader.done())
+        return frames;
+    return (int)std::min<uint64_t>(frames, automationReader.nextTime() - position);
+}
+
+int Engine::runArp(int frames)
+{
+    if (arp.enabled != arpActive)
+    {
+        arpActive = arp.enabled;
+        // Notes held across the switch would otherwise hang on one side of it
+        if (arpActive)
+            dispatch({sampleTime, EventType::Controller, 0, 123, 0, 0.0f});
+        else
+            arp.clear();
+    }
+    if (!arpActive && !arp.sounding())
+        return frames;
+
+    Event out[2];
+    int count = arp.process(sampleTime, out);
+    for (int i = 0; i < count; ++i)
+        dispatch(out[i]);
+    return (int)std::min<uint64_t>(frames, arp.nextEventTime() - sampleTime);
+}
+
+int Engine::runSequence(int frames)
+{
+    bool play = sequenceRequested.load(std::memory_order_relaxed) && sequence;
+    if (play != sequenceActive)
+    {
+        sequenceActive = play;
+        sequencePos = 0;
+        sequenceCursor = 0;
+        if (!play)
+        {
+            if (sequenceNote >= 0)
+                handleEvent({sampleTime, EventType::NoteOff, 0, (uint8_t)sequenceNote, 0, 0.0f});
+            sequenceNote = -1;
+            sequenceLockMask = 0;
+        }
+    }
+    if (!sequenceActive)
+        return frames;
+
+    const std::vector<Event> &events = sequence->events;
+    while (sequenceCursor < events.size() && events[sequenceCursor].time <= sequencePos)
+    {
+        const Event &e = events[sequenceCursor++];
+        if (e.type == EventType::NoteOn)
+            sequenceNote = e.note;
+        else if (e.type == EventType::NoteOff && e.note == sequenceNote)
+            sequenceNote = -1;
+        if (e.type == EventType::Controller)
+            setLocks(e, sequenceLockMask, sequenceLockValue); // The sequence only sends step locks
+        else
+            handleEvent(e);
+    }
+    uint64_t next = sequenceCursor < events.size() ? events[sequenceCursor].time : sequence->length;
+    return (int)std::min<uint64_t>(frames, next - sequencePos);
+}
+
+void Engine::render(float *left, float *right, int frames)
+{
+    const float dt = 1.0f / sampleRate;
+    auto started = std::chrono::steady_clock::now();
+    Trace::Zone input("engine input");
+    swapSequence();
+    swapAutomation();
+    swapTuning();
+    granular.swapSource();
+    if (quality.level() != qualityApplied)
+        applyQuality();
+
+    // Live input lands on the first sample of the callback
+    uint32_t w = inboxWrite.load(std::memory_order_acquire);
+    uint32_t r = inboxRead.load(std::memory_order_relaxed);
+    for (; r != w; ++r)
+    {
+        Event e = inbox[r % INBOX_SIZE];
+        e.time = sampleTime;
+        handleEvent(e);
+    }
+    inboxRead.store(r, std::memory_order_release);
+    input.end();
+    int done = 0;
+    while (done < frames)
+    {
+        int chunk = std::min(frames - done, Synth::MAX_BLOCK);
+        float *l = left + done;
+        float *r = right + done;
+
+        int pos = 0;
+        while (pos < chunk)
+        {
+            // Fire everything due now, then render up to the next event
+            int n = chunk - pos;
+            if (timeline)
+            {
+                while (cursor < timeline->size() && (*timeline)[cursor].time <= sampleTime)
+                    handleEvent((*timeline)[cursor++]);
+                if (cursor < timeline->size())
+                    n = (int)std::min<uint64_t>(n, (*timeline)[cursor].time - sampleTime);
+            }
+            n = runSequence(n);
+            n = runArp(n);
+            n = runAutomation(n);
+            applyParams();
+            bool written = false;
+            if (sampler.loaded())
+            {
+                Trace::Zone zone("sampler");
+                std::fill(l + pos, l + pos + n, 0.0f);
+                std::fill(r + pos, r + pos + n, 0.0f);
+                sampler.process(l + pos, r + pos, n);
+                written = true;
+            }
+            if (granular.active())
+            {
+                Trace::Zone zone("granular");
+                if (!written)
+                {
+                    std::fill(l + pos, l + pos + n, 0.0f);
+                    std::fill(r + pos, r + pos + n, 0.0f);
+                }
+                granular.process(l + pos, r + pos, n);
+                written = true;
+            }
+            if (!renderParts(l + pos, r + pos, n, dt, written))
+            {
+                std::fill(l + pos, l + pos + n, 0.0f);
+                std::fill(r + pos, r + pos + n, 0.0f);
+            }
+            pos += n;
+            sampleTime += n;
+            if (sequenceActive)
+            {
+                sequencePos += n;
+                if (sequencePos >= sequence->length)
+                {
+                    sequencePos = 0;
+                    sequenceCursor = 0;
+                }
+            }
+        }
+        sequencePositionShared.store(sequencePos, std::memory_order_relaxed);
+
+        Trace::Zone post("effects");
+        effects.process(l, r, chunk);
+        post.next("convolution");
+        convolution.process(l, r, chunk);
+        post.next("limiter");
+        limiter.process(l, r, chunk);
+        done += chunk;
+    }
+    sampleTimeShared.store(sampleTime, std::memory_order_relaxed);
+
+    // Load is the share of the period this render used; a new level applies from the next render
+    if (quality.enabled && frames > 0)
+    {
+        float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - started).count();
+        quality.update(seconds * sampleRate / frames, sampleTime);
+    }
+}
+
+void Engine::applyQuality()
+{
+    qualityApplied = quality.level();
+    const QualityGovernor::Level &level = QualityGovernor::settings(qualityApplied);
+    for (Part &part : parts)
+    {
+        part.voiceCap = level.voices;
+        part.unisonCap = level.unisonVoices;
+        part.controlInterval = level.controlInterval;
+    }
+    effects.reverb.setCombs(level.reverbCombs);
+}
+
+bool Engine::renderParts(float *left, float *right, int frames, float dt, bool written)
+{
+    // Idle parts cost this scan and nothing else
+    int active[MAX_PARTS], count = 0;
+    for (int p = 0; p < MAX_PARTS; ++p)
+    {
+        if (parts[p].active())
+            active[count++] = p;
+    }
+    if (count == 0)
+        return written;
+    Trace::Zone zone("parts");
+
+    // The first sounding part writes the bus, unless the sampler already has;
+    // the rest are added after it in part order
+    int first = written ? 0 : 1;
+    bool parallel = count > first && workersRunning.load(std::memory_order_relaxed);
+    uint32_t generation = 0;
+    if (parallel)
+    {
+        for (int i = first; i < count; ++i)
+            jobParts[i - first] = active[i];
+        jobFrames = frames;
+        jobDt = dt;
+        jobsDone.store(0, std::memory_order_relaxed);
+        generation = jobGeneration.load(std::memory_order_relaxed) + 1;
+        jobClaim.store((uint64_t)generation << 32 | (uint64_t)(count - first) << 16, std::memory_order_release);
+        // Paired with the worker's count-then-check in partWorkerLoop: either it
+        // sees this generation or this sees it parked
+        jobGeneration.store(generation, std::memory_order_seq_cst);
+        if (workersParked.load(std::memory_order_seq_cst) > 0)
+            wakeAll(jobGeneration);
+    }
+
+    if (!written)
+        parts[active[0]].render(left, right, frames, dt);
+
+    if (parallel)
+    {
+        // Help with the remaining jobs, then wait for the ones the helpers took
+        runPartJobs(generation);
+        while (jobsDone.load(std::memory_order_acquire) < count - first)
+            cpuRelax();
+    }
+    for (int i = first; i < count; ++i)
+    {
+        float *l = parallel ? partBus + active[i] * 2 * Synth::MAX_BLOCK : scratch;
+        float *r = l + Synth::MAX_BLOCK;
+        if (!parallel)
+            parts[active[i]].render(l, r, frames, dt);
+        for (int j = 0; j < frames; ++j)
+        {
+            left[j] += l[j];
+            right[j] += r[j];
+        }
+    }
+
+    for (int i = 0; i < count; ++i)
+        parts[active[i]].reap(voicePool);
+    return true;
+}
+
+void Engine::runPartJobs(uint32_t generation)
+{
+    for (;;)
+    {
+        uint64_t claim = jobClaim.load(std::memory_order_acquire);
+        uint32_t job = claim & 0xffff, jobs = (claim >> 16) & 0xffff;
+        if ((uint32_t)(claim >> 32) != generation || job >= jobs)
+            return;
+        if (!jobClaim.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel))
+            continue;
+        Trace::Zone zone("part job");
+        int p = jobParts[job];
+        float *l = partBus + p * 2 * Synth::MAX_BLOCK;
+        parts[p].render(l, l + Synth::MAX_BLOCK, jobFrames, jobDt);
+        jobsDone.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void Engine::partWorkerLoop(int worker)
+{
+    Trace::nameThread("part worker");
+    workerStatuses[worker] = RealTime::apply(workerPolicy, worker);
+    workersReady.fetch_add(1, std::memory_order_release);
+    uint32_t seen = jobGeneration.load(std::memory_order_acquire);
+    auto spinUntil = std::chrono::steady_clock::now() + WORKER_SPIN;
+    for (unsigned spins = 1; workersRunning.load(std::memory_order_relaxed); ++spins)
+    {
+        uint32_t generation = jobGeneration.load(std::memory_order_acquire);
+        if (generation != seen)
+        {
+            seen = generation;
+            runPartJobs(generation);
+            spinUntil = std::chrono::steady_clock::now() + WORKER_SPIN;
+            continue;
+        }
+        if (spins % 64 != 0 || std::chrono::steady_clock::now() < spinUntil)
+        {
+            cpuRelax();
+            continue;
+        }
+        workersParked.fetch_add(1, std::memory_order_seq_cst);
+        if (jobGeneration.load(std::memory_order_seq_cst) == seen)
+            parkOn(jobGeneration, seen);
+        workersParked.fetch_sub(1, std::memory_order_relaxed);
+        spinUntil = std::chrono::steady_clock::now() + WORKER_SPIN;
+    }
+}
+
+void Engine::startWorkers(int count)
+{
+    stopWorkers();
+    if (count <= 0)
+        return;
+    workersRunning.store(true);
+    workerStatuses.assign(count, RealTime::Status());
+    workersReady.store(0);
+    for (int i = 0; i < count; ++i)
+        partWorkers.emplace_back(&Engine::partWorkerLoop, this, i);
+    while (workersReady.load(std::memory_order_acquire) < count)
+        std::this_thread::yield();
+}
+
+void Engine::stopWorkers()
+{
+    // A callback that finds the flag cleared mid-render finishes the jobs itself.
+    // The bump wakes parked workers; no job carries that generation.
+    workersRunning.store(false);
+    jobGeneration.fetch_add(1, std::memory_order_seq_cst);
+    wakeAll(jobGeneration);
+    for (std::thread &t : partWorkers)
+        t.join();
+    partWorkers.clear();
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "Arena.hpp"
+#include "Synth.hpp"
+#include "Part.hpp"
+#include "EffectsChain.hpp"
+#include "ConvolutionReverb.hpp"
+#include "Sampler.hpp"
+#include "Granular.hpp"
+#include "Limiter.hpp"
+#include "Event.hpp"
+#include "Sequencer.hpp"
+#include "Arpeggiator.hpp"
+#include "Automation.hpp"
+#include "Tuning.hpp"
+#include "RealTime.hpp"
+#include "QualityGovernor.hpp"
+
+// Sizes everything the engine reserves at construction
+struct EngineConfig
+{
+    int maxSampleRate = 96000;    // prepare() above this shortens the delay lines
+    float maxDelaySeconds = 2.0f; // Longest tempo-synced delay
+};
+
+// Everything between note events and the stereo output: synth parts, sampler or grains,
+// effects and convolution, plus the event timeline and sequencer cursors. The audio callback and the
+// offline renderer both drive it through render(). All DSP buffers live in
+// one arena reserved in the constructor; nothing is allocated after that.
+class Engine
+{
+private:
+    EngineConfig config;
+    Arena arena; // Declared before everything that takes storage from it
+
+public:
+    static constexpr int MAX_PARTS = 8;
+
+    // Part p listens on MIDI channel p until changed; events on a channel no
+    // enabled part listens to go to part 0. Part 0 starts mono, the others polyphonic.
+    Part parts[MAX_PARTS];
+    Synth &synth; // Part 0's patch: the knobs, locks and automation drive it
+    EffectsChain effects;
+    ConvolutionReverb convolution;
+    Sampler sampler; // Takes part 0's notes instead of its synth once a library is loaded
+    Granular granular; // Takes the notes of part granular.part once it has a source
+    Limiter limiter;   // Last on the master bus; off until enabled, then delays the output by limiter.latency()
+    Arpeggiator arp;  // Sits between incoming notes and the voices while enabled
+    // Off until enabled: times every render and lowers quality near the deadline.
+    // A level set here takes effect at the next render.
+    QualityGovernor quality;
+
+    static constexpr int INBOX_SIZE = 256;
+
+    explicit Engine(const EngineConfig &config = EngineConfig());
+    Engine(const Engine &) = delete;
+    Engine &operator=(const Engine &) = delete;
+    ~Engine();
+    void prepare(float sampleRate);
+    // Set before playback starts; the engine walks it with a cursor and never modifies it
+    void setTimeline(const std::vector<Event> *events);
+    bool timelineFinished() const;
+    // Renders any number of frames; synth blocks are split at event times so
+    // every event lands on its exact sample
+    void render(float *left, float *right, int frames);
+    // Audio thread: every note source (timeline, sequencer, inbox) enters here
+    void handleEvent(const Event &event);
+    // UI thread: queues a live event (keyboard, mouse) for the start of the next
+    // callback. Lock-free single producer; returns false if the queue is full.
+    bool postEvent(const Event &event);
+    // Inbox slots used so far (UI thread) and drained so far (audio thread); the
+    // next posted event takes slot inboxPosted()
+    uint32_t inboxPosted() const { return inboxWrite.load(std::memory_order_relaxed); }
+    uint32_t inboxConsumed() const { return inboxRead.load(std::memory_order_relaxed); }
+
+    // UI thread: knob values in their own units. Controllers and parameter
+    // locks override them on the audio thread until released.
+    void setParam(Param param, float value) { params[(int)param] = value; }
+    float getParam(Param param) const { return params[(int)param]; }
+
+    // UI thread: hands over a compiled sequence (ownership included). The audio
+    // thread swaps it in at the next callback and carries on from the same
+    // position in the loop, so editing never stops playback.
+    void publishSequence(SequenceTimeline *sequence);
+    void playSequence(bool play) { sequenceRequested = play; }
+    bool sequencePlaying() const { return sequenceRequested; }
+    uint64_t sequencePosition() const { return sequencePositionShared.load(std::memory_order_relaxed); }
+
+    // UI thread: hands over recorded automation (ownership included). While
+    // playing, its lanes override the knobs, replayed from the start of the take
+    // at the callback that picks it up; controllers and locks still win.
+    void publishAutomation(Automation *automation);
+    void playAutomation(bool play) { automationRequested = play; }
+    bool automationPlaying() const { return automationRequested; }
+
+    // UI thread: hands over a tuning (ownership included) for the parts, sampler
+    // and grains. The audio thread swaps it in at the next callback; sounding
+    // synth notes are retuned in place. Until then, 12-TET at A4 = 440 Hz.
+    void publishTuning(Tuning *tuning);
+
+    // UI thread, while no callback is running: helper threads that render parts
+    // alongside the audio thread. After each batch of jobs they spin for
+    // WORKER_SPIN, then sleep until a callback publishes parallel jobs, so
+    // they cost nothing while at most one part sounds. The mix is
+    // bit-identical to rendering alone.
+    // Each worker applies workerPolicy to itself before returning from
+    // startWorkers; worker i takes the single CPU workerPolicy.cpus[i % size].
+    void startWorkers(int count);
+    void stopWorkers();
+    int workers() const { return (int)partWorkers.size(); }
+    const RealTime::Status &workerStatus(int worker) const { return workerStatuses[worker]; }
+    RealTime::ThreadPolicy workerPolicy;
+    int voicesSounding() const { return voicePool.size(); }
+
+    uint64_t time() const { return sampleTime; }
+    // Any thread: sample time where the next callback starts, which is where a
+    // knob moved now takes effect
+    uint64_t sharedTime() const { return sampleTimeShared.load(std::memory_order_relaxed); }
+    float getSampleRate() const { return sampleRate; }
+    const EngineConfig &getConfig() const { return config; }
+    size_t memoryBytes() const { return arena.size(); }
+
+private:
+    float sampleRate;
+    uint64_t sampleTime;
+    const std::vector<Event> *timeline;
+    size_t cursor;
+
+    Part::VoicePool voicePool; // Shared by every part
+    unsigned long voiceAge;
+    float *partBus;            // MAX_PARTS stereo blocks from the arena, for parallel renders
+    float *scratch;            // One stereo block for serial renders
+
+    // Parallel part rendering. jobClaim packs the job generation (high 32
+    // bits), the job count and the next unclaimed job (16 bits each), so a
+    // helper that wakes late can never claim a job of the following generation.
+    std::vector<std::thread> partWorkers;
+    std::vector<RealTime::Status> workerStatuses; // Entry i written by worker i before it counts itself ready
+    std::atomic<int> workersReady;
+    std::atomic<bool> workersRunning;
+    std::atomic<uint64_t> jobClaim;
+    std::atomic<uint32_t> jobGeneration; // Last generation published; parked workers sleep on it
+    std::atomic<int> workersParked;
+    std::atomic<int> jobsDone;
+    int jobParts[MAX_PARTS];
+    int jobFrames;
+    float jobDt;
+
+    float params[(int)Param::Count];
+    float lockValue[(int)Param::Count]; // 0..1 within the parameter's range
+    unsigned lockMask;                  // Bit per Param overridden by a MIDI or live controller
+    float sequenceLockValue[(int)Param::Count];
+    unsigned sequenceLockMask; // Sequencer step locks; cleared when the sequence changes or stops
+    std::atomic<uint64_t> sampleTimeShared;
+
+    Automation *automation; // Owned by the audio thread
+    std::atomic<Automation *> pendingAutomation;
+    std::atomic<Automation *> retiredAutomation; // Freed by the UI thread on its next publish
+    std::atomic<bool> automationRequested;
+    bool automationActive;
+    Automation::Reader automationReader;
+    uint64_t automationStart;                   // Sample time of the take's first sample
+    float automationValue[(int)Param::Count];   // 0..1 within the parameter's range
+    unsigned automationMask;                    // Bit per Param the automation has set
+
+    Tuning *tuning; // Owned by the audio thread; null until the first publish
+    std::atomic<Tuning *> pendingTuning;
+    std::atomic<Tuning *> retiredTuning; // Freed by the UI thread on its next publish
+
+    SequenceTimeline *sequence; // Owned by the audio thread
+    std::atomic<SequenceTimeline *> pendingSequence;
+    std::atomic<SequenceTimeline *> retiredSequence; // Freed by the UI thread on its next publish
+    std::atomic<bool> sequenceRequested;
+    std::atomic<uint64_t> sequencePositionShared;
+    bool sequenceActive;
+    uint64_t sequencePos; // Samples into the loop
+    size_t sequenceCursor;
+    int sequenceNote; // Note the sequencer is holding, or -1
+
+    Event *inbox; // INBOX_SIZE slots from the arena
+    std::atomic<uint32_t> inboxWrite, inboxRead;
+    bool arpActive;
+    int qualityApplied; // Governor level the parts and reverb are set to
+
+    void dispatch(const Event &event); // Straight to the voices
+    // A mapped controller sets its Param in mask and values; a negative value releases it
+    static void setLocks(const Event &event, unsigned &mask, float *values);
+    Part &partFor(uint8_t channel);
+    // Mixes every sounding part into the buffers; writes them unless written
+    // is already true, and returns whether anything was written
+    bool renderParts(float *left, float *right, int frames, float dt, bool written);
+    void runPartJobs(uint32_t generation);
+    void partWorkerLoop(int worker);
+    void applyParams();
+    void applyQuality();
+    void swapSequence();
+    void swapAutomation();
+    void swapTuning();
+    int runAutomation(int frames); // Applies due points; returns frames until the next one
+    int runSequence(int frames); // Fires due events; returns frames until the next one
+    int runArp(int frames);
+};
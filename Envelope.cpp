@@ -1,7 +1,8 @@
 #include "Envelope.hpp"
+#include "FastMath.hpp"
 
 Envelope::Envelope(float a, float d, float s, float r)
-    : attack(a), decay(d), sustain(s), release(r), value(0.0f), time(0.0f), state(0) {}
+    : attack(a), decay(d), sustain(s), release(r), value(0.0f), time(0.0f), state(0), rangeDb(0.0f) {}
 
 void Envelope::noteOn() {
     state = 1;
@@ -19,5 +20,23 @@ float Envelope::process(float dt) {
         case 3: value = sustain; break;
         case 4: value -= dt * sustain / release; if (value <= 0.0f) { value = 0.0f; state = 0; } break;
     }
-    return value;
+    return rangeDb > 0.0f ? shape(value) : value;
+}
+
+// Idle and sustain segments are constant, so the whole block is filled without stepping the state machine.
+void Envelope::processBlock(float* out, int frames, float dt) {
+    int i = 0;
+    while (i < frames) {
+        if (state == 0 || state == 3) {
+            value = (state == 0) ? 0.0f : sustain;
+            float v = rangeDb > 0.0f ? shape(value) : value;
+            for (; i < frames; ++i) out[i] = v;
+            break;
+        }
+        out[i++] = process(dt);
+    }
+}
+
+float Envelope::shape(float v) const {
+    return v * FastMath::dbToGain<FastMath::Precision::Balanced>((v - 1.0f) * rangeDb);
 }
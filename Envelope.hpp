@@ -3,8 +3,11 @@ class Envelope {
 public:
     float attack, decay, sustain, release, value, time;
     int state;
+    float rangeDb; // 0 keeps the output linear; otherwise the ramps sweep rangeDb decibels, fading linearly to 0 at the bottom
     Envelope(float a = 0.01f, float d = 0.1f, float s = 0.8f, float r = 0.2f);
     void noteOn();
     void noteOff();
     float process(float dt);
+    void processBlock(float* out, int frames, float dt);
+    float shape(float v) const;
 };
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+enum class EventType : uint8_t
+{
+    NoteOff = 0,
+    NoteOn = 1,
+    Controller = 2,
+    PitchBend = 3
+};
+
+// One timestamped engine event. Events live in flat, time-sorted arrays and are
+// consumed by the audio thread with a cursor.
+struct Event
+{
+    uint64_t time; // Absolute time in samples
+    EventType type;
+    uint8_t channel;
+    uint8_t note;     // Note number, or controller number
+    uint8_t velocity; // Velocity, or controller value
+    float value;      // Pitch bend in -1..1; controller value in 0..1, negative releases a lock
+};
+
+// Synth parameters reachable from controllers and sequencer parameter locks
+enum class Param : uint8_t
+{
+    Volume,
+    Cutoff,
+    Attack,
+    Decay,
+    Release,
+    LfoDepth,
+    Pan,
+    LfoRate,
+    Sustain,
+    Count
+};
+
+// MIDI controller number each parameter listens on
+constexpr uint8_t paramController[(int)Param::Count] = {7, 74, 73, 75, 72, 1, 10, 76, 79};
+
+// What 0..1 controller, lock and automation values span, per Param; matches the UI knob ranges
+constexpr float paramMin[(int)Param::Count] = {0.0f, 100.0f, 0.001f, 0.001f, 0.001f, 0.0f, -1.0f, 1.0f, 0.0f};
+constexpr float paramMax[(int)Param::Count] = {1.0f, 5000.0f, 0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 20.0f, 1.0f};
@@ -0,0 +1,116 @@
+#include "FFT.hpp"
+#include <cmath>
+#include <utility>
+
+FFT::FFT(int size)
+    : n(size), half(size / 2), bitrev(size / 2), twRe(size >= 4 ? size / 4 : 1), twIm(size >= 4 ? size / 4 : 1),
+      splitRe(size / 2 + 1), splitIm(size / 2 + 1), workRe(size / 2), workIm(size / 2)
+{
+    int bits = 0;
+    while ((1 << bits) < half)
+        ++bits;
+    for (int i = 0; i < half; ++i)
+    {
+        int r = 0;
+        for (int b = 0; b < bits; ++b)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        bitrev[i] = r;
+    }
+    for (int k = 0; k < (int)twRe.size(); ++k)
+    {
+        double a = -2.0 * M_PI * k / half;
+        twRe[k] = (float)std::cos(a);
+        twIm[k] = (float)std::sin(a);
+    }
+    for (int k = 0; k <= half; ++k)
+    {
+        double a = -2.0 * M_PI * k / n;
+        splitRe[k] = (float)std::cos(a);
+        splitIm[k] = (float)std::sin(a);
+    }
+}
+
+void FFT::transform(float *re, float *im, bool inverse) const
+{
+    for (int i = 0; i < half; ++i)
+    {
+        int j = bitrev[i];
+        if (j > i)
+        {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    const float sign = inverse ? -1.0f : 1.0f;
+    for (int len = 2; len <= half; len <<= 1)
+    {
+        int step = half / len;
+        int h = len / 2;
+        for (int start = 0; start < half; start += len)
+        {
+            for (int k = 0; k < h; ++k)
+            {
+                float wr = twRe[k * step];
+                float wi = twIm[k * step] * sign;
+                int a = start + k, b = a + h;
+                float xr = re[b] * wr - im[b] * wi;
+                float xi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - xr;
+                im[b] = im[a] - xi;
+                re[a] += xr;
+                im[a] += xi;
+            }
+        }
+    }
+}
+
+void FFT::forward(const float *in, float *re, float *im) const
+{
+    // Pack even/odd samples as one complex sequence of half the length
+    float *zr = workRe.data(), *zi = workIm.data();
+    for (int i = 0; i < half; ++i)
+    {
+        zr[i] = in[2 * i];
+        zi[i] = in[2 * i + 1];
+    }
+    transform(zr, zi, false);
+
+    for (int k = 0; k <= half; ++k)
+    {
+        int a = k % half, b = (half - k) % half;
+        // Even/odd spectra recovered from Z[k] and conj(Z[half - k])
+        float er = 0.5f * (zr[a] + zr[b]);
+        float ei = 0.5f * (zi[a] - zi[b]);
+        float or_ = 0.5f * (zi[a] + zi[b]);
+        float oi = -0.5f * (zr[a] - zr[b]);
+        re[k] = er + splitRe[k] * or_ - splitIm[k] * oi;
+        im[k] = ei + splitRe[k] * oi + splitIm[k] * or_;
+    }
+}
+
+void FFT::inverse(const float *re, const float *im, float *out) const
+{
+    float *zr = workRe.data(), *zi = workIm.data();
+    for (int k = 0; k < half; ++k)
+    {
+        int b = half - k;
+        float er = 0.5f * (re[k] + re[b]);
+        float ei = 0.5f * (im[k] - im[b]);
+        float dr = 0.5f * (re[k] - re[b]);
+        float di = 0.5f * (im[k] + im[b]);
+        // Odd spectrum = difference rotated by W^-k
+        float or_ = dr * splitRe[k] + di * splitIm[k];
+        float oi = di * splitRe[k] - dr * splitIm[k];
+        zr[k] = er - oi;
+        zi[k] = ei + or_;
+    }
+    transform(zr, zi, true);
+
+    const float scale = 1.0f / half;
+    for (int i = 0; i < half; ++i)
+    {
+        out[2 * i] = zr[i] * scale;
+        out[2 * i + 1] = zi[i] * scale;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+
+// Real-input FFT of size N (power of two) built on an N/2 complex transform.
+// Spectra are kept in split re/im arrays of N/2 + 1 bins so the convolution
+// multiply-accumulate loops vectorise.
+class FFT
+{
+public:
+    explicit FFT(int size);
+    int size() const { return n; }
+    int bins() const { return n / 2 + 1; }
+    void forward(const float *in, float *re, float *im) const;
+    void inverse(const float *re, const float *im, float *out) const; // Includes the 1/N scale
+
+private:
+    int n, half;
+    std::vector<int> bitrev;
+    std::vector<float> twRe, twIm;     // e^{-2*pi*i*k/half}
+    std::vector<float> splitRe, splitIm; // e^{-2*pi*i*k/n} for the real/complex split
+    mutable std::vector<float> workRe, workIm;
+
+    void transform(float *re, float *im, bool inverse) const;
+};
@@ -0,0 +1,240 @@
+#include "FM.hpp"
+#include <algorithm>
+#include <cmath>
+#include "FastMath.hpp"
+#include "Simd.hpp"
+
+namespace
+{
+    constexpr int BLOCK = 256; // Frames per pass over the operators
+    // FastMath's Accurate sine, four lanes at a time
+    using FastMath::SIN_C3;
+    using FastMath::SIN_C5;
+    using FastMath::SIN_C7;
+    using FastMath::SIN_C9;
+    using FastMath::SIN_C11;
+    using FastMath::TWO_PI;
+
+#if defined(SYNTH_SSE2)
+    // Same operations in the same order as FastMath::sin2pi<Accurate>, the scalar fallback
+    inline __m128 sine4(__m128 x)
+    {
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 r = _mm_sub_ps(x, _mm_cvtepi32_ps(_mm_cvtps_epi32(x)));
+        __m128 a = _mm_andnot_ps(sign, r);
+        __m128 y = _mm_or_ps(_mm_min_ps(a, _mm_sub_ps(_mm_set1_ps(0.5f), a)), _mm_and_ps(sign, r));
+        __m128 t = _mm_mul_ps(y, _mm_set1_ps(TWO_PI));
+        __m128 t2 = _mm_mul_ps(t, t);
+        __m128 q = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_C11), t2), _mm_set1_ps(SIN_C9));
+        q = _mm_add_ps(_mm_mul_ps(q, t2), _mm_set1_ps(SIN_C7));
+        q = _mm_add_ps(_mm_mul_ps(q, t2), _mm_set1_ps(SIN_C5));
+        q = _mm_add_ps(_mm_mul_ps(q, t2), _mm_set1_ps(SIN_C3));
+        return _mm_add_ps(t, _mm_mul_ps(t, _mm_mul_ps(t2, q)));
+    }
+#elif defined(SYNTH_NEON64)
+    inline float32x4_t sine4(float32x4_t x)
+    {
+        float32x4_t r = vsubq_f32(x, vcvtq_f32_s32(vcvtnq_s32_f32(x)));
+        float32x4_t a = vabsq_f32(r);
+        float32x4_t f = vminq_f32(a, vsubq_f32(vdupq_n_f32(0.5f), a));
+        float32x4_t y = vbslq_f32(vdupq_n_u32(0x80000000u), r, f);
+        float32x4_t t = vmulq_f32(y, vdupq_n_f32(TWO_PI));
+        float32x4_t t2 = vmulq_f32(t, t);
+        float32x4_t q = vaddq_f32(vmulq_f32(vdupq_n_f32(SIN_C11), t2), vdupq_n_f32(SIN_C9));
+        q = vaddq_f32(vmulq_f32(q, t2), vdupq_n_f32(SIN_C7));
+        q = vaddq_f32(vmulq_f32(q, t2), vdupq_n_f32(SIN_C5));
+        q = vaddq_f32(vmulq_f32(q, t2), vdupq_n_f32(SIN_C3));
+        return vaddq_f32(t, vmulq_f32(t, vmulq_f32(t2, q)));
+    }
+#endif
+}
+
+// Operators 1..4 in the names are op[0..3]
+const uint8_t FM::MODULATORS[NUM_ALGORITHMS][OPERATORS] = {
+    {0x2, 0x4, 0x8, 0}, // 4>3>2>1
+    {0x2, 0xc, 0, 0},   // (3+4)>2>1
+    {0x6, 0, 0x8, 0},   // (2 + 4>3)>1
+    {0x6, 0x8, 0x8, 0}, // 4>(2+3)>1
+    {0x2, 0, 0x8, 0},   // 2>1, 4>3
+    {0x8, 0x8, 0x8, 0}, // 4>(1,2,3)
+    {0, 0, 0x8, 0},     // 4>3, 2, 1
+    {0, 0, 0, 0},       // 1, 2, 3, 4
+};
+const uint8_t FM::CARRIERS[NUM_ALGORITHMS] = {0x1, 0x1, 0x1, 0x1, 0x5, 0x7, 0x7, 0xf};
+const char *const FM::ALGORITHM_NAMES[NUM_ALGORITHMS] = {
+    "4>3>2>1", "(3+4)>2>1", "(2+4>3)>1", "4>(2+3)>1", "2>1 4>3", "4>(1,2,3)", "4>3 2 1", "1 2 3 4"};
+
+FM::FM() : enabled(false), algorithm(0)
+{
+    // Electric-piano-ish default: modulators fall back after a bright attack
+    for (int k = 1; k < OPERATORS; ++k)
+    {
+        op[k].level = 0.5f;
+        op[k].env = Envelope(0.005f, 0.4f, 0.25f, 0.3f);
+    }
+    op[1].ratio = 14.0f;
+    op[1].level = 0.15f;
+    op[3].feedback = 0.3f;
+}
+
+void FM::noteOn()
+{
+    // Phases restart so every note has the same attack
+    for (Operator &o : op)
+    {
+        o.env.noteOn();
+        o.phase = 0.0f;
+        o.prev[0] = o.prev[1] = 0.0f;
+    }
+}
+
+void FM::noteOff()
+{
+    for (Operator &o : op)
+        o.env.noteOff();
+}
+
+void FM::copySettings(const FM &patch)
+{
+    enabled = patch.enabled;
+    algorithm = patch.algorithm;
+    for (int k = 0; k < OPERATORS; ++k)
+    {
+        op[k].ratio = patch.op[k].ratio;
+        op[k].detune = patch.op[k].detune;
+        op[k].level = patch.op[k].level;
+        op[k].feedback = patch.op[k].feedback;
+        op[k].env.attack = patch.op[k].env.attack;
+        op[k].env.decay = patch.op[k].env.decay;
+        op[k].env.sustain = patch.op[k].env.sustain;
+        op[k].env.release = patch.op[k].env.release;
+    }
+}
+
+float FM::sine(float x)
+{
+#if defined(SYNTH_SSE2)
+    return _mm_cvtss_f32(sine4(_mm_set_ss(x))); // One lane of the block sine; libm rounding is a call
+#elif defined(SYNTH_NEON64)
+    return vgetq_lane_f32(sine4(vdupq_n_f32(x)), 0);
+#else
+    return FastMath::sin2pi<FastMath::Precision::Accurate>(x);
+#endif
+}
+
+void FM::sine(const float *x, float *out, int frames)
+{
+    int i = 0;
+#if defined(SYNTH_SSE2) || defined(SYNTH_NEON64)
+    for (; i + 4 <= frames; i += 4)
+    {
+#if defined(SYNTH_SSE2)
+        _mm_storeu_ps(out + i, sine4(_mm_loadu_ps(x + i)));
+#else
+        vst1q_f32(out + i, sine4(vld1q_f32(x + i)));
+#endif
+    }
+    if (i < frames)
+    {
+        // The tail goes through a padded vector too, so where a block ends never changes a sample
+        float in[4] = {0.0f, 0.0f, 0.0f, 0.0f}, res[4];
+        std::copy(x + i, x + frames, in);
+#if defined(SYNTH_SSE2)
+        _mm_storeu_ps(res, sine4(_mm_loadu_ps(in)));
+#else
+        vst1q_f32(res, sine4(vld1q_f32(in)));
+#endif
+        std::copy(res, res + (frames - i), out + i);
+    }
+#else
+    for (; i < frames; ++i)
+        out[i] = sine(x[i]);
+#endif
+}
+
+void FM::render(float *out, int frames, float inc, float dt, const float *pitchMul)
+{
+    const int alg = std::max(0, std::min(algorithm, NUM_ALGORITHMS - 1));
+    const uint8_t *mods = MODULATORS[alg];
+    const uint8_t heard = CARRIERS[alg];
+    uint8_t used = heard;
+    for (int k = 0; k < OPERATORS; ++k)
+        used |= mods[k];
+    const float norm = 1.0f / (float)(((heard >> 0) & 1) + ((heard >> 1) & 1) + ((heard >> 2) & 1) + ((heard >> 3) & 1));
+
+    while (frames > 0)
+    {
+        const int n = std::min(frames, BLOCK);
+        float opOut[OPERATORS][BLOCK];
+        for (int k = OPERATORS - 1; k >= 0; --k)
+        {
+            if (!(used & (1 << k)))
+                continue; // Not in this algorithm: left as it is
+            Operator &o = op[k];
+            float gain[BLOCK], arg[BLOCK];
+            o.env.processBlock(gain, n, dt);
+            for (int i = 0; i < n; ++i)
+                gain[i] *= o.level;
+
+            // Phase ramp plus everything modulating this operator
+            const float opInc = inc * o.ratio * (o.detune != 0.0f ? std::exp2(o.detune / 1200.0f) : 1.0f);
+            float p = o.phase;
+            for (int i = 0; i < n; ++i)
+            {
+                p += pitchMul ? opInc * pitchMul[i] : opInc;
+                if (p >= 1.0f)
+                    p -= (float)(int)p;
+                arg[i] = p;
+            }
+            o.phase = p;
+            for (int m = k + 1; m < OPERATORS; ++m)
+            {
+                if (!(mods[k] & (1 << m)))
+                    continue;
+                for (int i = 0; i < n; ++i)
+                    arg[i] += opOut[m][i] * MOD_INDEX;
+            }
+
+            float *y = opOut[k];
+            if (o.feedback > 0.0f)
+            {
+                // Each sample depends on the last two, so this one stays scalar
+                const float fb = o.feedback * 0.25f; // Half a cycle at full feedback, on the two-sample average
+                float p0 = o.prev[0], p1 = o.prev[1];
+                for (int i = 0; i < n; ++i)
+                {
+                    float s = sine(arg[i] + fb * (p0 + p1)) * gain[i];
+                    p1 = p0;
+                    p0 = s;
+                    y[i] = s;
+                }
+                o.prev[0] = p0;
+                o.prev[1] = p1;
+            }
+            else
+            {
+                sine(arg, y, n);
+                for (int i = 0; i < n; ++i)
+                    y[i] *= gain[i];
+                o.prev[0] = y[n - 1];
+                o.prev[1] = n > 1 ? y[n - 2] : o.prev[0];
+            }
+        }
+
+        std::fill(out, out + n, 0.0f);
+        for (int k = 0; k < OPERATORS; ++k)
+        {
+            if (!(heard & (1 << k)))
+                continue;
+            for (int i = 0; i < n; ++i)
+                out[i] += opOut[k][i];
+        }
+        for (int i = 0; i < n; ++i)
+            out[i] *= norm;
+
+        out += n;
+        if (pitchMul)
+            pitchMul += n;
+        frames -= n;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include "Envelope.hpp"
+
+// Four-operator FM oscillator. Each operator is a sine with its own frequency
+// ratio, level, envelope and self-feedback; the algorithm decides which
+// operators modulate which and which ones are heard. Operators are rendered a
+// block at a time, modulators first, with the block sine below instead of
+// std::sin per sample. Phases are normalised 0..1.
+class FM
+{
+public:
+    static constexpr int OPERATORS = 4;
+    static constexpr int NUM_ALGORITHMS = 8;
+    static constexpr float MOD_INDEX = 1.0f; // Phase offset in cycles from a modulator at full level
+
+    // Per algorithm and operator: bit m set if operator m modulates it. A
+    // modulator always has a higher index than what it modulates, so
+    // rendering from operator 3 down to 0 has every input ready.
+    static const uint8_t MODULATORS[NUM_ALGORITHMS][OPERATORS];
+    static const uint8_t CARRIERS[NUM_ALGORITHMS]; // Bit per operator that reaches the output
+    static const char *const ALGORITHM_NAMES[NUM_ALGORITHMS];
+
+    struct Operator
+    {
+        float ratio = 1.0f;    // Times the note frequency
+        float detune = 0.0f;   // Cents
+        float level = 1.0f;    // 0..1; for a modulator, its index relative to MOD_INDEX
+        float feedback = 0.0f; // 0..1 self-modulation
+        Envelope env;
+        float phase = 0.0f;
+        float prev[2] = {0.0f, 0.0f}; // Last two outputs, averaged for feedback
+    };
+
+    bool enabled; // Replaces the synth's oscillator when set
+    int algorithm;
+    Operator op[OPERATORS];
+
+    FM();
+    void noteOn();
+    void noteOff();
+    // Patch settings only, so a sounding voice can follow its patch without a restart
+    void copySettings(const FM &patch);
+    // inc: note phase increment per frame (cycles); pitchMul: optional per-frame multiplier.
+    // Carriers are summed and scaled by one over their count.
+    void render(float *out, int frames, float inc, float dt, const float *pitchMul);
+
+    // sin(2 pi x) for any x, 4 lanes at a time where SIMD is available.
+    // FastMath::sin2pi<Accurate> in vector form, with the same error bound.
+    static void sine(const float *cycles, float *out, int frames);
+    static float sine(float cycles);
+};
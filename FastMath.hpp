@@ -0,0 +1,186 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Polynomial stand-ins for libm on the per-sample paths. Every function takes
+// a precision tier, and the error bounds per tier are the tables below. They
+// are measured against double-precision libm over the stated domains, and
+// --golden re-checks them. Fast is for modulation and display. Balanced is for
+// anything heard through a filter or envelope. Accurate is for output heard
+// directly.
+namespace FastMath
+{
+    enum class Precision
+    {
+        Fast,
+        Balanced,
+        Accurate
+    };
+
+    // Indexed by Precision
+    constexpr double EXP2_REL_ERROR[3] = {2.1e-3, 3.0e-6, 1.0e-7};   // x in [-126, 127]; clamped outside
+    constexpr double LOG2_ABS_ERROR[3] = {7.8e-4, 3.0e-6, 1.1e-6};   // x in [2^-20, 2^20]; Accurate is result rounding
+    constexpr double SIN_ABS_ERROR[3] = {1.1e-3, 3.7e-6, 1.6e-7};    // |x| <= 64 cycles
+    constexpr double TANH_ABS_ERROR[3] = {2.4e-2, 1.5e-6, 1.4e-7};   // Any x
+    constexpr double DB_GAIN_REL_ERROR[3] = {2.1e-3, 3.7e-6, 8.0e-7}; // -120..20 dB; gainToDb is 6.02 x the log2 bound
+
+    constexpr float LOG2E = 1.44269504088896341f;
+    constexpr float DB_TO_LOG2 = 0.166096404744368118f; // log2(10) / 20
+    constexpr float LOG2_TO_DB = 6.02059991327962390f;  // 20 / log2(10)
+
+    // Taylor coefficients of sin(t) on [-pi/2, pi/2]; shared with the SIMD block sines
+    constexpr float SIN_C3 = -1.0f / 6.0f;
+    constexpr float SIN_C5 = 1.0f / 120.0f;
+    constexpr float SIN_C7 = -1.0f / 5040.0f;
+    constexpr float SIN_C9 = 1.0f / 362880.0f;
+    constexpr float SIN_C11 = -1.0f / 39916800.0f;
+    constexpr float TWO_PI = 6.28318530717958647692f;
+
+    // floor for |x| < 2^31, without a libm call; stays vectorisable
+    inline float floor(float x)
+    {
+        float t = (float)(int)x;
+        return t - (x < t ? 1.0f : 0.0f);
+    }
+
+    template <Precision P = Precision::Balanced>
+    inline float exp2(float x)
+    {
+        x = x < -126.0f ? -126.0f : (x > 127.0f ? 127.0f : x);
+        float i = floor(x);
+        float f = x - i;
+        // 1 + f * q(f), minimax on relative error over [0, 1); exact at f = 0
+        float q;
+        if constexpr (P == Precision::Fast)
+            q = 6.659609409e-01f + f * 3.299324045e-01f;
+        else if constexpr (P == Precision::Balanced)
+            q = 6.930448449e-01f + f * (2.412802048e-01f + f * (5.224247419e-02f + f * 1.342668429e-02f));
+        else
+            q = 6.931470444e-01f +
+                f * (2.402293056e-01f +
+                     f * (5.548528062e-02f + f * (9.675451567e-03f + f * (1.246784644e-03f + f * 2.161291496e-04f))));
+        uint32_t bits = (uint32_t)((int)i + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return scale * (1.0f + f * q);
+    }
+
+    template <Precision P = Precision::Balanced>
+    inline float log2(float x)
+    {
+        if (!(x > 1.17549435e-38f)) // Zero, negative, denormal or NaN
+            return -127.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        float e = (float)((int)(bits >> 23) - 127);
+        bits = (bits & 0x007fffffu) | 0x3f800000u;
+        float m;
+        std::memcpy(&m, &bits, sizeof(m)); // 1..2
+        if constexpr (P == Precision::Fast)
+        {
+            // m - 1 times a minimax q; no division
+            float f = m - 1.0f;
+            return e + f * (1.424593877e+00f + f * (-5.892067124e-01f + f * 1.653837865e-01f));
+        }
+        else
+        {
+            // Centre the mantissa on 1, then the atanh series in z = (m - 1) / (m + 1)
+            if (m > 1.41421356f)
+            {
+                m *= 0.5f;
+                e += 1.0f;
+            }
+            float z = (m - 1.0f) / (m + 1.0f);
+            float z2 = z * z;
+            const float k = 2.0f * LOG2E;
+            float s;
+            if constexpr (P == Precision::Balanced)
+                s = 1.0f + z2 * (1.0f / 3.0f + z2 * (1.0f / 5.0f));
+            else
+                s = 1.0f + z2 * (1.0f / 3.0f + z2 * (1.0f / 5.0f + z2 * (1.0f / 7.0f + z2 * (1.0f / 9.0f))));
+            return e + k * z * s;
+        }
+    }
+
+    // Fast-tier sin(2 pi r) for r in -0.5..0.5: a parabola with one refinement step
+    inline float sinParabola(float r)
+    {
+        float u = 2.0f * r;
+        float y = 4.0f * u * (1.0f - std::fabs(u));
+        return 0.225f * (y * std::fabs(y) - y) + y;
+    }
+
+    // sin2pi<Fast> for x >= 0, reduced by truncation: no compare-and-select,
+    // so loops over unison lanes or LFO blocks vectorise
+    inline float sin2piPositive(float x)
+    {
+        return sinParabola(x - (float)(int)(x + 0.5f));
+    }
+
+    // sin(2 pi x): the argument in cycles, as the oscillators keep their phase
+    template <Precision P = Precision::Balanced>
+    inline float sin2pi(float x)
+    {
+        float r = x - floor(x + 0.5f); // -0.5..0.5
+        if constexpr (P == Precision::Fast)
+            return sinParabola(r);
+        else
+        {
+            // Fold to -0.25..0.25 so the series only covers a quarter turn
+            float a = r < 0.0f ? -r : r;
+            float f = a < 0.5f - a ? a : 0.5f - a;
+            float t = (r < 0.0f ? -f : f) * TWO_PI;
+            float t2 = t * t;
+            float q;
+            if constexpr (P == Precision::Balanced)
+                q = ((SIN_C9 * t2 + SIN_C7) * t2 + SIN_C5) * t2 + SIN_C3;
+            else
+                q = (((SIN_C11 * t2 + SIN_C9) * t2 + SIN_C7) * t2 + SIN_C5) * t2 + SIN_C3;
+            return t + t * (t2 * q);
+        }
+    }
+
+    // sin2piPositive on a non-negative phase in radians
+    inline float sinPositive(float radians)
+    {
+        return sin2piPositive(radians * (1.0f / TWO_PI));
+    }
+
+    template <Precision P = Precision::Balanced>
+    inline float sin(float radians)
+    {
+        return sin2pi<P>(radians * (1.0f / TWO_PI));
+    }
+
+    template <Precision P = Precision::Balanced>
+    inline float tanh(float x)
+    {
+        if constexpr (P == Precision::Fast)
+        {
+            // Pade approximant, clamped where it reaches 1
+            x = x < -3.0f ? -3.0f : (x > 3.0f ? 3.0f : x);
+            float x2 = x * x;
+            return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+        }
+        else
+        {
+            // Past 9 tanh is 1 to float precision
+            x = x < -9.0f ? -9.0f : (x > 9.0f ? 9.0f : x);
+            float e = exp2<P>(2.0f * LOG2E * x);
+            return (e - 1.0f) / (e + 1.0f);
+        }
+    }
+
+    template <Precision P = Precision::Balanced>
+    inline float dbToGain(float db)
+    {
+        return exp2<P>(db * DB_TO_LOG2);
+    }
+
+    template <Precision P = Precision::Balanced>
+    inline float gainToDb(float gain)
+    {
+        return log2<P>(gain) * LOG2_TO_DB;
+    }
+}
@@ -2,10 +2,17 @@
 #include <cmath>
 
 Filter::Filter(float cutoff, float resonance)
-    : cutoff(cutoff), resonance(resonance), prevSample(0.0f) {}
+    : cutoff(cutoff), resonance(resonance), drive(0.0f), prevSample(0.0f), prevSampleRight(0.0f),
+      curveDrive(0.0f), curveK(1.0f), curveNorm(1.0f) {}
 
 float Filter::process(float input)
 {
+    if (drive > 0.0f)
+    {
+        float k, norm;
+        driveCurve(k, norm);
+        input = saturate(input, k, norm);
+    }
     // Basit bir low-pass filter
     float alpha = cutoff / (cutoff + 1.0f);
     float output = alpha * input + (1.0f - alpha) * prevSample;
@@ -16,4 +23,16 @@ float Filter::process(float input)
 void Filter::setCutoff(float freq)
 {
     cutoff = freq;
-}
\ No newline at end of file
+}
+
+void Filter::driveCurve(float &k, float &norm)
+{
+    if (drive != curveDrive)
+    {
+        curveDrive = drive;
+        curveK = 1.0f + 9.0f * drive;
+        curveNorm = 1.0f / FastMath::tanh<FastMath::Precision::Balanced>(curveK);
+    }
+    k = curveK;
+    norm = curveNorm;
+}
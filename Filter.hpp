@@ -1,13 +1,27 @@
 #pragma once
+#include "FastMath.hpp"
 
 class Filter
 {
 public:
     float cutoff;
     float resonance;
+    float drive; // 0..1 tanh soft clip ahead of the filter; 0 bypasses it exactly
     float prevSample;
+    float prevSampleRight; // Right channel state when the voice renders in stereo
 
     Filter(float cutoff = 1000.0f, float resonance = 0.1f);
     float process(float input);
     void setCutoff(float freq);
-};
\ No newline at end of file
+
+    // tanh(k x) / tanh(k) with k = 1 + 9 drive, so full scale stays full scale at any drive.
+    // Recomputed only when drive has changed since the last call.
+    void driveCurve(float &k, float &norm);
+    static float saturate(float x, float k, float norm)
+    {
+        return FastMath::tanh<FastMath::Precision::Balanced>(k * x) * norm;
+    }
+
+private:
+    float curveDrive, curveK, curveNorm; // driveCurve() for curveDrive
+};
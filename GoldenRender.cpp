@@ -0,0 +1,787 @@
+#include "GoldenRender.hpp"
+#include "Synth.hpp"
+#include "Engine.hpp"
+#include "FastMath.hpp"
+#include "Limiter.hpp"
+#include "Resampler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const char *waveNames[4] = {"SINE", "SQUARE", "TRIANGLE", "SAW"};
+    const char *targetNames[4] = {"OFF", "PITCH", "AMP", "FILTER"};
+
+    struct Scenario
+    {
+        WaveForm::Type wave;
+        LFOTarget target;
+        WaveForm::Type lfoWave;
+        float frequency;
+    };
+
+    // Nanoseconds per frame for `frames` frames rendered by `render`
+    template <typename Fn>
+    double timePerFrame(int frames, Fn render)
+    {
+        auto start = std::chrono::steady_clock::now();
+        render();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / frames;
+    }
+
+    void setup(Synth &synth, const Scenario &s)
+    {
+        synth.waveType = s.wave;
+        synth.lfo.target = s.target;
+        synth.lfo.waveform = s.lfoWave;
+        synth.lfo.enabled = s.target != LFOTarget::None;
+        synth.lfo.rate = 5.0f;
+        synth.lfo.depth = 0.6f;
+        synth.setFrequency(s.frequency);
+        synth.noteOn();
+    }
+
+    // Note on at 0, note off after `gate` frames; `render(out, frames)` produces the next run
+    template <typename Fn>
+    std::vector<float> renderGated(int frames, int gate, Synth &synth, Fn render)
+    {
+        std::vector<float> out(frames);
+        render(out.data(), gate);
+        synth.noteOff();
+        render(out.data() + gate, frames - gate);
+        return out;
+    }
+
+    struct Comparison
+    {
+        bool exact;
+        double snrDb; // Infinity when exact
+        double maxError;
+    };
+
+    Comparison compare(const std::vector<float> &reference, const std::vector<float> &test)
+    {
+        double signal = 0.0, noise = 0.0, maxError = 0.0;
+        bool exact = reference.size() == test.size();
+        size_t n = std::min(reference.size(), test.size());
+        for (size_t i = 0; i < n; ++i)
+        {
+            double e = (double)test[i] - reference[i];
+            signal += (double)reference[i] * reference[i];
+            noise += e * e;
+            maxError = std::max(maxError, std::fabs(e));
+            exact = exact && test[i] == reference[i];
+        }
+        double snr = noise > 0.0 ? 10.0 * std::log10(signal / noise) : std::numeric_limits<double>::infinity();
+        return {exact, snr, maxError};
+    }
+
+    class Report
+    {
+    public:
+        Report() : failures(0), checks(0) {}
+
+        void header(const char *title)
+        {
+            std::cout << "== " << title << "\n";
+            std::cout << std::left << std::setw(26) << "scenario" << std::setw(14) << "path" << std::right
+                      << std::setw(10) << "expect" << std::setw(12) << "SNR dB" << std::setw(12) << "max err"
+                      << std::setw(10) << "ref ns" << std::setw(10) << "path ns" << "\n";
+        }
+
+        // minSnrDb < 0: the path must reproduce the reference sample for sample
+        void row(const std::string &scenario, const char *path, double minSnrDb, const Comparison &c, double refNs, double pathNs)
+        {
+            bool bitExact = minSnrDb < 0.0;
+            bool pass = bitExact ? c.exact : c.snrDb >= minSnrDb;
+            ++checks;
+            if (!pass)
+                ++failures;
+            std::cout << std::left << std::setw(26) << scenario << std::setw(14) << path << std::right
+                      << std::setw(10) << (bitExact ? std::string("exact") : ">" + std::to_string((int)minSnrDb))
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(12) << c.snrDb << std::scientific << std::setprecision(2)
+                      << std::setw(12) << c.maxError << std::fixed << std::setprecision(2)
+                      << std::setw(10) << refNs << std::setw(10) << pathNs
+                      << (pass ? "" : "  FAIL") << "\n";
+        }
+
+        // Error against a documented bound rather than an SNR; the SNR column is left blank
+        void bound(const std::string &scenario, const char *path, double limit, double maxError, double refNs, double pathNs)
+        {
+            bool pass = maxError <= limit;
+            ++checks;
+            if (!pass)
+                ++failures;
+            std::ostringstream expect;
+            expect << "<" << std::scientific << std::setprecision(1) << limit;
+            std::cout << std::left << std::setw(26) << scenario << std::setw(14) << path << std::right
+                      << std::setw(10) << expect.str() << std::setw(12) << "-"
+                      << std::scientific << std::setprecision(2) << std::setw(12) << maxError
+                      << std::fixed << std::setprecision(2) << std::setw(10) << refNs << std::setw(10) << pathNs
+                      << (pass ? "" : "  FAIL") << "\n";
+        }
+
+        int finish()
+        {
+            std::cout << checks - failures << "/" << checks << " passed\n";
+            return failures ? 1 : 0;
+        }
+
+    private:
+        int failures;
+        int checks;
+    };
+
+    const double EXACT = -1.0;
+
+    void goldenSynth(int sampleRate, Report &report, double minSnrDb, double edgeSnrDb)
+    {
+        const int frames = sampleRate * 3 / 2;
+        const int gate = sampleRate;
+        const float dt = 1.0f / sampleRate;
+
+        report.header("Synth: Synth::process reference vs block kernels");
+        for (int w = 0; w < 4; ++w)
+        {
+            for (int t = 0; t < 4; ++t)
+            {
+                Scenario s{(WaveForm::Type)w, (LFOTarget)t, (WaveForm::Type)((w + t) % 4), 110.0f * (1 + t)};
+                std::string name = std::string(waveNames[w]) + "/" + targetNames[t] + "/" + waveNames[s.lfoWave];
+                bool edges = s.wave == WaveForm::Square || s.wave == WaveForm::Saw;
+
+                std::vector<float> reference;
+                double refNs = timePerFrame(frames, [&]
+                                            {
+                    Synth synth;
+                    setup(synth, s);
+                    reference = renderGated(frames, gate, synth, [&](float *out, int n)
+                                            { for (int i = 0; i < n; ++i) out[i] = synth.process(dt); }); });
+
+                std::vector<float> block;
+                double blockNs = timePerFrame(frames, [&]
+                                              {
+                    Synth synth;
+                    setup(synth, s);
+                    block = renderGated(frames, gate, synth, [&](float *out, int n)
+                                        { synth.processBlock(out, n, dt); }); });
+                report.row(name, "kernel", edges ? edgeSnrDb : minSnrDb, compare(reference, block), refNs, blockNs);
+
+                // Double output is the same computation, widened at the store
+                std::vector<float> widened;
+                double doubleNs = timePerFrame(frames, [&]
+                                               {
+                    Synth synth;
+                    setup(synth, s);
+                    std::vector<double> wide(Synth::MAX_BLOCK);
+                    widened = renderGated(frames, gate, synth, [&](float *out, int n)
+                                          {
+                        for (int done = 0; done < n; done += Synth::MAX_BLOCK)
+                        {
+                            int m = std::min(Synth::MAX_BLOCK, n - done);
+                            synth.processBlock(wide.data(), m, dt);
+                            std::copy(wide.begin(), wide.begin() + m, out + done);
+                        } }); });
+                report.row(name, "kernel<double>", EXACT, compare(block, widened), blockNs, doubleNs);
+
+                // Irregular block sizes must not change a sample
+                std::vector<float> ragged;
+                double raggedNs = timePerFrame(frames, [&]
+                                               {
+                    Synth synth;
+                    setup(synth, s);
+                    unsigned int seed = 12345;
+                    ragged = renderGated(frames, gate, synth, [&](float *out, int n)
+                                         {
+                        for (int done = 0; done < n;)
+                        {
+                            seed = seed * 1664525u + 1013904223u;
+                            int m = std::min(1 + (int)(seed >> 16) % 400, n - done);
+                            synth.processBlock(out + done, m, dt);
+                            done += m;
+                        } }); });
+                report.row(name, "ragged blocks", EXACT, compare(block, ragged), blockNs, raggedNs);
+
+                // A centred voice rendered in stereo is the mono block on both sides
+                std::vector<float> stereo;
+                double stereoNs = timePerFrame(frames, [&]
+                                               {
+                    Synth synth;
+                    setup(synth, s);
+                    std::vector<float> right(frames);
+                    float *r = right.data();
+                    stereo = renderGated(frames, gate, synth, [&](float *out, int n)
+                                         {
+                        for (int done = 0; done < n; done += Synth::MAX_BLOCK)
+                            synth.processBlock(out + done, r + done, std::min(Synth::MAX_BLOCK, n - done), dt);
+                        r += n; });
+                    stereo.insert(stereo.end(), right.begin(), right.end()); });
+                std::vector<float> twice(block);
+                twice.insert(twice.end(), block.begin(), block.end());
+                report.row(name, "stereo centre", EXACT, compare(twice, stereo), blockNs, stereoNs);
+            }
+        }
+
+        // Filter drive and the decibel envelope curve, on both paths
+        Scenario driven{WaveForm::Saw, LFOTarget::Pitch, WaveForm::Sine, 110.0f};
+        auto drive = [&](Synth &synth)
+        {
+            synth.filter.drive = 0.7f;
+            synth.env.rangeDb = 48.0f;
+            setup(synth, driven);
+        };
+        std::vector<float> reference, block;
+        double refNs = timePerFrame(frames, [&]
+                                    {
+            Synth synth;
+            drive(synth);
+            reference = renderGated(frames, gate, synth, [&](float *out, int n)
+                                    { for (int i = 0; i < n; ++i) out[i] = synth.process(dt); }); });
+        double blockNs = timePerFrame(frames, [&]
+                                      {
+            Synth synth;
+            drive(synth);
+            block = renderGated(frames, gate, synth, [&](float *out, int n)
+                                { synth.processBlock(out, n, dt); }); });
+        report.row("SAW/PITCH driven, dB env", "kernel", edgeSnrDb, compare(reference, block), refNs, blockNs);
+        std::cout << "\n";
+    }
+
+    // Worst error of fast(x) against the double-precision libm ref(x) over n points of [lo, hi]
+    template <typename Fast, typename Ref>
+    void goldenMath(Report &report, const char *name, const char *tier, double lo, double hi, bool relative,
+                    double limit, Fast fast, Ref ref)
+    {
+        const int n = 1 << 18;
+        std::vector<float> x(n), y(n);
+        std::vector<double> expected(n);
+        for (int i = 0; i < n; ++i)
+            x[i] = (float)(lo + (hi - lo) * i / (n - 1));
+        double refNs = timePerFrame(n, [&]
+                                    { for (int i = 0; i < n; ++i) expected[i] = ref((double)x[i]); });
+        double fastNs = timePerFrame(n, [&]
+                                     { for (int i = 0; i < n; ++i) y[i] = fast(x[i]); });
+        double worst = 0.0;
+        for (int i = 0; i < n; ++i)
+        {
+            double e = std::fabs(y[i] - expected[i]);
+            worst = std::max(worst, relative ? e / std::fabs(expected[i]) : e);
+        }
+        report.bound(name, tier, limit, worst, refNs, fastNs);
+    }
+
+    template <FastMath::Precision P>
+    void goldenMathTier(Report &report, const char *tier)
+    {
+        const int t = (int)P;
+        goldenMath(report, "exp2 -126..127", tier, -126.0, 127.0, true, FastMath::EXP2_REL_ERROR[t],
+                   [](float x) { return FastMath::exp2<P>(x); }, [](double x) { return std::exp2(x); });
+        goldenMath(report, "log2 2^-20..2^20", tier, std::ldexp(1.0, -20), std::ldexp(1.0, 20), false,
+                   FastMath::LOG2_ABS_ERROR[t], [](float x) { return FastMath::log2<P>(x); },
+                   [](double x) { return std::log2(x); });
+        goldenMath(report, "log2 0.5..2", tier, 0.5, 2.0, false, FastMath::LOG2_ABS_ERROR[t],
+                   [](float x) { return FastMath::log2<P>(x); }, [](double x) { return std::log2(x); });
+        goldenMath(report, "sin2pi -64..64 cycles", tier, -64.0, 64.0, false, FastMath::SIN_ABS_ERROR[t],
+                   [](float x) { return FastMath::sin2pi<P>(x); }, [](double x) { return std::sin(2.0 * M_PI * x); });
+        goldenMath(report, "tanh -12..12", tier, -12.0, 12.0, false, FastMath::TANH_ABS_ERROR[t],
+                   [](float x) { return FastMath::tanh<P>(x); }, [](double x) { return std::tanh(x); });
+        goldenMath(report, "dbToGain -120..20", tier, -120.0, 20.0, true, FastMath::DB_GAIN_REL_ERROR[t],
+                   [](float x) { return FastMath::dbToGain<P>(x); }, [](double x) { return std::pow(10.0, x / 20.0); });
+    }
+
+    void goldenFastMath(Report &report)
+    {
+        report.header("FastMath: error bound per tier vs double-precision libm");
+        goldenMathTier<FastMath::Precision::Fast>(report, "fast");
+        goldenMathTier<FastMath::Precision::Balanced>(report, "balanced");
+        goldenMathTier<FastMath::Precision::Accurate>(report, "accurate");
+        std::cout << "\n";
+    }
+
+    // One operator at a time, one sample at a time, double-precision std::sin
+    std::vector<float> referenceFM(const FM &patch, float inc, float dt, int frames, int gate)
+    {
+        FM fm = patch;
+        fm.noteOn();
+        const uint8_t *mods = FM::MODULATORS[fm.algorithm];
+        const uint8_t heard = FM::CARRIERS[fm.algorithm];
+        int carriers = 0;
+        for (int k = 0; k < FM::OPERATORS; ++k)
+            carriers += (heard >> k) & 1;
+        std::vector<float> out(frames);
+        float y[FM::OPERATORS] = {};
+        for (int i = 0; i < frames; ++i)
+        {
+            if (i == gate)
+                fm.noteOff();
+            for (int k = FM::OPERATORS - 1; k >= 0; --k)
+            {
+                FM::Operator &o = fm.op[k];
+                float gain = o.env.process(dt) * o.level;
+                o.phase += inc * o.ratio;
+                if (o.phase >= 1.0f)
+                    o.phase -= (float)(int)o.phase;
+                float arg = o.phase;
+                for (int m = k + 1; m < FM::OPERATORS; ++m)
+                {
+                    if (mods[k] & (1 << m))
+                        arg += y[m] * FM::MOD_INDEX;
+                }
+                arg += o.feedback * 0.25f * (o.prev[0] + o.prev[1]);
+                y[k] = (float)std::sin(2.0 * M_PI * arg) * gain;
+                o.prev[1] = o.prev[0];
+                o.prev[0] = y[k];
+            }
+            float sum = 0.0f;
+            for (int k = 0; k < FM::OPERATORS; ++k)
+            {
+                if (heard & (1 << k))
+                    sum += y[k];
+            }
+            out[i] = sum / carriers;
+        }
+        return out;
+    }
+
+    // FM::render in callbacks of `callback` frames, each split into blocks of up to MAX_BLOCK
+    std::vector<float> renderFM(const FM &patch, float inc, float dt, int frames, int gate, int callback)
+    {
+        FM fm = patch;
+        fm.noteOn();
+        std::vector<float> out(frames);
+        for (int done = 0; done < frames;)
+        {
+            int n = std::min({callback, frames - done, done < gate ? gate - done : frames});
+            if (done == gate)
+                fm.noteOff();
+            fm.render(out.data() + done, n, inc, dt, nullptr);
+            done += n;
+        }
+        return out;
+    }
+
+    void goldenFM(int sampleRate, Report &report, double minSnrDb)
+    {
+        const int frames = sampleRate;
+        const int gate = sampleRate / 2;
+        const float dt = 1.0f / sampleRate;
+        const float inc = 220.0f * dt;
+
+        report.header("FM: double-precision std::sin reference vs block sine");
+        std::vector<float> x(1 << 20), reference(x.size()), block(x.size());
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = -8.0f + 16.0f * i / x.size();
+        double refNs = timePerFrame((int)x.size(), [&]
+                                    { for (size_t i = 0; i < x.size(); ++i) reference[i] = (float)std::sin(2.0 * M_PI * x[i]); });
+        double sineNs = timePerFrame((int)x.size(), [&]
+                                     { FM::sine(x.data(), block.data(), (int)x.size()); });
+        report.row("sine -8..8 cycles", "FM::sine", minSnrDb, compare(reference, block), refNs, sineNs);
+
+        for (int a = 0; a < FM::NUM_ALGORITHMS; ++a)
+        {
+            FM patch;
+            patch.enabled = true;
+            patch.algorithm = a;
+            std::vector<float> ref, blocked, ragged;
+            double fmRefNs = timePerFrame(frames, [&]
+                                          { ref = referenceFM(patch, inc, dt, frames, gate); });
+            double blockNs = timePerFrame(frames, [&]
+                                          { blocked = renderFM(patch, inc, dt, frames, gate, Synth::MAX_BLOCK); });
+            double raggedNs = timePerFrame(frames, [&]
+                                           { ragged = renderFM(patch, inc, dt, frames, gate, 37); });
+            std::string name = std::string("alg ") + FM::ALGORITHM_NAMES[a];
+            report.row(name, "block", minSnrDb, compare(ref, blocked), fmRefNs, blockNs);
+            report.row(name, "ragged blocks", EXACT, compare(blocked, ragged), blockNs, raggedNs);
+        }
+        std::cout << "\n";
+    }
+
+    // Events applied one sample at a time through Synth::process, as the reference for Engine::render.
+    // Part 0 is mono: a note takes a fresh copy of the patch once the last one has died away.
+    std::vector<float> referenceTimeline(int sampleRate, const std::vector<Event> &events, int frames,
+                                         const Tuning &tuning = Tuning::standard())
+    {
+        std::unique_ptr<Engine> engine(new Engine());
+        engine->prepare((float)sampleRate);
+        const float dt = 1.0f / sampleRate;
+        std::vector<float> out(frames);
+        Synth voice;
+        bool sounding = false;
+        int note = -1;
+        float bend = 0.0f;
+        auto tune = [&]
+        { voice.setFrequency(tuning.frequency(note) * std::exp2(bend * 2.0f / 12.0f)); };
+        size_t cursor = 0;
+        for (int i = 0; i < frames; ++i)
+        {
+            while (cursor < events.size() && events[cursor].time <= (uint64_t)i)
+            {
+                const Event &e = events[cursor++];
+                if (e.type == EventType::NoteOn)
+                {
+                    if (!sounding)
+                        voice = engine->synth;
+                    sounding = true;
+                    note = e.note;
+                    tune();
+                    voice.noteOn();
+                }
+                else if (e.type == EventType::NoteOff && sounding && e.note == note)
+                    voice.noteOff();
+                else if (e.type == EventType::PitchBend)
+                {
+                    bend = e.value;
+                    if (sounding)
+                        tune();
+                }
+            }
+            out[i] = sounding ? voice.process(dt) : 0.0f;
+            if (sounding && Part::finished(voice))
+                sounding = false;
+        }
+        return out;
+    }
+
+    std::vector<float> engineTimeline(int sampleRate, const std::vector<Event> &events, int frames, int callback,
+                                      bool arp = false, const Tuning *tuning = nullptr)
+    {
+        std::unique_ptr<Engine> engine(new Engine());
+        engine->prepare((float)sampleRate);
+        if (tuning)
+            engine->publishTuning(new Tuning(*tuning));
+        engine->arp.enabled = arp;
+        engine->arp.octaves = 2;
+        engine->setTimeline(&events);
+        std::vector<float> out(frames), right(frames);
+        for (int done = 0; done < frames; done += callback)
+            engine->render(out.data() + done, right.data() + done, std::min(callback, frames - done));
+        return out;
+    }
+
+    // Bass, pad chords and lead on three parts; workers > 0 renders them in parallel
+    std::vector<float> partsTimeline(int sampleRate, const std::vector<Event> &events, int frames, int callback, int workers)
+    {
+        std::unique_ptr<Engine> engine(new Engine());
+        engine->prepare((float)sampleRate);
+        engine->parts[1].patch.waveType = WaveForm::Saw;
+        engine->parts[1].patch.pan = -0.5f;
+        engine->parts[2].patch.waveType = WaveForm::Triangle;
+        engine->parts[2].patch.unison.voices = 3;
+        engine->parts[2].patch.unison.configure();
+        engine->parts[2].patch.pan = 0.5f;
+        engine->setTimeline(&events);
+        engine->startWorkers(workers);
+        std::vector<float> out(frames * 2), right(frames);
+        for (int done = 0; done < frames; done += callback)
+            engine->render(out.data() + done, right.data() + done, std::min(callback, frames - done));
+        engine->stopWorkers();
+        std::copy(right.begin(), right.end(), out.begin() + frames);
+        return out;
+    }
+
+    void goldenEngine(int sampleRate, Report &report, double minSnrDb)
+    {
+        const int frames = sampleRate * 2;
+        std::vector<Event> events;
+        unsigned int seed = 777;
+        for (int i = 0; i < 24; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            uint64_t t = (uint64_t)i * sampleRate / 14 + (seed >> 20) % 97; // Off the block grid
+            uint8_t note = (uint8_t)(45 + (seed >> 8) % 24);
+            events.push_back({t, EventType::NoteOn, 0, note, 100, 0.0f});
+            events.push_back({t + sampleRate / 20, EventType::PitchBend, 0, 0, 0, ((int)(seed % 9) - 4) / 4.0f});
+            events.push_back({t + sampleRate / 16, EventType::NoteOff, 0, note, 0, 0.0f});
+        }
+        std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b)
+                         { return a.time < b.time; });
+
+        report.header("Engine: per-sample event reference vs split-block render");
+        std::vector<float> reference, blocked, odd;
+        double refNs = timePerFrame(frames, [&]
+                                    { reference = referenceTimeline(sampleRate, events, frames); });
+        double blockNs = timePerFrame(frames, [&]
+                                      { blocked = engineTimeline(sampleRate, events, frames, Synth::MAX_BLOCK); });
+        double oddNs = timePerFrame(frames, [&]
+                                    { odd = engineTimeline(sampleRate, events, frames, 300); });
+        report.row("timeline", "render 256", minSnrDb, compare(reference, blocked), refNs, blockNs);
+        report.row("timeline", "render 300", EXACT, compare(blocked, odd), blockNs, oddNs);
+
+        // A Scala file spelling out 12-TET gives the built-in table, and a
+        // microtuned timeline renders on the pitches of its table
+        Tuning scala, edo19;
+        std::string error;
+        std::string scl12 = "! 12-TET in cents\n12-TET\n 12\n!\n", scl19 = "19-EDO\n19\n";
+        for (int k = 1; k <= 12; ++k)
+            scl12 += std::to_string(k * 100) + ".0\n";
+        for (int k = 1; k <= 19; ++k)
+            scl19 += std::to_string(1200.0 * k / 19) + "\n";
+        std::vector<float> standardHz(Tuning::NOTES), scalaHz(Tuning::NOTES);
+        if (!scala.parse(scl12, "", error) || !edo19.parse(scl19, "", error))
+            std::cout << "Scala parse failed: " << error << "\n";
+        for (int n = 0; n < Tuning::NOTES; ++n)
+        {
+            standardHz[n] = Tuning::standard().frequency(n);
+            scalaHz[n] = scala.frequency(n);
+        }
+        report.row("12-TET .scl", "table", 120.0, compare(standardHz, scalaHz), 0.0, 0.0);
+        std::vector<float> edoReference, edoBlocked;
+        double edoRefNs = timePerFrame(frames, [&]
+                                       { edoReference = referenceTimeline(sampleRate, events, frames, edo19); });
+        double edoNs = timePerFrame(frames, [&]
+                                    { edoBlocked = engineTimeline(sampleRate, events, frames, Synth::MAX_BLOCK, false, &edo19); });
+        report.row("19-EDO timeline", "render 256", minSnrDb, compare(edoReference, edoBlocked), edoRefNs, edoNs);
+
+        // Arpeggiator steps must land on the same samples whatever the callback size
+        std::vector<float> arpBlocked, arpOdd;
+        double arpNs = timePerFrame(frames, [&]
+                                    { arpBlocked = engineTimeline(sampleRate, events, frames, Synth::MAX_BLOCK, true); });
+        double arpOddNs = timePerFrame(frames, [&]
+                                       { arpOdd = engineTimeline(sampleRate, events, frames, 37, true); });
+        report.row("arpeggiator", "render 37", EXACT, compare(arpBlocked, arpOdd), arpNs, arpOddNs);
+
+        // Parts sum in part order, so the parallel mix must match the serial one bit for bit
+        std::vector<Event> layered = events;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            Event e = events[i];
+            if (e.type == EventType::PitchBend)
+                continue;
+            e.channel = 1;
+            e.note -= 24;
+            layered.push_back(e);
+            e.channel = 2;
+            for (int third : {12, 16, 19})
+            {
+                e.note = (uint8_t)(events[i].note + third);
+                layered.push_back(e);
+            }
+        }
+        std::stable_sort(layered.begin(), layered.end(), [](const Event &a, const Event &b)
+                         { return a.time < b.time; });
+        std::vector<float> serial, parallel, partsOdd;
+        double serialNs = timePerFrame(frames, [&]
+                                       { serial = partsTimeline(sampleRate, layered, frames, Synth::MAX_BLOCK, 0); });
+        double parallelNs = timePerFrame(frames, [&]
+                                         { parallel = partsTimeline(sampleRate, layered, frames, Synth::MAX_BLOCK, 2); });
+        double partsOddNs = timePerFrame(frames, [&]
+                                         { partsOdd = partsTimeline(sampleRate, layered, frames, 300, 0); });
+        report.row("3 parts", "parallel", EXACT, compare(serial, parallel), serialNs, parallelNs);
+        report.row("3 parts", "render 300", EXACT, compare(serial, partsOdd), serialNs, partsOddNs);
+        std::cout << "\n";
+    }
+
+    // Stereo through a fresh limiter in `callback`-frame calls; left then right in the result
+    std::vector<float> renderLimiter(int sampleRate, const std::vector<float> &left, const std::vector<float> &right,
+                                     int callback, bool softClip)
+    {
+        Arena arena(Arena::footprint<Limiter>());
+        Limiter limiter(arena);
+        limiter.prepare((float)sampleRate);
+        limiter.enabled = true;
+        limiter.softClip = softClip;
+        std::vector<float> l = left, r = right;
+        for (size_t done = 0; done < l.size(); done += callback)
+        {
+            int n = (int)std::min<size_t>(callback, l.size() - done);
+            limiter.process(l.data() + done, r.data() + done, n);
+        }
+        l.insert(l.end(), r.begin(), r.end());
+        return l;
+    }
+
+    // Largest amount any sample goes past limit
+    double overshoot(const std::vector<float> &samples, double limit)
+    {
+        double worst = 0.0;
+        for (float x : samples)
+            worst = std::max(worst, std::fabs((double)x) - limit);
+        return worst;
+    }
+
+    void goldenLimiter(int sampleRate, Report &report)
+    {
+        const int frames = sampleRate * 2;
+        Arena arena(Arena::footprint<Limiter>());
+        Limiter probe(arena);
+        probe.prepare((float)sampleRate);
+        const int latency = probe.latency();
+
+        // Under the ceiling the limiter is a pure delay
+        std::vector<float> quietL(frames), quietR(frames), hotL(frames), hotR(frames);
+        for (int i = 0; i < frames; ++i)
+        {
+            float t = (float)i / sampleRate;
+            quietL[i] = 0.5f * std::sin(2.0f * (float)M_PI * 220.0f * t);
+            quietR[i] = 0.5f * std::sin(2.0f * (float)M_PI * 330.0f * t);
+            // Chords that sum well past full scale, with sudden onsets every 250 ms
+            float swell = 0.4f + 2.6f * (float)((i / (sampleRate / 4)) % 4) / 3.0f;
+            hotL[i] = swell * (std::sin(2.0f * (float)M_PI * 110.0f * t) + 0.7f * std::sin(2.0f * (float)M_PI * 1377.0f * t));
+            hotR[i] = swell * (std::sin(2.0f * (float)M_PI * 165.0f * t) + 0.7f * std::sin(2.0f * (float)M_PI * 2750.0f * t));
+        }
+        std::vector<float> delayed(2 * frames, 0.0f);
+        for (int i = latency; i < frames; ++i)
+        {
+            delayed[i] = quietL[i - latency];
+            delayed[frames + i] = quietR[i - latency];
+        }
+
+        report.header(("Master limiter: " + std::to_string(latency) + " frames latency").c_str());
+        std::vector<float> quiet, hot, hotOdd, clipped;
+        double quietNs = timePerFrame(frames, [&]
+                                      { quiet = renderLimiter(sampleRate, quietL, quietR, Synth::MAX_BLOCK, false); });
+        double hotNs = timePerFrame(frames, [&]
+                                    { hot = renderLimiter(sampleRate, hotL, hotR, Synth::MAX_BLOCK, false); });
+        double oddNs = timePerFrame(frames, [&]
+                                    { hotOdd = renderLimiter(sampleRate, hotL, hotR, 37, false); });
+        std::vector<float> clippedOdd;
+        double clipNs = timePerFrame(frames, [&]
+                                     { clipped = renderLimiter(sampleRate, hotL, hotR, Synth::MAX_BLOCK, true); });
+        double clipOddNs = timePerFrame(frames, [&]
+                                        { clippedOdd = renderLimiter(sampleRate, hotL, hotR, 37, true); });
+        report.row("under ceiling", "delay only", EXACT, compare(delayed, quiet), 0.0, quietNs);
+        report.bound("hot chords", "over ceiling", 1e-6, overshoot(hot, probe.ceiling), 0.0, hotNs);
+        report.row("hot chords", "render 37", EXACT, compare(hot, hotOdd), hotNs, oddNs);
+        report.bound("hot chords", "soft clip", 1e-6, overshoot(clipped, probe.ceiling), hotNs, clipNs);
+        report.row("hot chords, soft clip", "render 37", EXACT, compare(clipped, clippedOdd), clipNs, clipOddNs);
+
+        // The clipper leaves everything under its knee alone and never passes 1
+        std::vector<float> knee = quietL, loud = hotL;
+        Limiter::clip(knee.data(), frames, 0.8f);
+        Limiter::clip(loud.data(), frames, 0.8f);
+        report.row("clipper, under knee", "identity", EXACT, compare(quietL, knee), 0.0, 0.0);
+        report.bound("clipper, hot", "over 1", 0.0, overshoot(loud, 1.0), 0.0, 0.0);
+        std::cout << "\n";
+    }
+
+    // A sine on the left and a cosine on the right at `hz`, `inRate` frames per
+    // second, pulled through `resampler` in `callback`-frame calls
+    std::vector<float> pullSine(Resampler &resampler, double inRate, double hz, int frames, int callback)
+    {
+        std::vector<float> l(frames), r(frames);
+        int64_t input = 0;
+        auto render = [&](float *left, float *right, int n)
+        {
+            for (int i = 0; i < n; ++i, ++input)
+            {
+                double phase = 2.0 * M_PI * hz * input / inRate;
+                left[i] = 0.5f * (float)std::sin(phase);
+                right[i] = 0.5f * (float)std::cos(phase);
+            }
+        };
+        resampler.reset();
+        for (int done = 0; done < frames; done += callback)
+            resampler.pull(l.data() + done, r.data() + done, std::min(callback, frames - done), render);
+        l.insert(l.end(), r.begin(), r.end());
+        return l;
+    }
+
+    // The same sine sampled at outRate, latency input frames late, from frame `skip` on
+    std::vector<float> analyticSine(const Resampler &resampler, double inRate, double hz, int frames, int skip)
+    {
+        std::vector<float> out(2 * (frames - skip));
+        for (int j = skip; j < frames; ++j)
+        {
+            double phase = 2.0 * M_PI * hz * (j / resampler.ratio() - resampler.latency()) / inRate;
+            out[j - skip] = 0.5f * (float)std::sin(phase);
+            out[frames - skip + j - skip] = 0.5f * (float)std::cos(phase);
+        }
+        return out;
+    }
+
+    // Drops the first `skip` frames of each half
+    std::vector<float> settled(const std::vector<float> &stereo, int skip)
+    {
+        size_t frames = stereo.size() / 2;
+        std::vector<float> out(stereo.begin() + skip, stereo.begin() + frames);
+        out.insert(out.end(), stereo.begin() + frames + skip, stereo.end());
+        return out;
+    }
+
+    void goldenResampler(Report &report)
+    {
+        struct Case
+        {
+            double in, out;
+        };
+        const Case cases[] = {{44100, 48000}, {48000, 44100}, {44100, 96000}, {192000, 44100}, {44100, 47999.5}};
+        const int taps = 64;
+        const float cutoff = 0.9f;
+        const double hz = 1000.0;
+
+        report.header("Resampler: 64 taps, 1 kHz against the analytic sine");
+        for (const Case &c : cases)
+        {
+            Resampler resampler;
+            std::string error;
+            if (!resampler.configure(c.in, c.out, taps, cutoff, error))
+            {
+                std::cerr << error << "\n";
+                continue;
+            }
+            const int frames = (int)c.out;
+            const int skip = (int)std::ceil(2 * taps * resampler.ratio()); // Past the zeros before the first frame
+            std::vector<float> big, odd;
+            double bigNs = timePerFrame(frames, [&]
+                                        { big = pullSine(resampler, c.in, hz, frames, Synth::MAX_BLOCK); });
+            double oddNs = timePerFrame(frames, [&]
+                                        { odd = pullSine(resampler, c.in, hz, frames, 37); });
+            std::ostringstream name;
+            name << c.in / 1000.0 << " -> " << c.out / 1000.0 << (resampler.exact() ? "" : " interp");
+            report.row(name.str(), "pull", 90.0, compare(analyticSine(resampler, c.in, hz, frames, skip), settled(big, skip)),
+                       0.0, bigNs);
+            report.row(name.str(), "pull 37", EXACT, compare(big, odd), bigNs, oddNs);
+        }
+
+        // The soft clipper's 2x round trip, pushed in blocks
+        Resampler up, down;
+        std::string error;
+        up.configure(1.0, 2.0, Limiter::CLIP_TAPS, 0.85f, error);
+        down.configure(2.0, 1.0, Limiter::CLIP_TAPS, 0.85f, error);
+        const int frames = 44100;
+        std::vector<float> l(frames), r(frames), wideL(up.maxOutput(Resampler::BLOCK)), wideR(wideL.size());
+        for (int i = 0; i < frames; ++i)
+        {
+            l[i] = 0.5f * (float)std::sin(2.0 * M_PI * hz * i / 44100.0);
+            r[i] = 0.5f * (float)std::cos(2.0 * M_PI * hz * i / 44100.0);
+        }
+        std::vector<float> expected(2 * frames, 0.0f), trip(2 * frames);
+        for (int i = Limiter::CLIP_LATENCY; i < frames; ++i)
+        {
+            expected[i] = l[i - Limiter::CLIP_LATENCY];
+            expected[frames + i] = r[i - Limiter::CLIP_LATENCY];
+        }
+        double tripNs = timePerFrame(frames, [&]
+                                     {
+            for (int done = 0; done < frames; done += Resampler::BLOCK)
+            {
+                int n = std::min(frames - done, Resampler::BLOCK);
+                int wide = up.process(l.data() + done, r.data() + done, n, wideL.data(), wideR.data());
+                down.process(wideL.data(), wideR.data(), wide, trip.data() + done, trip.data() + frames + done);
+            } });
+        const int skip = 2 * Limiter::CLIP_TAPS;
+        report.row("2x up and down", "round trip", 80.0, compare(settled(expected, skip), settled(trip, skip)), 0.0, tripNs);
+        std::cout << "\n";
+    }
+}
+
+int runGoldenRenders(int sampleRate, double minSnrDb, double edgeSnrDb)
+{
+    Report report;
+    goldenFastMath(report);
+    goldenSynth(sampleRate, report, minSnrDb, edgeSnrDb);
+    goldenFM(sampleRate, report, minSnrDb);
+    goldenEngine(sampleRate, report, minSnrDb);
+    goldenLimiter(sampleRate, report);
+    goldenResampler(report);
+    return report.finish();
+}
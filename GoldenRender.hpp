@@ -0,0 +1,10 @@
+#pragma once
+
+// Regression check for the optimised render paths, run with `synth --golden`.
+// Fixed scenarios are rendered through the scalar reference (Synth::process,
+// one sample at a time) and through each optimised path. Paths that should
+// match bit for bit must; the rest must stay above minSnrDb against the
+// reference. Square and saw get edgeSnrDb instead: the reference accumulates
+// phase in double, so over a long render an edge can land one sample apart,
+// which costs SNR without being audible. Returns non-zero if any comparison fails.
+int runGoldenRenders(int sampleRate, double minSnrDb, double edgeSnrDb);
@@ -0,0 +1,306 @@
+#include "Granular.hpp"
+#include "Simd.hpp"
+#include "Stereo.hpp"
+#include "WavFile.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int BLOCK = 256; // Frames per scheduling pass
+}
+
+bool Granular::Source::load(const std::string &path, std::string &error)
+{
+    WavFile wav;
+    if (!wav.load(path, error))
+        return false;
+    if (wav.frames() < 2)
+    {
+        error = path + " is too short to granulate";
+        return false;
+    }
+    left = wav.channel(0);
+    right = wav.channels > 1 ? wav.channel(1) : left;
+    frames = wav.frames();
+    sampleRate = (float)wav.sampleRate;
+    return true;
+}
+
+Granular::Granular(Arena &arena)
+    : density(40.0f), size(0.08f), position(0.5f), positionSpray(0.05f), pitchSpray(0.0f), panSpray(0.5f),
+      gain(0.5f), part(-1), env(0.05f, 0.1f, 1.0f, 0.5f), dropped(0), pool(arena, MAX_GRAINS),
+      live(arena.allocate<Grain *>(MAX_GRAINS)), grainCount(0), window(arena.allocate<float>(WINDOW_SIZE + 2)),
+      voicesHeld(0), sampleRate(44100.0f), rngState(0x2545F491u), tuning(&Tuning::standard()), source(nullptr), pendingSource(nullptr),
+      retiredSource(nullptr)
+{
+    // One extra zero past the end, so interpolating at the last point stays in the table
+    if (window)
+    {
+        for (int i = 0; i <= WINDOW_SIZE; ++i)
+            window[i] = 0.5f - 0.5f * std::cos(2.0f * (float)M_PI * i / WINDOW_SIZE);
+        window[WINDOW_SIZE] = window[WINDOW_SIZE + 1] = 0.0f;
+    }
+}
+
+Granular::~Granular()
+{
+    delete source;
+    delete pendingSource.load();
+    delete retiredSource.load();
+}
+
+void Granular::prepare(float sr)
+{
+    sampleRate = sr;
+}
+
+void Granular::publishSource(Source *next)
+{
+    delete retiredSource.exchange(nullptr);
+    delete pendingSource.exchange(next);
+}
+
+void Granular::swapSource()
+{
+    if (retiredSource.load() != nullptr)
+        return;
+    Source *next = pendingSource.exchange(nullptr);
+    if (!next)
+        return;
+    retiredSource.store(source);
+    source = next;
+    // Grains point into the old buffer; held notes carry on from the new one
+    for (int i = 0; i < grainCount; ++i)
+        pool.release(live[i]);
+    grainCount = 0;
+}
+
+float Granular::random()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (rngState >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+void Granular::noteOn(int note, int velocity)
+{
+    float rate = tuning->ratio(ROOT_NOTE, note);
+    if (rate <= 0.0f)
+        return;
+    // An idle voice, else the same note, else one already releasing, else the first
+    Voice *v = nullptr;
+    for (Voice &candidate : voices)
+    {
+        if (candidate.env.state == 0)
+        {
+            v = &candidate;
+            break;
+        }
+    }
+    for (int pass = 0; !v && pass < 2; ++pass)
+    {
+        for (Voice &candidate : voices)
+        {
+            if (pass == 0 ? candidate.note == note : candidate.env.state == 4)
+            {
+                v = &candidate;
+                break;
+            }
+        }
+    }
+    if (!v)
+        v = &voices[0];
+
+    if (v->env.state == 0)
+        ++voicesHeld;
+    v->note = note;
+    v->level = velocity / 127.0f;
+    v->rate = rate;
+    v->env.attack = env.attack;
+    v->env.decay = env.decay;
+    v->env.sustain = env.sustain;
+    v->env.release = env.release;
+    v->env.noteOn();
+    v->untilNext = 0.0;
+}
+
+void Granular::noteOff(int note)
+{
+    for (Voice &v : voices)
+    {
+        if (v.note == note && v.env.state != 0)
+            v.env.noteOff();
+    }
+}
+
+void Granular::allNotesOff()
+{
+    for (Voice &v : voices)
+    {
+        if (v.env.state != 0)
+            v.env.noteOff();
+    }
+}
+
+void Granular::spawn(Voice &v, int offset, float envelope)
+{
+    Grain *g = pool.acquire();
+    if (!g)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Short sources shorten the grain rather than read past the end
+    const float rate = v.rate * std::exp2(pitchSpray * random() / 12.0f) * source->sampleRate / sampleRate;
+    const float usable = (float)(source->frames - 2);
+    int length = std::max(16, (int)(size * sampleRate));
+    length = std::min(length, (int)(usable / rate));
+    if (length < 2)
+    {
+        pool.release(g);
+        return;
+    }
+    float start = (position + positionSpray * random()) * usable;
+    start = std::min(std::max(start, 0.0f), usable - length * rate);
+
+    // Loudness stays put as grains overlap more
+    float overlap = std::max(1.0f, density * length / sampleRate);
+    float amp = gain * v.level * envelope / std::sqrt(overlap);
+    float gainL, gainR;
+    Stereo::panGains(panSpray * random(), gainL, gainR);
+
+    g->base = (int64_t)start;
+    g->frac = start - (float)g->base;
+    g->rate = rate;
+    g->windowPos = 0.0f;
+    g->windowInc = (float)WINDOW_SIZE / length;
+    g->remaining = length;
+    g->delay = offset;
+    g->gainL = amp * gainL;
+    g->gainR = amp * gainR;
+    live[grainCount++] = g;
+}
+
+void Granular::renderGrain(Grain &g, float *left, float *right, int frames)
+{
+    const int start = g.delay;
+    const int count = std::min(g.remaining, frames - start);
+    g.delay = 0;
+    const float *srcL = source->left.data() + g.base;
+    const float *srcR = source->right.data() + g.base;
+    float *outL = left + start, *outR = right + start;
+    const float frac = g.frac, rate = g.rate, wpos = g.windowPos, winc = g.windowInc;
+
+    int i = 0;
+#if defined(SYNTH_SSE2)
+    // Four frames at a time: read positions and window phases in registers, a
+    // scalar gather of the neighbouring samples, then interpolate and mix
+    const __m128 steps = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    alignas(16) int idx[4], widx[4];
+    alignas(16) float a[4], b[4], c[4], d[4], wa[4], wb[4];
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 n = _mm_add_ps(_mm_set1_ps((float)i), steps);
+        __m128 pos = _mm_add_ps(_mm_set1_ps(frac), _mm_mul_ps(n, _mm_set1_ps(rate)));
+        __m128i pi = _mm_cvttps_epi32(pos);
+        __m128 t = _mm_sub_ps(pos, _mm_cvtepi32_ps(pi));
+        __m128 wp = _mm_add_ps(_mm_set1_ps(wpos), _mm_mul_ps(n, _mm_set1_ps(winc)));
+        __m128i wi = _mm_cvttps_epi32(wp);
+        __m128 wt = _mm_sub_ps(wp, _mm_cvtepi32_ps(wi));
+        _mm_store_si128((__m128i *)idx, pi);
+        _mm_store_si128((__m128i *)widx, wi);
+        for (int j = 0; j < 4; ++j)
+        {
+            a[j] = srcL[idx[j]];
+            b[j] = srcL[idx[j] + 1];
+            c[j] = srcR[idx[j]];
+            d[j] = srcR[idx[j] + 1];
+            wa[j] = window[widx[j]];
+            wb[j] = window[widx[j] + 1];
+        }
+        __m128 w0 = _mm_load_ps(wa);
+        __m128 w = _mm_add_ps(w0, _mm_mul_ps(wt, _mm_sub_ps(_mm_load_ps(wb), w0)));
+        __m128 l0 = _mm_load_ps(a), r0 = _mm_load_ps(c);
+        __m128 l = _mm_add_ps(l0, _mm_mul_ps(t, _mm_sub_ps(_mm_load_ps(b), l0)));
+        __m128 r = _mm_add_ps(r0, _mm_mul_ps(t, _mm_sub_ps(_mm_load_ps(d), r0)));
+        l = _mm_mul_ps(_mm_mul_ps(l, w), _mm_set1_ps(g.gainL));
+        r = _mm_mul_ps(_mm_mul_ps(r, w), _mm_set1_ps(g.gainR));
+        _mm_storeu_ps(outL + i, _mm_add_ps(_mm_loadu_ps(outL + i), l));
+        _mm_storeu_ps(outR + i, _mm_add_ps(_mm_loadu_ps(outR + i), r));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        float n = (float)i;
+        float pos = frac + n * rate;
+        int k = (int)pos;
+        float t = pos - (float)k;
+        float wp = wpos + n * winc;
+        int wk = (int)wp;
+        float w = window[wk] + (wp - (float)wk) * (window[wk + 1] - window[wk]);
+        outL[i] += (srcL[k] + t * (srcL[k + 1] - srcL[k])) * w * g.gainL;
+        outR[i] += (srcR[k] + t * (srcR[k + 1] - srcR[k])) * w * g.gainR;
+    }
+
+    // Rebase so positions stay small and precise for the next block
+    float advance = frac + count * rate;
+    int64_t whole = (int64_t)advance;
+    g.base += whole;
+    g.frac = advance - (float)whole;
+    g.windowPos = wpos + count * winc;
+    g.remaining -= count;
+}
+
+void Granular::process(float *left, float *right, int frames)
+{
+    if (!source)
+        return;
+    const float dt = 1.0f / sampleRate;
+    const double interval = sampleRate / std::max(density, 0.1f);
+
+    while (frames > 0)
+    {
+        const int n = std::min(frames, BLOCK);
+
+        // Schedule this block's grains for every sounding voice
+        voicesHeld = 0;
+        for (Voice &v : voices)
+        {
+            if (v.env.state == 0)
+                continue;
+            float envBuf[BLOCK];
+            v.env.processBlock(envBuf, n, dt);
+            while (v.untilNext < n)
+            {
+                int offset = (int)v.untilNext;
+                spawn(v, offset, envBuf[offset]);
+                v.untilNext += interval;
+            }
+            v.untilNext -= n;
+            if (v.env.state != 0)
+                ++voicesHeld;
+            else
+                v.note = -1;
+        }
+
+        // Order is kept so the grains sum in the order they started
+        int kept = 0;
+        for (int i = 0; i < grainCount; ++i)
+        {
+            Grain *g = live[i];
+            renderGrain(*g, left, right, n);
+            if (g->remaining > 0)
+                live[kept++] = g;
+            else
+                pool.release(g);
+        }
+        grainCount = kept;
+
+        left += n;
+        right += n;
+        frames -= n;
+    }
+}
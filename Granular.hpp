@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Arena.hpp"
+#include "Envelope.hpp"
+#include "Tuning.hpp"
+
+// Granular voices: each held note sprays short Hann-windowed grains read from a
+// source buffer (a loaded WAV or a finished recording). Grains come from a
+// fixed pool reserved in the arena, so nothing is allocated on the audio
+// thread however dense the cloud gets; when the pool is empty new grains are
+// dropped and counted. The note sets the playback rate relative to ROOT_NOTE,
+// through the engine's tuning.
+class Granular
+{
+public:
+    static constexpr int MAX_VOICES = 8;
+    static constexpr int MAX_GRAINS = 1024; // Shared by all voices
+    static constexpr int ROOT_NOTE = 60;    // Plays the source at its own pitch
+    static constexpr int WINDOW_SIZE = 1024;
+
+    // Immutable once published; freed by the UI thread after the audio thread lets go
+    struct Source
+    {
+        std::vector<float> left, right;
+        int frames = 0;
+        float sampleRate = 44100.0f;
+
+        bool load(const std::string &path, std::string &error); // Any WAV; mono plays on both sides
+    };
+
+    // Set from the UI thread
+    float density;       // Grains per second per voice
+    float size;          // Grain length, seconds
+    float position;      // 0..1 through the source
+    float positionSpray; // Random offset, as a fraction of the source
+    float pitchSpray;    // Random detune, +- semitones
+    float panSpray;      // 0 keeps grains centred, 1 spreads them hard left to right
+    float gain;
+    int part; // Engine part whose notes the cloud plays, -1 for none
+    Envelope env;
+    std::atomic<unsigned long> dropped; // Grains not started because the pool was empty
+
+    explicit Granular(Arena &arena); // Grain pool and window table come from the arena
+    ~Granular();
+    Granular(const Granular &) = delete;
+    Granular &operator=(const Granular &) = delete;
+    void prepare(float sampleRate);
+
+    // UI thread: hands over a source (ownership included); grains of the old one stop
+    void publishSource(Source *source);
+
+    // Audio thread
+    void swapSource(); // Picks up a published source; call before dispatching notes
+    void setTuning(const Tuning *next) { tuning = next; } // Not owned; applies from the next note
+    bool hasSource() const { return source != nullptr; }
+    bool active() const { return grainCount > 0 || voicesHeld > 0; }
+    void noteOn(int note, int velocity);
+    void noteOff(int note);
+    void allNotesOff();
+    void process(float *left, float *right, int frames); // Adds into the buffers
+    int grains() const { return grainCount; }
+
+private:
+    struct Grain
+    {
+        int64_t base;        // Source frame the block starts from
+        float frac;          // Fractional read position past base
+        float rate;          // Source frames per output frame
+        float windowPos;     // Read position in the window table
+        float windowInc;
+        int remaining;       // Output frames left
+        int delay;           // Frames into the current block before it starts
+        float gainL, gainR;
+    };
+
+    struct Voice
+    {
+        int note = -1;
+        float level = 0.0f; // Velocity
+        float rate = 1.0f;
+        Envelope env;
+        double untilNext = 0.0; // Frames until the next grain
+    };
+
+    Pool<Grain> pool;
+    Grain **live; // MAX_GRAINS pointers from the arena
+    int grainCount;
+    float *window; // WINDOW_SIZE + 1 points of a Hann window, from the arena
+    Voice voices[MAX_VOICES];
+    int voicesHeld; // Voices whose envelope is not idle
+
+    float sampleRate;
+    uint32_t rngState;
+
+    const Tuning *tuning;
+    Source *source; // Owned by the audio thread
+    std::atomic<Source *> pendingSource;
+    std::atomic<Source *> retiredSource; // Freed by the UI thread on its next publish
+
+    float random(); // -1..1
+    void spawn(Voice &voice, int offset, float envelope);
+    void renderGrain(Grain &g, float *left, float *right, int frames);
+};
@@ -1,5 +1,6 @@
 #include "LFO.hpp"
 #include <cmath>
+#include "FastMath.hpp"
 
 LFO::LFO(float rate, float depth)
     : rate(rate), depth(depth), phase(0.0f),
@@ -26,10 +27,10 @@ float LFO::process(float dt)
     switch (waveform)
     {
     case WaveForm::Sine:
-        lfoValue = std::sin(phase);
+        lfoValue = FastMath::sinPositive(phase); // A modulation source; 1e-3 error is inaudible
         break;
     case WaveForm::Square:
-        lfoValue = (std::sin(phase) > 0) ? 1.0f : -1.0f;
+        lfoValue = (FastMath::sinPositive(phase) > 0) ? 1.0f : -1.0f;
         break;
     case WaveForm::Triangle:
     {
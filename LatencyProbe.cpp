@@ -0,0 +1,130 @@
+#include "LatencyProbe.hpp"
+#include <portaudio.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    double milliseconds(LatencyProbe::Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+}
+
+LatencyProbe::LatencyProbe()
+    : enabled(false), outputLatency(0.0), state(Idle), slot(0), dacOffset(0.0), rate(44100.0), framesWaited(0),
+      results(), resultWrite(0), resultRead(0), timeouts(0) {}
+
+void LatencyProbe::markInput(Clock::time_point input, Clock::time_point handled, uint32_t inboxIndex)
+{
+    if (!enabled || state.load(std::memory_order_acquire) != Idle)
+        return;
+    inputTime = input;
+    handledTime = handled;
+    slot = inboxIndex;
+    state.store(Armed, std::memory_order_release);
+}
+
+size_t LatencyProbe::collect(std::vector<Measurement> &out)
+{
+    uint32_t w = resultWrite.load(std::memory_order_acquire);
+    uint32_t r = resultRead.load(std::memory_order_relaxed);
+    size_t n = w - r;
+    for (; r != w; ++r)
+        out.push_back(results[r % MAX_RESULTS]);
+    resultRead.store(r, std::memory_order_release);
+    return n;
+}
+
+void LatencyProbe::beginCallback(const PaStreamCallbackTimeInfo *timeInfo, double sampleRate)
+{
+    if (!enabled)
+        return;
+    callbackStart = Clock::now();
+    rate = sampleRate;
+    // Some hosts leave the DAC time at zero; fall back to the stream's nominal latency
+    if (timeInfo && timeInfo->outputBufferDacTime > timeInfo->currentTime)
+        dacOffset = timeInfo->outputBufferDacTime - timeInfo->currentTime;
+    else
+        dacOffset = outputLatency;
+}
+
+void LatencyProbe::afterRender(uint32_t consumedBefore, uint32_t consumedAfter, const float *left, const float *right,
+                               int frames, int offset)
+{
+    if (!enabled)
+        return;
+    int s = state.load(std::memory_order_acquire);
+    if (s == Armed)
+    {
+        // The inbox drains at the start of a render, so the note begins at its first frame
+        if (slot - consumedBefore >= consumedAfter - consumedBefore)
+            return;
+        state.store(Tracking, std::memory_order_relaxed);
+        framesWaited = 0;
+    }
+    else if (s != Tracking)
+        return;
+
+    for (int i = 0; i < frames; ++i)
+    {
+        if (std::fabs(left[i]) > AUDIBLE || std::fabs(right[i]) > AUDIBLE)
+        {
+            finish(offset + i);
+            return;
+        }
+    }
+    framesWaited += frames;
+    if (framesWaited > TIMEOUT_SECONDS * rate)
+    {
+        timeouts.fetch_add(1, std::memory_order_relaxed);
+        state.store(Idle, std::memory_order_release);
+    }
+}
+
+void LatencyProbe::finish(int frame)
+{
+    Measurement m;
+    m.queueMs = milliseconds(handledTime - inputTime);
+    m.dispatchMs = milliseconds(callbackStart - handledTime);
+    m.outputMs = 1000.0 * (dacOffset + frame / rate);
+    m.totalMs = m.queueMs + m.dispatchMs + m.outputMs;
+
+    uint32_t w = resultWrite.load(std::memory_order_relaxed);
+    if (w - resultRead.load(std::memory_order_acquire) < (uint32_t)MAX_RESULTS)
+    {
+        results[w % MAX_RESULTS] = m;
+        resultWrite.store(w + 1, std::memory_order_release);
+    }
+    state.store(Idle, std::memory_order_release);
+}
+
+void LatencyProbe::report(const std::vector<Measurement> &measurements)
+{
+    if (measurements.empty())
+    {
+        std::cout << "Latency: no measurements\n";
+        return;
+    }
+    const char *names[4] = {"queue", "dispatch", "output", "total"};
+    double Measurement::*fields[4] = {&Measurement::queueMs, &Measurement::dispatchMs, &Measurement::outputMs,
+                                      &Measurement::totalMs};
+
+    std::cout << "== Latency over " << measurements.size() << " notes (ms)\n";
+    std::cout << std::left << std::setw(10) << "" << std::right << std::setw(9) << "min" << std::setw(9) << "median"
+              << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9) << "max" << "\n";
+    std::vector<double> values(measurements.size());
+    for (int f = 0; f < 4; ++f)
+    {
+        for (size_t i = 0; i < measurements.size(); ++i)
+            values[i] = measurements[i].*fields[f];
+        std::sort(values.begin(), values.end());
+        auto at = [&](double q)
+        { return values[std::min(values.size() - 1, (size_t)(q * (values.size() - 1) + 0.5))]; };
+        std::cout << std::left << std::setw(10) << names[f] << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(9) << values.front() << std::setw(9) << at(0.5) << std::setw(9) << at(0.9)
+                  << std::setw(9) << at(0.99) << std::setw(9) << values.back() << "\n";
+    }
+}
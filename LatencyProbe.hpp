@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct PaStreamCallbackTimeInfo;
+
+// Measures input-to-sound latency for notes played from the UI. The UI marks
+// an input event together with the engine inbox slot its note-on goes into;
+// the audio callback sees which render consumed that slot, finds the first
+// audible sample from there on, and places it on the wall clock with the
+// host's DAC time for the buffer. One measurement is in flight at a time;
+// inputs marked meanwhile are not measured. Anything else sounding counts as
+// audible, so measure from silence.
+class LatencyProbe
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int MAX_RESULTS = 256;   // Finished measurements not yet collected
+    static constexpr float AUDIBLE = 1e-4f;   // -80 dBFS
+    static constexpr double TIMEOUT_SECONDS = 2.0;
+
+    struct Measurement
+    {
+        double queueMs;    // OS input event to the UI loop handling it
+        double dispatchMs; // UI handling to the start of the callback that sounded the note
+        double outputMs;   // Callback start to the first audible sample reaching the DAC
+        double totalMs;
+    };
+
+    bool enabled;
+    double outputLatency; // Seconds from callback to DAC when the host reports no DAC time
+
+    LatencyProbe();
+
+    // UI thread, before posting the note-on that lands in inbox slot inboxIndex
+    void markInput(Clock::time_point input, Clock::time_point handled, uint32_t inboxIndex);
+    // UI thread: moves finished measurements into out; returns how many
+    size_t collect(std::vector<Measurement> &out);
+    unsigned long missed() const { return timeouts.load(std::memory_order_relaxed); }
+    // Min, median, 90th, 99th percentile and max of each component
+    static void report(const std::vector<Measurement> &measurements);
+
+    // Audio thread. timeInfo may be null (offline or simulated callbacks).
+    void beginCallback(const PaStreamCallbackTimeInfo *timeInfo, double sampleRate);
+    // After each engine render of frames at offset into the callback buffer,
+    // with the engine's inbox read count before and after that render
+    void afterRender(uint32_t consumedBefore, uint32_t consumedAfter, const float *left, const float *right,
+                     int frames, int offset);
+
+private:
+    enum State : int
+    {
+        Idle,     // UI may mark
+        Armed,    // Marked, note not rendered yet
+        Tracking  // Rendered, waiting for the first audible sample
+    };
+
+    std::atomic<int> state;
+    // Written by the UI while Idle, read by the audio thread once Armed
+    Clock::time_point inputTime, handledTime;
+    uint32_t slot;
+
+    // Audio thread
+    Clock::time_point callbackStart;
+    double dacOffset; // Seconds from callbackStart to the DAC time of frame 0
+    double rate;
+    uint64_t framesWaited;
+
+    Measurement results[MAX_RESULTS];
+    std::atomic<uint32_t> resultWrite, resultRead;
+    std::atomic<unsigned long> timeouts;
+
+    void finish(int frame);
+};
@@ -0,0 +1,197 @@
+#include "Limiter.hpp"
+#include "Simd.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int MAX_LATENCY = (Limiter::MAX_LOOKAHEAD_BLOCKS + 1) * Limiter::BLOCK;
+    constexpr float LOOKAHEAD_SECONDS = 0.0015f;
+    constexpr int WIDE_FRAMES = 2 * Resampler::BLOCK + 1;
+    constexpr float CLIP_CUTOFF = 0.85f;
+
+    int lookaheadBlocks(float sampleRate)
+    {
+        int blocks = (int)std::lround(LOOKAHEAD_SECONDS * sampleRate / Limiter::BLOCK);
+        return std::max(1, std::min(blocks, Limiter::MAX_LOOKAHEAD_BLOCKS));
+    }
+
+    // Largest |sample| on either side
+    float peakOf(const float *left, const float *right, int frames, float peak)
+    {
+        int i = 0;
+#if defined(SYNTH_SSE2)
+        const __m128 abs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 m = _mm_set1_ps(peak);
+        for (; i + 4 <= frames; i += 4)
+        {
+            m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(left + i), abs));
+            m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(right + i), abs));
+        }
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        peak = _mm_cvtss_f32(m);
+#elif defined(SYNTH_NEON)
+        float32x4_t m = vdupq_n_f32(peak);
+        for (; i + 4 <= frames; i += 4)
+        {
+            m = vmaxq_f32(m, vabsq_f32(vld1q_f32(left + i)));
+            m = vmaxq_f32(m, vabsq_f32(vld1q_f32(right + i)));
+        }
+        float32x2_t h = vpmax_f32(vget_low_f32(m), vget_high_f32(m));
+        peak = vget_lane_f32(vpmax_f32(h, h), 0);
+#endif
+        for (; i < frames; ++i)
+            peak = std::max(peak, std::max(std::fabs(left[i]), std::fabs(right[i])));
+        return peak;
+    }
+}
+
+Limiter::Limiter(Arena &arena)
+    : enabled(false), ceiling(0.966f), release(0.08f), softClip(false), clipKnee(0.8f),
+      delayL(arena.allocate<float>(MAX_LATENCY)), delayR(arena.allocate<float>(MAX_LATENCY)),
+      wideL(arena.allocate<float>(WIDE_FRAMES)), wideR(arena.allocate<float>(WIDE_FRAMES)), sampleRate(44100.0f),
+      lookahead(lookaheadBlocks(sampleRate)), pos(0), blockPeak(0.0f), peaks(), window(), peakIndex(0), windowIndex(0),
+      gainStart(1.0f), gainEnd(1.0f), active(false)
+{
+    std::fill(window, window + MAX_LOOKAHEAD_BLOCKS, 1.0f); // The delay lines start zeroed with the arena
+    // Integer ratios: each frame in gives exactly two, each two give back exactly one
+    std::string error;
+    up.configure(1.0, 2.0, CLIP_TAPS, CLIP_CUTOFF, error);
+    down.configure(2.0, 1.0, CLIP_TAPS, CLIP_CUTOFF, error);
+}
+
+void Limiter::prepare(float rate)
+{
+    sampleRate = rate;
+    lookahead = lookaheadBlocks(rate);
+    reset();
+}
+
+void Limiter::reset()
+{
+    std::fill(delayL, delayL + MAX_LATENCY, 0.0f);
+    std::fill(delayR, delayR + MAX_LATENCY, 0.0f);
+    pos = 0;
+    blockPeak = 0.0f;
+    std::fill(peaks, peaks + MAX_LOOKAHEAD_BLOCKS + 1, 0.0f);
+    std::fill(window, window + MAX_LOOKAHEAD_BLOCKS, 1.0f);
+    peakIndex = windowIndex = 0;
+    gainStart = gainEnd = 1.0f;
+    up.reset();
+    down.reset();
+}
+
+// Output block j is input block j played latency() frames late. Every window
+// gain averaged into its end gain, and into the previous block's, covers
+// block j's peak, so the whole ramp across block j stays under the ceiling.
+void Limiter::nextGain()
+{
+    peaks[peakIndex] = blockPeak;
+    peakIndex = peakIndex == lookahead ? 0 : peakIndex + 1;
+    blockPeak = 0.0f;
+    float peak = 0.0f;
+    for (int b = 0; b <= lookahead; ++b)
+        peak = std::max(peak, peaks[b]);
+    window[windowIndex] = peak > ceiling ? ceiling / peak : 1.0f;
+    windowIndex = windowIndex + 1 == lookahead ? 0 : windowIndex + 1;
+    float sum = 0.0f;
+    for (int b = 0; b < lookahead; ++b)
+        sum += window[b];
+    float target = sum / lookahead; // Exactly 1 while nothing is over
+    gainStart = gainEnd;
+    if (target < gainEnd)
+        gainEnd = target;
+    else if (target > gainEnd)
+        gainEnd = std::min(target, gainEnd + (target - gainEnd) * (1.0f - std::exp(-BLOCK / (release * sampleRate))));
+}
+
+void Limiter::process(float *left, float *right, int frames)
+{
+    if (!enabled)
+    {
+        active = false;
+        return;
+    }
+    if (!active)
+    {
+        reset();
+        active = true;
+    }
+    if (softClip)
+        clipOversampled(left, right, frames);
+    const int length = (lookahead + 1) * BLOCK; // The clipper's share of latency() is in up and down
+    int done = 0;
+    while (done < frames)
+    {
+        // Up to the end of the current block; blocks never straddle the delay line's wrap
+        int fill = pos % BLOCK;
+        int n = std::min(frames - done, BLOCK - fill);
+        float *l = left + done, *r = right + done;
+        blockPeak = peakOf(l, r, n, blockPeak);
+        const float step = (gainEnd - gainStart) / BLOCK;
+        float *dl = delayL + pos, *dr = delayR + pos;
+        for (int i = 0; i < n; ++i)
+        {
+            float g = gainStart + step * (fill + i + 1);
+            float outL = dl[i] * g, outR = dr[i] * g;
+            dl[i] = l[i];
+            dr[i] = r[i];
+            l[i] = outL;
+            r[i] = outR;
+        }
+        pos += n;
+        done += n;
+        if (fill + n == BLOCK)
+        {
+            nextGain();
+            if (pos == length)
+                pos = 0;
+        }
+    }
+}
+
+void Limiter::clipOversampled(float *left, float *right, int frames)
+{
+    for (int done = 0; done < frames; done += Resampler::BLOCK)
+    {
+        int n = std::min(frames - done, Resampler::BLOCK);
+        int wide = up.process(left + done, right + done, n, wideL, wideR);
+        clip(wideL, wide, clipKnee);
+        clip(wideR, wide, clipKnee);
+        down.process(wideL, wideR, wide, left + done, right + done);
+    }
+}
+
+void Limiter::clip(float *samples, int frames, float knee)
+{
+    // Above the knee the excess u, scaled to the headroom, goes through the
+    // Pade tanh u (27 + u^2) / (27 + 9 u^2), which reaches exactly 1 at u = 3
+    knee = std::max(0.0f, std::min(knee, 0.999f));
+    const float headroom = 1.0f - knee, scale = 1.0f / headroom;
+    int i = 0;
+#if defined(SYNTH_SSE2)
+    const __m128 sign = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u));
+    const __m128 k = _mm_set1_ps(knee), h = _mm_set1_ps(headroom), s = _mm_set1_ps(scale);
+    const __m128 three = _mm_set1_ps(3.0f), c27 = _mm_set1_ps(27.0f), c9 = _mm_set1_ps(9.0f), zero = _mm_setzero_ps();
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(samples + i);
+        __m128 a = _mm_andnot_ps(sign, x);
+        __m128 u = _mm_min_ps(_mm_mul_ps(_mm_max_ps(_mm_sub_ps(a, k), zero), s), three);
+        __m128 u2 = _mm_mul_ps(u, u);
+        __m128 p = _mm_div_ps(_mm_mul_ps(u, _mm_add_ps(c27, u2)), _mm_add_ps(c27, _mm_mul_ps(c9, u2)));
+        __m128 y = _mm_add_ps(_mm_min_ps(a, k), _mm_mul_ps(h, p));
+        _mm_storeu_ps(samples + i, _mm_or_ps(y, _mm_and_ps(sign, x)));
+    }
+#endif
+    for (; i < frames; ++i)
+    {
+        float x = samples[i];
+        float a = std::fabs(x);
+        float u = std::min(std::max(a - knee, 0.0f) * scale, 3.0f);
+        float u2 = u * u; // Same rounding as the SIMD lanes, so the split point does not matter
+        float p = u * (27.0f + u2) / (27.0f + 9.0f * u2);
+        samples[i] = std::copysign(std::min(a, knee) + headroom * p, x);
+    }
+}
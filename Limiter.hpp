@@ -0,0 +1,53 @@
+#pragma once
+#include "Arena.hpp"
+#include "Resampler.hpp"
+
+// Master bus safety stage: an optional soft clipper, then a look-ahead peak
+// limiter. Peaks are taken per BLOCK frames and the gain is the window
+// minimum over the look-ahead, box-averaged and ramped linearly across each
+// block, so the output never exceeds the ceiling and nothing is computed
+// per sample beyond the ramp. The delay is fixed for a given rate: latency()
+// frames, about 1.5 ms. The clipper runs at twice the rate so its harmonics do
+// not fold back, which adds CLIP_LATENCY frames. Delay lines and the 2x
+// buffers come from the engine arena.
+class Limiter
+{
+public:
+    static constexpr int BLOCK = 16;
+    static constexpr int MAX_LOOKAHEAD_BLOCKS = 16; // Enough for 1.5 ms at 192 kHz
+    static constexpr int CLIP_TAPS = 32;
+    static constexpr int CLIP_LATENCY = CLIP_TAPS / 2 + CLIP_TAPS / 4; // Up at 1x, then down at 2x
+
+    bool enabled;   // Cleared when switched back on
+    float ceiling;  // Linear peak the output stays under
+    float release;  // Seconds for the gain to recover most of the way
+    bool softClip;  // Round off peaks above clipKnee before the limiter sees them; set while stopped
+    float clipKnee; // 0..1; the clipper's output never exceeds 1
+
+    explicit Limiter(Arena &arena);
+    void prepare(float sampleRate);
+    void reset();
+    void process(float *left, float *right, int frames);
+    // Frames the limiter delays its output by while enabled
+    int latency() const { return (lookahead + 1) * BLOCK + (softClip ? CLIP_LATENCY : 0); }
+
+    // In place: identity below knee, a tanh-like curve above it that reaches 1
+    static void clip(float *samples, int frames, float knee);
+
+private:
+    float *delayL, *delayR; // latency() frames each, from the arena
+    float *wideL, *wideR;   // One block at twice the rate
+    Resampler up, down;
+    float sampleRate;
+    int lookahead; // Blocks of look-ahead
+    int pos;       // Write position in the delay lines; pos % BLOCK is the fill of the current block
+    float blockPeak;
+    float peaks[MAX_LOOKAHEAD_BLOCKS + 1]; // Peak of each of the last lookahead + 1 blocks
+    float window[MAX_LOOKAHEAD_BLOCKS];    // Gain allowed by each of the last lookahead windows
+    int peakIndex, windowIndex;
+    float gainStart, gainEnd; // Ramp across the block being output
+    bool active;
+
+    void nextGain();
+    void clipOversampled(float *left, float *right, int frames);
+};
@@ -0,0 +1,121 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile() : ptr(nullptr), length(0), fileHandle(INVALID_HANDLE_VALUE), mapping(nullptr) {}
+#else
+MappedFile::MappedFile() : ptr(nullptr), length(0), fd(-1) {}
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &path, std::string &error)
+{
+    close();
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(fileHandle, &size);
+    length = (size_t)size.QuadPart;
+    mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping || !(ptr = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)))
+    {
+        error = "cannot map " + path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (ptr)
+        UnmapViewOfFile(ptr);
+    if (mapping)
+        CloseHandle(mapping);
+    if (fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+    ptr = nullptr;
+    mapping = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+    length = 0;
+}
+
+size_t MappedFile::residentBytes() const
+{
+    return 0;
+}
+#else
+bool MappedFile::open(const std::string &path, std::string &error)
+{
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        error = "cannot stat " + path;
+        close();
+        return false;
+    }
+    length = (size_t)st.st_size;
+    void *p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        error = "cannot map " + path;
+        close();
+        return false;
+    }
+    ptr = (const unsigned char *)p;
+    madvise(p, length, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (ptr)
+        munmap((void *)ptr, length);
+    if (fd >= 0)
+        ::close(fd);
+    ptr = nullptr;
+    fd = -1;
+    length = 0;
+}
+
+size_t MappedFile::residentBytes() const
+{
+    if (!ptr)
+        return 0;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t pages = (length + page - 1) / page;
+    std::vector<unsigned char> vec(pages);
+    if (mincore((void *)ptr, length, vec.data()) != 0)
+        return 0;
+    size_t resident = 0;
+    for (unsigned char v : vec)
+        resident += (v & 1);
+    return resident * page;
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first touch
+// and can be evicted by the OS at any time, so mapped data is only read from
+// background threads, never from the audio callback.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path, std::string &error);
+    void close();
+    const unsigned char *data() const { return ptr; }
+    size_t size() const { return length; }
+    size_t residentBytes() const; // Pages currently in RAM; 0 where the OS cannot tell us
+
+private:
+    const unsigned char *ptr;
+    size_t length;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mapping;
+#else
+    int fd;
+#endif
+};
@@ -0,0 +1,270 @@
+#include "MidiFile.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    class TrackReader
+    {
+    public:
+        uint64_t tick;
+        bool done;
+        // Event waiting to be merged
+        uint8_t status;
+        uint8_t data1, data2;
+        uint8_t metaType;
+        uint32_t tempo; // Valid when metaType == 0x51
+
+        TrackReader(std::ifstream &file, std::streamoff start, std::streamoff end)
+            : tick(0), done(false), status(0), data1(0), data2(0), metaType(0), tempo(0),
+              file(file), pos(start), end(end), bufLen(0), bufPos(0), runningStatus(0) {}
+
+        // Reads the next event into the public fields; returns false at end of track
+        bool next()
+        {
+            while (!done)
+            {
+                tick += readVarLen();
+                int b = readByte();
+                if (b < 0)
+                    break;
+
+                metaType = 0;
+                if (b < 0x80)
+                {
+                    // Running status: b is already the first data byte
+                    if (runningStatus == 0)
+                        break;
+                    status = runningStatus;
+                    data1 = (uint8_t)b;
+                    data2 = hasTwoDataBytes(status) ? (uint8_t)readByte() : 0;
+                    return true;
+                }
+                if (b < 0xF0)
+                {
+                    status = runningStatus = (uint8_t)b;
+                    data1 = (uint8_t)readByte();
+                    data2 = hasTwoDataBytes(status) ? (uint8_t)readByte() : 0;
+                    return true;
+                }
+                if (b == 0xFF)
+                {
+                    status = 0xFF;
+                    metaType = (uint8_t)readByte();
+                    uint32_t length = readVarLen();
+                    if (metaType == 0x2F)
+                        break;
+                    if (metaType == 0x51 && length == 3)
+                    {
+                        tempo = (uint32_t)readByte() << 16;
+                        tempo |= (uint32_t)readByte() << 8;
+                        tempo |= (uint32_t)readByte();
+                        return true;
+                    }
+                    skip(length);
+                    continue;
+                }
+                // SysEx: skip the payload
+                skip(readVarLen());
+            }
+            done = true;
+            return false;
+        }
+
+    private:
+        std::ifstream &file;
+        std::streamoff pos, end;
+        unsigned char buffer[4096];
+        int bufLen, bufPos;
+        uint8_t runningStatus;
+
+        static bool hasTwoDataBytes(uint8_t s)
+        {
+            uint8_t kind = s & 0xF0;
+            return kind != 0xC0 && kind != 0xD0;
+        }
+
+        int readByte()
+        {
+            if (bufPos == bufLen)
+            {
+                if (pos >= end)
+                {
+                    done = true;
+                    return -1;
+                }
+                std::streamoff n = std::min<std::streamoff>(sizeof(buffer), end - pos);
+                file.clear();
+                file.seekg(pos);
+                file.read((char *)buffer, n);
+                bufLen = (int)file.gcount();
+                bufPos = 0;
+                pos += bufLen;
+                if (bufLen == 0)
+                {
+                    done = true;
+                    return -1;
+                }
+            }
+            return buffer[bufPos++];
+        }
+
+        uint32_t readVarLen()
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                int b = readByte();
+                if (b < 0)
+                    return value;
+                value = (value << 7) | (b & 0x7F);
+                if (!(b & 0x80))
+                    break;
+            }
+            return value;
+        }
+
+        void skip(uint32_t n)
+        {
+            int inBuffer = bufLen - bufPos;
+            if ((int64_t)n <= inBuffer)
+            {
+                bufPos += n;
+                return;
+            }
+            pos += n - inBuffer;
+            bufPos = bufLen = 0;
+        }
+    };
+
+    uint32_t readBE32(const unsigned char *p) { return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+    uint16_t readBE16(const unsigned char *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+}
+
+bool MidiFile::load(const std::string &path, float sampleRate, std::vector<Event> &events, std::string &error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    unsigned char header[14];
+    if (!file.read((char *)header, 14) || std::memcmp(header, "MThd", 4) != 0)
+    {
+        error = path + " is not a Standard MIDI File";
+        return false;
+    }
+    uint32_t headerLength = readBE32(header + 4);
+    int format = readBE16(header + 8);
+    int numTracks = readBE16(header + 10);
+    int division = readBE16(header + 12);
+    if (format > 1)
+    {
+        error = path + ": only type 0 and 1 files are supported";
+        return false;
+    }
+    if ((division & 0x8000) ? (division & 0xFF) == 0 : division == 0)
+    {
+        error = path + ": invalid time division";
+        return false;
+    }
+
+    // Locate the track chunks without reading their contents
+    std::vector<TrackReader> tracks;
+    tracks.reserve(numTracks);
+    std::streamoff offset = 8 + headerLength;
+    while ((int)tracks.size() < numTracks)
+    {
+        unsigned char chunk[8];
+        file.clear();
+        file.seekg(offset);
+        if (!file.read((char *)chunk, 8))
+            break;
+        uint32_t length = readBE32(chunk + 4);
+        if (std::memcmp(chunk, "MTrk", 4) == 0)
+            tracks.emplace_back(file, offset + 8, offset + 8 + length);
+        offset += 8 + length;
+    }
+    if (tracks.empty())
+    {
+        error = path + ": no tracks";
+        return false;
+    }
+
+    // Seconds per tick, from the tempo map (PPQ) or fixed (SMPTE)
+    double secondsPerTick;
+    bool smpte = (division & 0x8000) != 0;
+    if (smpte)
+    {
+        int fps = 256 - (division >> 8);
+        secondsPerTick = 1.0 / (fps * (division & 0xFF));
+    }
+    else
+    {
+        secondsPerTick = 0.5 / division; // 120 bpm until the first tempo event
+    }
+
+    for (TrackReader &t : tracks)
+        t.next();
+
+    uint64_t lastTick = 0;
+    double lastSeconds = 0.0;
+    events.clear();
+    while (true)
+    {
+        // The track with the earliest pending event goes next; ties keep track order
+        TrackReader *earliest = nullptr;
+        for (TrackReader &t : tracks)
+        {
+            if (!t.done && (!earliest || t.tick < earliest->tick))
+                earliest = &t;
+        }
+        if (!earliest)
+            break;
+
+        TrackReader &t = *earliest;
+        lastSeconds += (t.tick - lastTick) * secondsPerTick;
+        lastTick = t.tick;
+
+        if (t.status == 0xFF)
+        {
+            if (t.metaType == 0x51 && !smpte)
+                secondsPerTick = t.tempo / 1e6 / division;
+        }
+        else
+        {
+            Event e{};
+            e.time = (uint64_t)(lastSeconds * sampleRate + 0.5);
+            e.channel = t.status & 0x0F;
+            e.note = t.data1;
+            e.velocity = t.data2;
+            bool keep = true;
+            switch (t.status & 0xF0)
+            {
+            case 0x80:
+                e.type = EventType::NoteOff;
+                break;
+            case 0x90:
+                e.type = t.data2 == 0 ? EventType::NoteOff : EventType::NoteOn;
+                break;
+            case 0xB0:
+                e.type = EventType::Controller;
+                e.value = t.data2 / 127.0f;
+                break;
+            case 0xE0:
+                e.type = EventType::PitchBend;
+                e.value = (((t.data2 << 7) | t.data1) - 8192) / 8192.0f;
+                break;
+            default:
+                keep = false;
+                break;
+            }
+            if (keep)
+                events.push_back(e);
+        }
+        t.next();
+    }
+    return true;
+}
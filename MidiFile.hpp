@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Event.hpp"
+
+// Standard MIDI File (type 0/1) reader. Each track is streamed through a small
+// buffer and the tracks are merged in tick order while the tempo map is applied,
+// so the only thing kept in memory is the resulting flat, sample-timed array.
+class MidiFile
+{
+public:
+    static bool load(const std::string &path, float sampleRate, std::vector<Event> &events, std::string &error);
+};
@@ -0,0 +1,142 @@
+#include "Part.hpp"
+#include <algorithm>
+#include <cmath>
+
+Part::Part() : patch(), channel(0), polyphony(MAX_VOICES), enabled(true), voiceCap(MAX_VOICES), unisonCap(Unison::MAX_VOICES),
+               controlInterval(1), voice(), count(0), bendRatio(1.0f),
+               tuning(&Tuning::standard()) {}
+
+void Part::noteOn(VoicePool &pool, int note, unsigned long age)
+{
+    if (!tuning->mapped(note))
+        return;
+    int limit = std::max(1, std::min(std::min(polyphony, voiceCap), MAX_VOICES));
+    Voice *v = count < limit ? pool.acquire() : nullptr;
+    if (v)
+    {
+        v->synth = patch;
+        voice[count++] = v;
+    }
+    else
+    {
+        if (count == 0)
+            return;
+        // Steal the oldest releasing voice, else the oldest. It keeps its
+        // oscillator and filter state, so the steal does not click.
+        v = voice[0];
+        for (int i = 1; i < count; ++i)
+        {
+            bool releasing = voice[i]->synth.env.state == 4, best = v->synth.env.state == 4;
+            if ((releasing && !best) || (releasing == best && voice[i]->age < v->age))
+                v = voice[i];
+        }
+    }
+    v->note = note;
+    v->age = age;
+    tune(*v);
+    v->synth.noteOn();
+}
+
+void Part::noteOff(int note)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (voice[i]->note == note)
+            voice[i]->synth.noteOff();
+    }
+}
+
+void Part::allNotesOff()
+{
+    for (int i = 0; i < count; ++i)
+        voice[i]->synth.noteOff();
+}
+
+void Part::setPitchBend(float bend)
+{
+    bendRatio = std::exp2(bend * 2.0f / 12.0f);
+    for (int i = 0; i < count; ++i)
+        tune(*voice[i]);
+}
+
+void Part::setTuning(const Tuning *next)
+{
+    tuning = next;
+    for (int i = 0; i < count; ++i)
+    {
+        if (tuning->mapped(voice[i]->note))
+            tune(*voice[i]);
+        else
+            voice[i]->synth.noteOff();
+    }
+}
+
+void Part::tune(Voice &v) const
+{
+    v.synth.setFrequency(tuning->frequency(v.note) * bendRatio);
+}
+
+void Part::follow(Synth &s) const
+{
+    s.waveType = patch.waveType;
+    s.amplitude = patch.amplitude;
+    s.baseCutoff = patch.baseCutoff;
+    s.pan = patch.pan;
+    s.env.attack = patch.env.attack;
+    s.env.decay = patch.env.decay;
+    s.env.sustain = patch.env.sustain;
+    s.env.release = patch.env.release;
+    s.env.rangeDb = patch.env.rangeDb;
+    s.filter.cutoff = patch.filter.cutoff;
+    s.filter.resonance = patch.filter.resonance;
+    s.filter.drive = patch.filter.drive;
+    s.lfo.rate = patch.lfo.rate;
+    s.lfo.depth = patch.lfo.depth;
+    s.lfo.waveform = patch.lfo.waveform;
+    s.lfo.target = patch.lfo.target;
+    s.lfo.enabled = patch.lfo.enabled;
+    s.unison.voices = std::min(patch.unison.voices, unisonCap); // The stack reconfigures itself on the next render
+    s.unison.detune = patch.unison.detune;
+    s.unison.spread = patch.unison.spread;
+    s.unison.randomPhase = patch.unison.randomPhase;
+    s.fm.copySettings(patch.fm);
+    s.controlInterval = controlInterval;
+}
+
+bool Part::render(float *left, float *right, int frames, float dt)
+{
+    if (count == 0)
+        return false;
+    float l[Synth::MAX_BLOCK], r[Synth::MAX_BLOCK];
+    for (int v = 0; v < count; ++v)
+    {
+        Synth &s = voice[v]->synth;
+        follow(s);
+        if (v == 0)
+        {
+            s.processBlock(left, right, frames, dt);
+            continue;
+        }
+        s.processBlock(l, r, frames, dt);
+        for (int i = 0; i < frames; ++i)
+        {
+            left[i] += l[i];
+            right[i] += r[i];
+        }
+    }
+    return true;
+}
+
+void Part::reap(VoicePool &pool)
+{
+    // Order is kept so the mix sums in the same order whatever the block size
+    int kept = 0;
+    for (int v = 0; v < count; ++v)
+    {
+        if (finished(voice[v]->synth))
+            pool.release(voice[v]);
+        else
+            voice[kept++] = voice[v];
+    }
+    count = kept;
+}
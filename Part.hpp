@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include "Arena.hpp"
+#include "Synth.hpp"
+#include "Tuning.hpp"
+
+// One timbre of the multi-timbral engine: a patch, the MIDI channel it listens
+// on, and the voices currently sounding it. Voices come from a pool shared by
+// every part; a part with no voices is skipped without touching its patch.
+class Part
+{
+public:
+    static constexpr int MAX_VOICES = 8;
+
+    struct Voice
+    {
+        Synth synth;
+        int note = -1;
+        unsigned long age = 0;
+    };
+    using VoicePool = Pool<Voice>;
+
+    // Edited from outside the audio thread. Copied into a voice at note-on;
+    // the settings (not the oscillator state) follow into sounding voices every block.
+    Synth patch;
+    uint8_t channel;
+    int polyphony; // 1..MAX_VOICES. At 1 the part is mono: last note wins and retriggers the sounding voice.
+    bool enabled;
+    // Audio thread, from the engine's quality governor: caps under the patch
+    // settings. New notes steal once voiceCap are sounding.
+    int voiceCap;
+    int unisonCap;
+    int controlInterval; // Frames each LFO value is held for; 1 is every frame
+
+    Part();
+    // Audio thread
+    void noteOn(VoicePool &pool, int note, unsigned long age);
+    void noteOff(int note);
+    void allNotesOff();
+    void setPitchBend(float bend); // -1..1, two semitones each way
+    // Retunes the sounding voices; ones the new table leaves out are released. Not owned.
+    void setTuning(const Tuning *tuning);
+    bool active() const { return count > 0; }
+    int voices() const { return count; }
+    // First voice writes the buffers, the rest add. Returns false, leaving the
+    // buffers untouched, when nothing is sounding. Touches only this part, so
+    // parts can render on different threads.
+    bool render(float *left, float *right, int frames, float dt);
+    // Returns finished voices to the pool; audio thread only
+    void reap(VoicePool &pool);
+    // Envelope idle and filter decayed to exactly zero: the voice adds nothing
+    // from here on, so dropping it cannot change a sample whenever it happens
+    static bool finished(const Synth &s)
+    {
+        return s.env.state == 0 && s.filter.prevSample == 0.0f && s.filter.prevSampleRight == 0.0f;
+    }
+
+private:
+    Voice *voice[MAX_VOICES];
+    int count;
+    float bendRatio; // Frequency multiplier of the current pitch bend
+    const Tuning *tuning;
+
+    void follow(Synth &s) const;
+    void tune(Voice &v) const;
+};
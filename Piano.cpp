@@ -1,8 +1,10 @@
 #include "Piano.hpp"
 
-Piano::Piano() : noteNames{
+const char* const Piano::noteNames[NUM_KEYS] = {
     "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B", "C5", ""
-} {}
+};
+
+Piano::Piano() {}
 
 void Piano::draw(SDL_Renderer* renderer, int x, int y, int width, int height, int activeKey) const {
     int whiteKeyCount = 8;
@@ -66,9 +68,8 @@ int Piano::getKeyAtPosition(int px, int py, int pianoX, int pianoY, int pianoWid
     return -1;
 }
 
-const std::string& Piano::getNoteName(int key) const {
-    if (key >= 0 && key < (int)noteNames.size())
+const char* Piano::getNoteName(int key) const {
+    if (key >= 0 && key < NUM_KEYS)
         return noteNames[key];
-    static std::string empty = "";
-    return empty;
+    return "";
 }
@@ -1,7 +1,5 @@
 #pragma once
 #include <SDL2/SDL.h>
-#include <string>
-#include <vector>
 
 class Piano {
 public:
@@ -9,7 +7,7 @@ public:
     Piano();
     void draw(SDL_Renderer* renderer, int x, int y, int width, int height, int activeKey) const;
     int getKeyAtPosition(int px, int py, int pianoX, int pianoY, int pianoWidth, int pianoHeight) const;
-    const std::string& getNoteName(int key) const;
+    const char* getNoteName(int key) const;
 private:
-    std::vector<std::string> noteNames;
+    static const char* const noteNames[NUM_KEYS];
 };
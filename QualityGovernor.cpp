@@ -0,0 +1,78 @@
+#include "QualityGovernor.hpp"
+#include "Part.hpp"
+#include "Reverb.hpp"
+
+// Cheapest losses first: LFO resolution, then reverb density, then the
+// unison stack, then polyphony
+const QualityGovernor::Level QualityGovernor::LADDER[LEVELS] = {
+    {"full", 1, Unison::MAX_VOICES, Part::MAX_VOICES, Reverb::NUM_COMBS},
+    {"LFO at 1/4 rate", 4, Unison::MAX_VOICES, Part::MAX_VOICES, Reverb::NUM_COMBS},
+    {"reverb 4 combs", 4, Unison::MAX_VOICES, Part::MAX_VOICES, 4},
+    {"unison 4, LFO at 1/16 rate", 16, 4, Part::MAX_VOICES, 4},
+    {"4 voices per part", 16, 4, 4, 4},
+    {"unison off, 2 voices per part", 32, 1, 2, 4},
+};
+
+QualityGovernor::QualityGovernor()
+    : enabled(false), degradeAbove(0.8f), restoreBelow(0.5f), restoreAfter(200), degradations(0), restorations(0),
+      unlogged(0), log(), logWrite(0), logRead(0), current(0), calm(0)
+{
+}
+
+bool QualityGovernor::update(float load, uint64_t time)
+{
+    if (!enabled)
+        return false;
+    int from = current.load(std::memory_order_relaxed);
+    int to = from;
+    if (load > degradeAbove)
+    {
+        calm = 0;
+        if (from + 1 < LEVELS)
+            to = from + 1;
+    }
+    else if (load < restoreBelow && from > 0)
+    {
+        if (++calm >= restoreAfter)
+        {
+            calm = 0;
+            to = from - 1;
+        }
+    }
+    else
+        calm = 0;
+    if (to == from)
+        return false;
+    current.store(to, std::memory_order_relaxed);
+    (to > from ? degradations : restorations).fetch_add(1, std::memory_order_relaxed);
+    record({time, from, to, load});
+    return true;
+}
+
+void QualityGovernor::setLevel(int level)
+{
+    current.store(level < 0 ? 0 : level >= LEVELS ? LEVELS - 1 : level, std::memory_order_relaxed);
+    calm = 0;
+}
+
+void QualityGovernor::record(const Step &step)
+{
+    uint32_t w = logWrite.load(std::memory_order_relaxed);
+    if (w - logRead.load(std::memory_order_acquire) >= LOG_SIZE)
+    {
+        unlogged.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    log[w % LOG_SIZE] = step;
+    logWrite.store(w + 1, std::memory_order_release);
+}
+
+bool QualityGovernor::nextStep(Step &out)
+{
+    uint32_t r = logRead.load(std::memory_order_relaxed);
+    if (r == logWrite.load(std::memory_order_acquire))
+        return false;
+    out = log[r % LOG_SIZE];
+    logRead.store(r + 1, std::memory_order_release);
+    return true;
+}
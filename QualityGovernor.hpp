@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Trades fidelity for headroom when the audio callback runs close to its
+// deadline. The engine times each render against the period it covers: one
+// render above degradeAbove drops a level, and restoreAfter renders in a row
+// below restoreBelow climb one back, so the gap between the two thresholds
+// keeps it from flapping. Every step is counted and queued for the UI to log.
+class QualityGovernor
+{
+public:
+    // What each level allows; later levels give up more
+    struct Level
+    {
+        const char *name;
+        int controlInterval; // Frames the LFO value is held for
+        int unisonVoices;    // Cap on each voice's unison stack
+        int voices;          // Cap on voices per part; sounding voices finish normally
+        int reverbCombs;     // Comb filters per side of the algorithmic reverb
+    };
+    static constexpr int LEVELS = 6;
+    static const Level LADDER[LEVELS];
+
+    struct Step
+    {
+        uint64_t time; // Sample time of the render that decided it
+        int from, to;
+        float load; // Render time over the period it covered
+    };
+
+    // Set while no callback is running
+    bool enabled;
+    float degradeAbove;
+    float restoreBelow;
+    int restoreAfter;
+
+    std::atomic<unsigned long> degradations, restorations;
+    std::atomic<unsigned long> unlogged; // Steps dropped because the UI fell behind
+
+    QualityGovernor();
+    // Audio thread, once per render. True when the level changed.
+    bool update(float load, uint64_t time);
+    // Audio thread, or while no callback is running
+    void setLevel(int level);
+    int level() const { return current.load(std::memory_order_relaxed); }
+    static const Level &settings(int level) { return LADDER[level]; }
+
+    // UI thread: the oldest step not yet read; false when there is none
+    bool nextStep(Step &out);
+
+private:
+    static constexpr uint32_t LOG_SIZE = 64;
+    Step log[LOG_SIZE];
+    std::atomic<uint32_t> logWrite, logRead;
+    std::atomic<int> current;
+    int calm; // Consecutive renders below restoreBelow
+
+    void record(const Step &step);
+};
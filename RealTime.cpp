@@ -0,0 +1,207 @@
+#include "RealTime.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+#if defined(_MSC_VER)
+#define SYNTH_NOINLINE __declspec(noinline)
+#else
+#define SYNTH_NOINLINE __attribute__((noinline))
+#endif
+
+namespace RealTime
+{
+    namespace
+    {
+        constexpr long MAX_CPUS = 1024; // CPU_SETSIZE on Linux
+
+        // Touches the stack pages the thread will grow into, so the first deep
+        // render does not fault them in
+        SYNTH_NOINLINE void prefault(size_t bytes)
+        {
+            [[maybe_unused]] volatile unsigned char stack[MAX_PREFAULT];
+            if (bytes > MAX_PREFAULT)
+                bytes = MAX_PREFAULT;
+            for (size_t i = 0; i < bytes; i += 4096)
+                stack[MAX_PREFAULT - 1 - i] = 0;
+        }
+
+        const char *schedulerName(Scheduler s)
+        {
+            return s == Scheduler::Fifo ? "SCHED_FIFO" : s == Scheduler::RoundRobin ? "SCHED_RR" : "inherited";
+        }
+
+#if defined(__linux__)
+        std::string limit(int resource)
+        {
+            rlimit rl;
+            if (getrlimit(resource, &rl) != 0)
+                return "unknown";
+            if (rl.rlim_cur == RLIM_INFINITY)
+                return "unlimited";
+            return std::to_string((unsigned long long)rl.rlim_cur);
+        }
+#endif
+    }
+
+    Status apply(const ThreadPolicy &policy, int pin)
+    {
+        Status status;
+#if defined(__linux__)
+        if (!policy.cpus.empty())
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (pin >= 0)
+                CPU_SET(policy.cpus[pin % policy.cpus.size()], &set);
+            else
+            {
+                for (int cpu : policy.cpus)
+                    CPU_SET(cpu, &set);
+            }
+            status.affinity = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+        if (policy.scheduler != Scheduler::Inherit)
+        {
+            sched_param param;
+            std::memset(&param, 0, sizeof(param));
+            param.sched_priority = policy.priority;
+            status.scheduler = pthread_setschedparam(pthread_self(),
+                                                     policy.scheduler == Scheduler::Fifo ? SCHED_FIFO : SCHED_RR, &param);
+        }
+#else
+        if (!policy.cpus.empty())
+            status.affinity = ENOSYS;
+        if (policy.scheduler != Scheduler::Inherit)
+            status.scheduler = ENOSYS;
+#endif
+        if (policy.prefaultStack > 0)
+            prefault(policy.prefaultStack);
+        return status;
+    }
+
+    std::string describe(const char *thread, const ThreadPolicy &policy, const Status &status, int pin)
+    {
+        std::ostringstream out;
+        out << thread << ": ";
+        if (!policy.requested())
+            return out.str() + "default scheduling";
+        const char *sep = "";
+        if (policy.scheduler != Scheduler::Inherit)
+        {
+            out << schedulerName(policy.scheduler) << " priority " << policy.priority;
+            if (status.scheduler == 0)
+                out << " granted";
+            else
+            {
+                out << " DENIED (" << std::strerror(status.scheduler) << ")";
+#if defined(__linux__)
+                if (status.scheduler == EPERM)
+                    out << ": RLIMIT_RTPRIO is " << limit(RLIMIT_RTPRIO)
+                        << "; raise it (ulimit -r, limits.conf rtprio) or grant CAP_SYS_NICE";
+                else if (status.scheduler == EINVAL)
+                    out << ": priority must be 1..99";
+#endif
+            }
+            sep = ", ";
+        }
+        if (!policy.cpus.empty())
+        {
+            if (pin >= 0)
+                out << sep << "CPU " << policy.cpus[pin % policy.cpus.size()];
+            else
+            {
+                out << sep << "CPUs";
+                for (size_t i = 0; i < policy.cpus.size(); ++i)
+                    out << (i ? "," : " ") << policy.cpus[i];
+            }
+            if (status.affinity == 0)
+                out << " pinned";
+            else
+                out << " DENIED (" << std::strerror(status.affinity) << ")"
+                    << (status.affinity == EINVAL ? ": no such CPU, or outside this process's cpuset" : "");
+            sep = ", ";
+        }
+        if (policy.prefaultStack > 0)
+            out << sep << std::min(policy.prefaultStack, MAX_PREFAULT) / 1024 << " KB stack prefaulted";
+        return out.str();
+    }
+
+    bool lockMemory(std::string &report)
+    {
+#if defined(__linux__)
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+        {
+            report = "memory locked (current and future mappings)";
+            return true;
+        }
+        int err = errno;
+        report = std::string("mlockall DENIED (") + std::strerror(err) + ")";
+        if (err == ENOMEM || err == EPERM)
+            report += ": RLIMIT_MEMLOCK is " + limit(RLIMIT_MEMLOCK) +
+                      " bytes; raise it (ulimit -l, limits.conf memlock) or grant CAP_IPC_LOCK";
+        return false;
+#else
+        report = "mlockall not supported on this platform";
+        return false;
+#endif
+    }
+
+    bool parseCpus(const std::string &list, std::vector<int> &cpus)
+    {
+        std::vector<int> parsed;
+        std::istringstream in(list);
+        std::string item;
+        while (std::getline(in, item, ','))
+        {
+            size_t dash = item.find('-');
+            char *end = nullptr;
+            long first = std::strtol(item.c_str(), &end, 10);
+            long last = first;
+            if (end == item.c_str() || first < 0)
+                return false;
+            if (dash != std::string::npos)
+            {
+                const char *start = item.c_str() + dash + 1;
+                last = std::strtol(start, &end, 10);
+                if (end == start || last < first)
+                    return false;
+            }
+            if (*end != '\0' || last >= MAX_CPUS)
+                return false;
+            for (long c = first; c <= last; ++c)
+                parsed.push_back((int)c);
+        }
+        if (parsed.empty())
+            return false;
+        cpus = parsed;
+        return true;
+    }
+
+    void Deferred::set(const ThreadPolicy &p)
+    {
+        policy = p;
+        state.store(p.requested() ? Pending : Idle, std::memory_order_release);
+    }
+
+    bool Deferred::applied(Status &out) const
+    {
+        if (state.load(std::memory_order_acquire) != Done)
+            return false;
+        out = status;
+        return true;
+    }
+
+    void Deferred::applyNow()
+    {
+        status = apply(policy);
+        state.store(Done, std::memory_order_release);
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Scheduling, CPU pinning and memory locking for the threads that render
+// audio. Everything is opt-in and best effort: a request the system denies
+// (no CAP_SYS_NICE, RLIMIT_RTPRIO or RLIMIT_MEMLOCK too low) leaves that
+// thread as it was, and describe() says what was refused and which limit to
+// raise. Linux only; elsewhere every request reports ENOSYS.
+namespace RealTime
+{
+    enum class Scheduler
+    {
+        Inherit, // Leave whatever the creator chose
+        Fifo,
+        RoundRobin
+    };
+
+    struct ThreadPolicy
+    {
+        Scheduler scheduler = Scheduler::Inherit;
+        int priority = 70;          // 1..99, used with Fifo and RoundRobin
+        std::vector<int> cpus;      // Empty leaves the affinity alone
+        size_t prefaultStack = 0;   // Bytes of stack to touch up front, at most MAX_PREFAULT
+        bool requested() const { return scheduler != Scheduler::Inherit || !cpus.empty() || prefaultStack > 0; }
+    };
+
+    constexpr size_t MAX_PREFAULT = 512 * 1024;
+
+    // errno of each request, 0 when granted or not asked for
+    struct Status
+    {
+        int scheduler = 0;
+        int affinity = 0;
+    };
+
+    // Applies policy to the calling thread. With pin >= 0 the thread gets the
+    // single CPU cpus[pin % size], so a pool of workers spreads over the list.
+    // Makes system calls but does not allocate.
+    Status apply(const ThreadPolicy &policy, int pin = -1);
+    // One line per thread; pass the same pin that apply() got
+    std::string describe(const char *thread, const ThreadPolicy &policy, const Status &status, int pin = -1);
+
+    // mlockall(MCL_CURRENT | MCL_FUTURE): everything mapped now and later stays
+    // resident. The engine arena is already touched, so this pins it too.
+    bool lockMemory(std::string &report);
+
+    // "2", "2,3" or "4-7"; false on anything else
+    bool parseCpus(const std::string &list, std::vector<int> &cpus);
+
+    // For a thread we do not create, such as the host's audio callback thread:
+    // the UI sets a policy before the stream starts and the callback calls
+    // applyOnce() first thing, outside its real-time scope. Costs one branch
+    // after the first call.
+    class Deferred
+    {
+    public:
+        Deferred() : state(Idle) {}
+        void set(const ThreadPolicy &p); // UI thread, no callback running
+        void applyOnce()
+        {
+            if (state.load(std::memory_order_acquire) == Pending)
+                applyNow();
+        }
+        // UI thread: true after the policy has been applied, with what came of it
+        bool applied(Status &out) const;
+        const ThreadPolicy &get() const { return policy; }
+
+    private:
+        enum State : int
+        {
+            Idle,
+            Pending,
+            Done
+        };
+        ThreadPolicy policy;
+        Status status;
+        std::atomic<int> state;
+        void applyNow();
+    };
+}
@@ -0,0 +1,198 @@
+#include "Recorder.hpp"
+#include "Stereo.hpp"
+#include "WavFile.hpp"
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // A RIFF size field is 32 bits
+    const uint64_t MAX_FRAMES = (0xFFFFFFFFull - 36) / (2 * sizeof(float));
+
+    bool resize(std::FILE *file, uint64_t bytes, bool reserve)
+    {
+#ifdef _WIN32
+        (void)reserve;
+        return _chsize_s(_fileno(file), (long long)bytes) == 0;
+#elif defined(__linux__)
+        if (reserve)
+            return posix_fallocate(fileno(file), 0, (off_t)bytes) == 0;
+        return ftruncate(fileno(file), (off_t)bytes) == 0;
+#else
+        (void)reserve;
+        return ftruncate(fileno(file), (off_t)bytes) == 0;
+#endif
+    }
+}
+
+Recorder::Recorder()
+    : overruns(0), droppedFrames(0), ringFrames(0), writePos(0), readPos(0), active(false), busy(false),
+      running(false), file(nullptr), sampleRate(0), framesWritten(0), preallocatedBytes(0), writeFailed(false) {}
+
+Recorder::~Recorder()
+{
+    std::string error;
+    stop(error);
+}
+
+bool Recorder::start(const std::string &filePath, int rate, std::string &error, double preallocateSeconds)
+{
+    if (file)
+    {
+        error = "already recording to " + path;
+        return false;
+    }
+
+    // Power-of-two ring so positions wrap with a mask
+    uint64_t frames = 1;
+    while (frames < (uint64_t)rate * RING_SECONDS)
+        frames <<= 1;
+    if (frames != ringFrames)
+    {
+        ring.assign(frames * 2, 0.0f);
+        ringFrames = frames;
+    }
+
+    file = std::fopen(filePath.c_str(), "wb");
+    if (!file)
+    {
+        error = "cannot create " + filePath;
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IONBF, 0); // Chunks are already large; skip the stdio copy
+    path = filePath;
+    sampleRate = rate;
+    framesWritten = 0;
+    preallocatedBytes = 0;
+    writeFailed = false;
+
+    // Placeholder sizes, patched in finish()
+    unsigned char header[WavFile::HEADER_BYTES];
+    WavFile::writeHeader(header, 2, sampleRate, 0);
+    std::fwrite(header, 1, sizeof(header), file);
+    if (preallocateSeconds > 0.0)
+    {
+        uint64_t reserve = std::min<uint64_t>((uint64_t)(preallocateSeconds * sampleRate), MAX_FRAMES);
+        uint64_t bytes = WavFile::HEADER_BYTES + reserve * 2 * sizeof(float);
+        std::fflush(file);
+        if (resize(file, bytes, true))
+            preallocatedBytes = bytes;
+    }
+
+    writePos.store(0);
+    readPos.store(0);
+    overruns.store(0);
+    droppedFrames.store(0);
+    running.store(true);
+    writerThread = std::thread(&Recorder::writerLoop, this);
+    active.store(true);
+    return true;
+}
+
+bool Recorder::stop(std::string &error)
+{
+    if (!file)
+        return true;
+
+    // Once the audio thread is seen outside push it cannot enter it again
+    active.store(false);
+    while (busy.load())
+        std::this_thread::yield();
+
+    running.store(false);
+    if (writerThread.joinable())
+        writerThread.join();
+    write(writePos.load() - readPos.load());
+    return finish(error);
+}
+
+double Recorder::seconds() const
+{
+    return sampleRate > 0 ? (double)writePos.load(std::memory_order_relaxed) / sampleRate : 0.0;
+}
+
+void Recorder::push(const float *left, const float *right, int frames)
+{
+    busy.store(true);
+    if (!active.load())
+    {
+        busy.store(false);
+        return;
+    }
+
+    uint64_t w = writePos.load(std::memory_order_relaxed);
+    uint64_t r = readPos.load(std::memory_order_acquire);
+    if (w + frames - r > ringFrames)
+    {
+        // Whole blocks are dropped so the file never holds a torn frame
+        overruns.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames.fetch_add(frames, std::memory_order_relaxed);
+        busy.store(false);
+        return;
+    }
+
+    uint64_t start = w & (ringFrames - 1);
+    int first = (int)std::min<uint64_t>(frames, ringFrames - start);
+    Stereo::interleave(left, right, ring.data() + start * 2, first);
+    if (first < frames)
+        Stereo::interleave(left + first, right + first, ring.data(), frames - first);
+    writePos.store(w + frames, std::memory_order_release);
+    busy.store(false);
+}
+
+void Recorder::writerLoop()
+{
+    while (running)
+    {
+        uint64_t available = writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_relaxed);
+        if (available >= (uint64_t)WRITE_FRAMES)
+            write(available - available % WRITE_FRAMES);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void Recorder::write(uint64_t frames)
+{
+    uint64_t r = readPos.load(std::memory_order_relaxed);
+    uint64_t keep = std::min(frames, MAX_FRAMES - std::min(framesWritten, MAX_FRAMES));
+    for (uint64_t done = 0; done < keep && !writeFailed;)
+    {
+        // Up to the end of the ring, then from its start
+        uint64_t start = (r + done) & (ringFrames - 1);
+        uint64_t n = std::min(keep - done, ringFrames - start);
+        size_t count = (size_t)n * 2;
+        writeFailed = std::fwrite(ring.data() + start * 2, sizeof(float), count, file) != count;
+        done += n;
+    }
+    if (!writeFailed)
+        framesWritten += keep;
+    if (keep < frames)
+        droppedFrames.fetch_add(frames - keep, std::memory_order_relaxed); // Past the WAV size limit
+    readPos.store(r + frames, std::memory_order_release);
+}
+
+bool Recorder::finish(std::string &error)
+{
+    uint64_t dataBytes = framesWritten * 2 * sizeof(float);
+    std::fflush(file);
+    if (preallocatedBytes > WavFile::HEADER_BYTES + dataBytes)
+        resize(file, WavFile::HEADER_BYTES + dataBytes, false);
+
+    unsigned char header[WavFile::HEADER_BYTES];
+    WavFile::writeHeader(header, 2, sampleRate, (uint32_t)dataBytes);
+    std::fseek(file, 0, SEEK_SET);
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header) && !writeFailed;
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    if (!ok)
+        error = "write failed for " + path;
+    return ok;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Captures the engine output to a 32-bit float stereo WAV. The audio thread
+// only interleaves each block into a lock-free ring; a writer thread drains the
+// ring to disk in WRITE_FRAMES chunks. When the ring is full the block is
+// dropped and counted, never waited on.
+class Recorder
+{
+public:
+    static constexpr int RING_SECONDS = 4;      // Disk stall the ring can absorb
+    static constexpr int WRITE_FRAMES = 32768;  // Frames per sequential write (256 KB)
+
+    std::atomic<unsigned long> overruns;      // Blocks dropped because the ring was full
+    std::atomic<uint64_t> droppedFrames;
+
+    Recorder();
+    ~Recorder();
+    // UI thread. preallocateSeconds > 0 reserves that much file space up front so the
+    // file system does not have to extend the file on every write.
+    bool start(const std::string &path, int sampleRate, std::string &error, double preallocateSeconds = 0.0);
+    // Writes out what is still buffered and finalises the header
+    bool stop(std::string &error);
+    bool recording() const { return active.load(); }
+    double seconds() const; // Captured so far
+    const std::string &filePath() const { return path; }
+
+    // Audio thread
+    void push(const float *left, const float *right, int frames);
+
+private:
+    std::vector<float> ring; // Interleaved stereo
+    uint64_t ringFrames;
+    std::atomic<uint64_t> writePos; // Frames pushed, audio thread
+    std::atomic<uint64_t> readPos;  // Frames taken, writer thread
+    std::atomic<bool> active;       // Audio thread may push
+    std::atomic<bool> busy;         // Audio thread is inside push
+    std::atomic<bool> running;      // Writer thread keeps going
+
+    std::thread writerThread;
+    std::FILE *file;
+    std::string path;
+    int sampleRate;
+    uint64_t framesWritten;
+    uint64_t preallocatedBytes;
+    bool writeFailed;
+
+    void writerLoop();
+    void write(uint64_t frames);
+    bool finish(std::string &error);
+};
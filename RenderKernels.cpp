@@ -0,0 +1,256 @@
+#include "RenderKernels.hpp"
+#include "Synth.hpp"
+#include "Stereo.hpp"
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <cmath>
+#include "FastMath.hpp"
+
+namespace
+{
+    template <WaveForm::Type Wave, LFOTarget Target, WaveForm::Type LfoWave, typename Sample>
+    void renderKernel(Synth &s, Sample *out, Sample *outRight, int frames, float dt)
+    {
+        const float twoPi = 2.0f * (float)M_PI;
+
+        // The envelope is stepped into its own buffer so the main loop below has no calls
+        float envBuf[Synth::MAX_BLOCK];
+        s.env.processBlock(envBuf, frames, dt);
+
+        float phase = s.phase;
+        float lfoPhase = s.lfo.phase;
+        float prev = s.filter.prevSample;
+        float prevRight = s.filter.prevSampleRight;
+        float cutoff = s.filter.cutoff;
+        const float inc = s.baseFrequency * dt * twoPi;
+        const float lfoInc = s.lfo.rate * dt * twoPi;
+        const float depth = s.lfo.depth;
+        const float amplitude = s.amplitude;
+        const float baseCutoff = s.baseCutoff;
+        float alpha = cutoff / (cutoff + 1.0f);
+
+        // Above 1, the LFO and the vibrato multiplier are evaluated every
+        // `interval` frames and held between, counting from the block start
+        const int interval = s.controlInterval;
+        float lfoBuf[Synth::MAX_BLOCK];
+        if constexpr (Target != LFOTarget::None)
+        {
+            if (interval <= 1)
+            {
+                for (int i = 0; i < frames; ++i)
+                {
+                    lfoPhase += lfoInc;
+                    if (lfoPhase >= twoPi)
+                        lfoPhase -= twoPi;
+                    lfoBuf[i] = WaveForm::generate<LfoWave, true>(lfoPhase) * depth;
+                }
+            }
+            else
+            {
+                for (int start = 0; start < frames; start += interval)
+                {
+                    int end = std::min(start + interval, frames);
+                    lfoPhase += lfoInc;
+                    if (lfoPhase >= twoPi)
+                        lfoPhase -= twoPi;
+                    float value = WaveForm::generate<LfoWave, true>(lfoPhase) * depth;
+                    lfoPhase += lfoInc * (end - start - 1);
+                    while (lfoPhase >= twoPi)
+                        lfoPhase -= twoPi;
+                    std::fill(lfoBuf + start, lfoBuf + end, value);
+                }
+            }
+        }
+
+        float oscBuf[Synth::MAX_BLOCK];
+        float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+        const bool fm = s.fm.enabled;
+        const bool stack = !fm && s.unison.voices > 1;
+        float pitchMul[Synth::MAX_BLOCK];
+        if constexpr (Target == LFOTarget::Pitch)
+        {
+            if (interval > 1)
+            {
+                for (int start = 0; start < frames; start += interval)
+                {
+                    int end = std::min(start + interval, frames);
+                    std::fill(pitchMul + start, pitchMul + end,
+                              FastMath::exp2<FastMath::Precision::Balanced>(lfoBuf[start] * Synth::VIBRATO_OCTAVES));
+                }
+            }
+            else if (fm || stack)
+            {
+                for (int i = 0; i < frames; ++i)
+                    pitchMul[i] = FastMath::exp2<FastMath::Precision::Balanced>(lfoBuf[i] * Synth::VIBRATO_OCTAVES);
+            }
+        }
+        if (fm)
+        {
+            s.fm.render(oscBuf, frames, s.baseFrequency * dt, dt, Target == LFOTarget::Pitch ? pitchMul : nullptr);
+        }
+        else if (stack)
+        {
+            s.unison.render<Wave>(left, right, frames, s.baseFrequency * dt,
+                                  Target == LFOTarget::Pitch ? pitchMul : nullptr);
+            // Mono output gets the stack folded to its mid signal
+            if (!outRight)
+            {
+                for (int i = 0; i < frames; ++i)
+                    oscBuf[i] = 0.5f * (left[i] + right[i]);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                if constexpr (Target == LFOTarget::Pitch)
+                    phase += inc * (interval > 1 ? pitchMul[i] : FastMath::exp2<FastMath::Precision::Balanced>(lfoBuf[i] * Synth::VIBRATO_OCTAVES));
+                else
+                    phase += inc;
+                if (phase >= twoPi)
+                    phase -= twoPi;
+                oscBuf[i] = WaveForm::generate<Wave>(phase);
+            }
+        }
+
+        // Gain and cutoff per frame; the stereo stack runs the filter once per side
+        float gainBuf[Synth::MAX_BLOCK], alphaBuf[Synth::MAX_BLOCK];
+        for (int i = 0; i < frames; ++i)
+        {
+            float amp = amplitude;
+            if constexpr (Target == LFOTarget::Amplitude)
+                amp = std::fmax(amplitude * (1.0f + lfoBuf[i] * 0.5f), 0.0f);
+
+            if constexpr (Target == LFOTarget::Filter)
+            {
+                cutoff = std::fmin(std::fmax(baseCutoff * (1.0f + lfoBuf[i] * 0.8f), 100.0f), 8000.0f);
+                alpha = cutoff / (cutoff + 1.0f);
+            }
+            gainBuf[i] = amp * envBuf[i];
+            alphaBuf[i] = alpha;
+        }
+
+        // Drive folds the gain into the signal ahead of the filter, as Filter::process does
+        if (s.filter.drive > 0.0f)
+        {
+            float k, norm;
+            s.filter.driveCurve(k, norm);
+            for (int i = 0; i < frames; ++i)
+            {
+                if (stack && outRight)
+                {
+                    left[i] = Filter::saturate(left[i] * gainBuf[i], k, norm);
+                    right[i] = Filter::saturate(right[i] * gainBuf[i], k, norm);
+                }
+                else
+                    oscBuf[i] = Filter::saturate(oscBuf[i] * gainBuf[i], k, norm);
+                gainBuf[i] = 1.0f;
+            }
+        }
+
+        if (stack && outRight)
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                prev = alphaBuf[i] * (left[i] * gainBuf[i]) + (1.0f - alphaBuf[i]) * prev;
+                prevRight = alphaBuf[i] * (right[i] * gainBuf[i]) + (1.0f - alphaBuf[i]) * prevRight;
+                left[i] = prev;
+                right[i] = prevRight;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                prev = alphaBuf[i] * (oscBuf[i] * gainBuf[i]) + (1.0f - alphaBuf[i]) * prev;
+                left[i] = prev;
+            }
+            if (outRight)
+                std::copy(left, left + frames, right);
+        }
+
+        if (!outRight)
+        {
+            for (int i = 0; i < frames; ++i)
+                out[i] = static_cast<Sample>(left[i]);
+        }
+        else if (s.pan == 0.0f)
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                out[i] = static_cast<Sample>(left[i]);
+                outRight[i] = static_cast<Sample>(right[i]);
+            }
+        }
+        else
+        {
+            float gainL, gainR;
+            Stereo::panGains(s.pan, gainL, gainR);
+            for (int i = 0; i < frames; ++i)
+            {
+                out[i] = static_cast<Sample>(left[i] * gainL);
+                outRight[i] = static_cast<Sample>(right[i] * gainR);
+            }
+        }
+
+        s.phase = phase;
+        s.filter.prevSample = prev;
+        s.filter.prevSampleRight = stack ? prevRight : prev;
+        if constexpr (Target != LFOTarget::None)
+            s.lfo.phase = lfoPhase;
+        if constexpr (Target == LFOTarget::Filter)
+            s.filter.setCutoff(cutoff);
+    }
+
+    // Table index = wave * 16 + target * 4 + lfoWave
+    template <typename Sample, int... I>
+    constexpr std::array<RenderKernel<Sample>, sizeof...(I)> makeTable(std::integer_sequence<int, I...>)
+    {
+        return {{&renderKernel<static_cast<WaveForm::Type>(I / (RenderKernels::NUM_TARGETS * RenderKernels::NUM_WAVES)),
+                               static_cast<LFOTarget>((I / RenderKernels::NUM_WAVES) % RenderKernels::NUM_TARGETS),
+                               static_cast<WaveForm::Type>(I % RenderKernels::NUM_WAVES),
+                               Sample>...}};
+    }
+
+    template <typename Sample>
+    constexpr auto kernelTable = makeTable<Sample>(std::make_integer_sequence<int, RenderKernels::NUM_KERNELS>{});
+}
+
+template <typename Sample>
+RenderKernel<Sample> RenderKernels::select(WaveForm::Type wave, LFOTarget target, WaveForm::Type lfoWave)
+{
+    int index = (static_cast<int>(wave) * NUM_TARGETS + static_cast<int>(target)) * NUM_WAVES + static_cast<int>(lfoWave);
+    return kernelTable<Sample>[index];
+}
+
+template <typename Sample>
+void Synth::processBlock(Sample *out, int frames, float dt)
+{
+    processBlock<Sample>(out, nullptr, frames, dt);
+}
+
+template <typename Sample>
+void Synth::processBlock(Sample *left, Sample *right, int frames, float dt)
+{
+    // A disabled LFO renders exactly like LFOTarget::None, so it shares that kernel
+    LFOTarget target = lfo.enabled ? lfo.target : LFOTarget::None;
+    RenderKernel<Sample> kernel = RenderKernels::select<Sample>(waveType, target, lfo.waveform);
+
+    while (frames > 0)
+    {
+        int n = frames < MAX_BLOCK ? frames : MAX_BLOCK;
+        kernel(*this, left, right, n, dt);
+        left += n;
+        if (right)
+            right += n;
+        frames -= n;
+    }
+}
+
+template RenderKernel<float> RenderKernels::select<float>(WaveForm::Type, LFOTarget, WaveForm::Type);
+template RenderKernel<double> RenderKernels::select<double>(WaveForm::Type, LFOTarget, WaveForm::Type);
+template void Synth::processBlock<float>(float *, int, float);
+template void Synth::processBlock<double>(double *, int, float);
+template void Synth::processBlock<float>(float *, float *, int, float);
+template void Synth::processBlock<double>(double *, double *, int, float);
@@ -0,0 +1,21 @@
+#pragma once
+#include "WaveForm.hpp"
+#include "LFO.hpp"
+
+class Synth;
+
+// Block renderers specialised at compile time on oscillator shape, LFO target and
+// LFO shape, so the per-sample loop carries no switches. One table per sample type.
+// With right == nullptr the kernel renders mono into left (the stereo stack folded to mid).
+template <typename Sample>
+using RenderKernel = void (*)(Synth &synth, Sample *left, Sample *right, int frames, float dt);
+
+namespace RenderKernels
+{
+    constexpr int NUM_WAVES = 4;
+    constexpr int NUM_TARGETS = 4;
+    constexpr int NUM_KERNELS = NUM_WAVES * NUM_TARGETS * NUM_WAVES;
+
+    template <typename Sample>
+    RenderKernel<Sample> select(WaveForm::Type wave, LFOTarget target, WaveForm::Type lfoWave);
+}
@@ -0,0 +1,269 @@
+#include "Resampler.hpp"
+#include "Simd.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr double KAISER_BETA = 8.6; // About 86 dB of stopband
+    constexpr int MAX_TAPS = 256;
+    constexpr int INTERPOLATION_BITS = 32;
+    constexpr int PHASE_SHIFT = INTERPOLATION_BITS - 8; // log2(INTERPOLATED_PHASES) = 8
+
+    // Zeroth-order modified Bessel function, for the Kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50 && term > 1e-12 * sum; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    uint64_t gcd(uint64_t a, uint64_t b)
+    {
+        while (b)
+        {
+            uint64_t t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    // Both channels against one row of coefficients
+    inline void dot(const float *c, const float *l, const float *r, int taps, float &outL, float &outR)
+    {
+        int k = 0;
+        float sumL = 0.0f, sumR = 0.0f;
+#if defined(SYNTH_SSE2)
+        __m128 al = _mm_setzero_ps(), ar = _mm_setzero_ps();
+        for (; k + 4 <= taps; k += 4)
+        {
+            __m128 ck = _mm_loadu_ps(c + k);
+            al = _mm_add_ps(al, _mm_mul_ps(ck, _mm_loadu_ps(l + k)));
+            ar = _mm_add_ps(ar, _mm_mul_ps(ck, _mm_loadu_ps(r + k)));
+        }
+        // Lanes 0+1+2+3 of al into lane 0 and of ar into lane 1
+        __m128 lo = _mm_unpacklo_ps(al, ar), hi = _mm_unpackhi_ps(al, ar);
+        __m128 s = _mm_add_ps(lo, hi);
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        sumL = _mm_cvtss_f32(s);
+        sumR = _mm_cvtss_f32(_mm_shuffle_ps(s, s, 1));
+#elif defined(SYNTH_NEON)
+        float32x4_t al = vdupq_n_f32(0.0f), ar = vdupq_n_f32(0.0f);
+        for (; k + 4 <= taps; k += 4)
+        {
+            float32x4_t ck = vld1q_f32(c + k);
+            al = vmlaq_f32(al, ck, vld1q_f32(l + k));
+            ar = vmlaq_f32(ar, ck, vld1q_f32(r + k));
+        }
+        float32x2_t pl = vadd_f32(vget_low_f32(al), vget_high_f32(al));
+        float32x2_t pr = vadd_f32(vget_low_f32(ar), vget_high_f32(ar));
+        float32x2_t s = vpadd_f32(pl, pr);
+        sumL = vget_lane_f32(s, 0);
+        sumR = vget_lane_f32(s, 1);
+#endif
+        for (; k < taps; ++k)
+        {
+            sumL += c[k] * l[k];
+            sumR += c[k] * r[k];
+        }
+        outL = sumL;
+        outR = sumR;
+    }
+
+    // The same with the row blended towards the next one by w
+    inline void dotBlend(const float *c0, const float *c1, float w, const float *l, const float *r, int taps,
+                         float &outL, float &outR)
+    {
+        int k = 0;
+        float sumL = 0.0f, sumR = 0.0f;
+#if defined(SYNTH_SSE2)
+        __m128 al = _mm_setzero_ps(), ar = _mm_setzero_ps(), wv = _mm_set1_ps(w);
+        for (; k + 4 <= taps; k += 4)
+        {
+            __m128 a = _mm_loadu_ps(c0 + k);
+            __m128 ck = _mm_add_ps(a, _mm_mul_ps(wv, _mm_sub_ps(_mm_loadu_ps(c1 + k), a)));
+            al = _mm_add_ps(al, _mm_mul_ps(ck, _mm_loadu_ps(l + k)));
+            ar = _mm_add_ps(ar, _mm_mul_ps(ck, _mm_loadu_ps(r + k)));
+        }
+        __m128 lo = _mm_unpacklo_ps(al, ar), hi = _mm_unpackhi_ps(al, ar);
+        __m128 s = _mm_add_ps(lo, hi);
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        sumL = _mm_cvtss_f32(s);
+        sumR = _mm_cvtss_f32(_mm_shuffle_ps(s, s, 1));
+#elif defined(SYNTH_NEON)
+        float32x4_t al = vdupq_n_f32(0.0f), ar = vdupq_n_f32(0.0f);
+        for (; k + 4 <= taps; k += 4)
+        {
+            float32x4_t a = vld1q_f32(c0 + k);
+            float32x4_t ck = vmlaq_n_f32(a, vsubq_f32(vld1q_f32(c1 + k), a), w);
+            al = vmlaq_f32(al, ck, vld1q_f32(l + k));
+            ar = vmlaq_f32(ar, ck, vld1q_f32(r + k));
+        }
+        float32x2_t pl = vadd_f32(vget_low_f32(al), vget_high_f32(al));
+        float32x2_t pr = vadd_f32(vget_low_f32(ar), vget_high_f32(ar));
+        float32x2_t s = vpadd_f32(pl, pr);
+        sumL = vget_lane_f32(s, 0);
+        sumR = vget_lane_f32(s, 1);
+#endif
+        for (; k < taps; ++k)
+        {
+            float ck = c0[k] + w * (c1[k] - c0[k]);
+            sumL += ck * l[k];
+            sumR += ck * r[k];
+        }
+        outL = sumL;
+        outR = sumR;
+    }
+}
+
+Resampler::Resampler()
+    : inputRate(1.0), outputRate(1.0), tapCount(0), phaseCount(0), interpolate(false), den(1), step(1), frac(0),
+      base(0), filled(0), shifted(0), maxPull(1)
+{
+}
+
+bool Resampler::configure(double inRate, double outRate, int taps, float cutoff, std::string &error)
+{
+    if (!(inRate > 0.0) || !(outRate > 0.0) || outRate / inRate > 16.0 || inRate / outRate > 16.0)
+    {
+        error = "unsupported rates " + std::to_string(inRate) + " -> " + std::to_string(outRate);
+        return false;
+    }
+    if (taps < 4 || taps > MAX_TAPS || !(cutoff > 0.0f && cutoff < 1.0f))
+    {
+        error = "taps must be 4.." + std::to_string(MAX_TAPS) + " and cutoff between 0 and 1";
+        return false;
+    }
+    inputRate = inRate;
+    outputRate = outRate;
+    tapCount = (taps + 3) / 4 * 4;
+
+    // Integer rates reduce to out/in = L/M: L phases, M / L frames per output
+    interpolate = true;
+    if (inRate == std::floor(inRate) && outRate == std::floor(outRate))
+    {
+        uint64_t g = gcd((uint64_t)inRate, (uint64_t)outRate);
+        uint64_t l = (uint64_t)outRate / g, m = (uint64_t)inRate / g;
+        if (l <= (uint64_t)MAX_PHASES)
+        {
+            interpolate = false;
+            phaseCount = (int)l;
+            den = l;
+            step = m;
+        }
+    }
+    if (interpolate)
+    {
+        phaseCount = INTERPOLATED_PHASES;
+        den = (uint64_t)1 << INTERPOLATION_BITS;
+        step = (uint64_t)std::llround(inRate / outRate * (double)den);
+    }
+
+    // Row p is the kernel at fraction p / phases past the newest input frame.
+    // Tap k reads frame newest - (taps - 1) + k, and the kernel is centred
+    // taps / 2 frames back, which is the latency.
+    const double fc = cutoff * std::min(1.0, outRate / inRate);
+    const double half = tapCount / 2.0;
+    const int rows = phaseCount + (interpolate ? 1 : 0);
+    bank.assign((size_t)rows * tapCount, 0.0f);
+    for (int p = 0; p < rows; ++p)
+    {
+        double f = (double)p / phaseCount, sum = 0.0;
+        std::vector<double> row(tapCount);
+        for (int k = 0; k < tapCount; ++k)
+        {
+            double t = f + half - 1.0 - k;
+            double x = t / half;
+            double window = std::fabs(x) < 1.0 ? besselI0(KAISER_BETA * std::sqrt(1.0 - x * x)) / besselI0(KAISER_BETA) : 0.0;
+            double sinc = t == 0.0 ? 1.0 : std::sin(M_PI * fc * t) / (M_PI * fc * t);
+            row[k] = fc * sinc * window;
+            sum += row[k];
+        }
+        // Unity gain at DC on every phase
+        for (int k = 0; k < tapCount; ++k)
+            bank[(size_t)p * tapCount + k] = (float)(row[k] / sum);
+    }
+
+    left.assign(BLOCK + 2 * tapCount, 0.0f);
+    right.assign(BLOCK + 2 * tapCount, 0.0f);
+    maxPull = (int)((uint64_t)(BLOCK - 1) * den / step) + 1;
+    reset();
+    return true;
+}
+
+void Resampler::reset()
+{
+    std::fill(left.begin(), left.end(), 0.0f);
+    std::fill(right.begin(), right.end(), 0.0f);
+    frac = 0;
+    base = 0;
+    filled = tapCount - 1; // Silence before the first frame
+    shifted = 0;
+}
+
+void Resampler::compact()
+{
+    shifted = base;
+    if (base == 0)
+        return;
+    int keep = filled - base;
+    std::memmove(left.data(), left.data() + base, keep * sizeof(float));
+    std::memmove(right.data(), right.data() + base, keep * sizeof(float));
+    filled = keep;
+    base = 0;
+}
+
+int Resampler::process(const float *inLeft, const float *inRight, int frames, float *outLeft, float *outRight)
+{
+    int written = 0;
+    for (int done = 0; done < frames;)
+    {
+        int n = std::min(frames - done, BLOCK);
+        compact();
+        std::memcpy(left.data() + filled, inLeft + done, n * sizeof(float));
+        std::memcpy(right.data() + filled, inRight + done, n * sizeof(float));
+        filled += n;
+        done += n;
+        // Outputs whose newest frame, base + (frac + k step) / den + taps - 1, is now held
+        int room = filled - tapCount - base;
+        if (room < 0)
+            continue;
+        int ready = (int)(((uint64_t)(room + 1) * den - frac + step - 1) / step);
+        convert(outLeft + written, outRight + written, ready);
+        written += ready;
+    }
+    return written;
+}
+
+void Resampler::convert(float *outLeft, float *outRight, int frames)
+{
+    const float *l = left.data(), *r = right.data();
+    const float blend = 1.0f / (float)((uint64_t)1 << PHASE_SHIFT);
+    for (int i = 0; i < frames; ++i)
+    {
+        if (interpolate)
+        {
+            const float *c = bank.data() + (size_t)(frac >> PHASE_SHIFT) * tapCount;
+            float w = (float)(frac & (((uint64_t)1 << PHASE_SHIFT) - 1)) * blend;
+            dotBlend(c, c + tapCount, w, l + base, r + base, tapCount, outLeft[i], outRight[i]);
+            frac += step;
+            base += (int)(frac >> INTERPOLATION_BITS);
+            frac &= den - 1;
+        }
+        else
+        {
+            dot(bank.data() + (size_t)frac * tapCount, l + base, r + base, tapCount, outLeft[i], outRight[i]);
+            frac += step;
+            while (frac >= den)
+            {
+                frac -= den;
+                ++base;
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Polyphase FIR sample rate converter for stereo. configure() designs a bank
+// of Kaiser-windowed sinc phases once, on the UI thread; converting is then a
+// SIMD dot product per output frame against a phase picked from the bank. A
+// ratio of integer rates whose reduced output side fits MAX_PHASES gets one
+// exact phase per position (44.1 <-> 48 kHz, 2x up and down); any other ratio
+// blends the two nearest of INTERPOLATED_PHASES phases. The output lags the
+// input by latency() input frames, whatever the ratio.
+class Resampler
+{
+public:
+    static constexpr int MAX_PHASES = 1024;
+    static constexpr int INTERPOLATED_PHASES = 256;
+    static constexpr int BLOCK = 256; // Most input frames taken at once
+
+    Resampler();
+    // UI thread, while nothing converts. Taps are rounded up to a multiple of
+    // 4; cutoff is the passband edge as a fraction of the lower Nyquist.
+    bool configure(double inRate, double outRate, int taps, float cutoff, std::string &error);
+    // Clears the history; the next output is the first after configure()
+    void reset();
+
+    bool configured() const { return !bank.empty(); }
+    bool exact() const { return !interpolate; }
+    int phases() const { return phaseCount; }
+    int taps() const { return tapCount; }
+    double ratio() const { return outputRate / inputRate; }
+    int latency() const { return tapCount / 2; } // Input frames
+    double latencySeconds() const { return latency() / inputRate; }
+
+    // Push: takes all `frames`, writes every output they complete and returns
+    // how many. out must hold maxOutput(frames).
+    int process(const float *inLeft, const float *inRight, int frames, float *outLeft, float *outRight);
+    int maxOutput(int frames) const { return (int)(((uint64_t)frames * den + step - 1) / step) + 1; }
+
+    // Pull: writes exactly `frames` outputs, calling render(left, right, n) for
+    // the input they need and no more. Audio thread; never allocates.
+    template <typename Render>
+    void pull(float *outLeft, float *outRight, int frames, Render &&render)
+    {
+        int done = 0;
+        while (done < frames)
+        {
+            int n = std::min(frames - done, maxPull);
+            int end = base + (int)((frac + (uint64_t)(n - 1) * step) / den) + tapCount;
+            if (end > filled)
+            {
+                compact();
+                end -= shifted;
+                render(left.data() + filled, right.data() + filled, end - filled);
+                filled = end;
+            }
+            convert(outLeft + done, outRight + done, n);
+            done += n;
+        }
+    }
+
+private:
+    std::vector<float> bank; // phaseCount rows of tapCount coefficients, plus one for interpolation
+    std::vector<float> left, right; // Input history and what has been taken since
+    double inputRate, outputRate;
+    int tapCount, phaseCount;
+    bool interpolate;
+    uint64_t den, step; // Input advances step / den frames per output
+    uint64_t frac;      // Position between input frames, in 1 / den
+    int base;           // First input frame under the filter for the next output
+    int filled;         // Frames held in left and right
+    int shifted;        // Frames the last compact() dropped
+    int maxPull;        // Outputs per pull step, so one step never needs more than BLOCK new frames
+
+    void compact();
+    void convert(float *outLeft, float *outRight, int frames);
+};
@@ -0,0 +1,119 @@
+#include "Reverb.hpp"
+
+namespace
+{
+    // Tunings at 44.1 kHz, scaled to the running rate in prepare()
+    const int combTuning[Reverb::NUM_COMBS] = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+    const int allpassTuning[Reverb::NUM_ALLPASSES] = {556, 441, 341, 225};
+    const int stereoSpread = 23;
+    const float inputGain = 0.015f;
+
+    int scaled(int samples, float sampleRate)
+    {
+        return (int)(samples * sampleRate / 44100.0f) + 1;
+    }
+}
+
+Reverb::Reverb(Arena &arena, int maxSampleRate)
+    : enabled(false), roomSize(0.7f), damping(0.4f), width(1.0f), mix(0.3f), combs(NUM_COMBS)
+{
+    for (int i = 0; i < NUM_COMBS; ++i)
+    {
+        combL[i] = {DelayLine(arena, scaled(combTuning[i], maxSampleRate)), 0.0f};
+        combR[i] = {DelayLine(arena, scaled(combTuning[i] + stereoSpread, maxSampleRate)), 0.0f};
+    }
+    for (int i = 0; i < NUM_ALLPASSES; ++i)
+    {
+        allpassL[i] = {DelayLine(arena, scaled(allpassTuning[i], maxSampleRate))};
+        allpassR[i] = {DelayLine(arena, scaled(allpassTuning[i] + stereoSpread, maxSampleRate))};
+    }
+}
+
+void Reverb::prepare(float sampleRate)
+{
+    for (int i = 0; i < NUM_COMBS; ++i)
+    {
+        combL[i].line.setLength(scaled(combTuning[i], sampleRate));
+        combR[i].line.setLength(scaled(combTuning[i] + stereoSpread, sampleRate));
+    }
+    for (int i = 0; i < NUM_ALLPASSES; ++i)
+    {
+        allpassL[i].line.setLength(scaled(allpassTuning[i], sampleRate));
+        allpassR[i].line.setLength(scaled(allpassTuning[i] + stereoSpread, sampleRate));
+    }
+    reset();
+}
+
+void Reverb::reset()
+{
+    for (int i = 0; i < NUM_COMBS; ++i)
+    {
+        combL[i].line.clear();
+        combR[i].line.clear();
+        combL[i].store = combR[i].store = 0.0f;
+    }
+    for (int i = 0; i < NUM_ALLPASSES; ++i)
+    {
+        allpassL[i].line.clear();
+        allpassR[i].line.clear();
+    }
+}
+
+void Reverb::setCombs(int n)
+{
+    n = n < 1 ? 1 : n > NUM_COMBS ? NUM_COMBS : n;
+    for (int i = combs; i < n; ++i)
+    {
+        combL[i].line.clear();
+        combR[i].line.clear();
+        combL[i].store = combR[i].store = 0.0f;
+    }
+    combs = n;
+}
+
+void Reverb::process(float *left, float *right, int frames)
+{
+    const float feedback = roomSize * 0.28f + 0.7f;
+    const float damp = damping * 0.4f;
+    const float level = (float)NUM_COMBS / combs; // Fewer combs, same loudness
+    const float wet1 = mix * 3.0f * (width * 0.5f + 0.5f) * level;
+    const float wet2 = mix * 3.0f * ((1.0f - width) * 0.5f) * level;
+
+    for (int i = 0; i < frames; ++i)
+    {
+        float in = (left[i] + right[i]) * inputGain;
+        float outL = 0.0f, outR = 0.0f;
+
+        for (int c = 0; c < combs; ++c)
+        {
+            Comb &cl = combL[c];
+            float yl = cl.line.read(cl.line.getLength());
+            cl.store = yl * (1.0f - damp) + cl.store * damp;
+            cl.line.write(in + cl.store * feedback);
+            outL += yl;
+
+            Comb &cr = combR[c];
+            float yr = cr.line.read(cr.line.getLength());
+            cr.store = yr * (1.0f - damp) + cr.store * damp;
+            cr.line.write(in + cr.store * feedback);
+            outR += yr;
+        }
+
+        for (int a = 0; a < NUM_ALLPASSES; ++a)
+        {
+            DelayLine &ll = allpassL[a].line;
+            float bl = ll.read(ll.getLength());
+            ll.write(outL + bl * 0.5f);
+            outL = bl - outL;
+
+            DelayLine &lr = allpassR[a].line;
+            float br = lr.read(lr.getLength());
+            lr.write(outR + br * 0.5f);
+            outR = br - outR;
+        }
+
+        float dryL = left[i], dryR = right[i];
+        left[i] = dryL + outL * wet1 + outR * wet2;
+        right[i] = dryR + outR * wet1 + outL * wet2;
+    }
+}
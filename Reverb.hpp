@@ -0,0 +1,39 @@
+#pragma once
+#include "DelayLine.hpp"
+
+// Schroeder/Moorer style algorithmic reverb: 8 damped combs into 4 allpasses per side
+class Reverb
+{
+public:
+    static constexpr int NUM_COMBS = 8;
+    static constexpr int NUM_ALLPASSES = 4;
+
+    bool enabled;
+    float roomSize; // 0-1, comb feedback
+    float damping;  // 0-1, high-frequency loss in the tail
+    float width;    // Stereo width 0-1
+    float mix;
+
+    Reverb(Arena &arena, int maxSampleRate);
+    void prepare(float sampleRate);
+    void reset();
+    void process(float *left, float *right, int frames);
+    // Audio thread: runs only the first `combs` (1..NUM_COMBS) combs per side, a
+    // sparser tail at the same level. Combs switched back on start from silence.
+    void setCombs(int combs);
+
+private:
+    struct Comb
+    {
+        DelayLine line;
+        float store;
+    };
+    struct Allpass
+    {
+        DelayLine line;
+    };
+
+    Comb combL[NUM_COMBS], combR[NUM_COMBS];
+    Allpass allpassL[NUM_ALLPASSES], allpassR[NUM_ALLPASSES];
+    int combs;
+};
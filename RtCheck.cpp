@@ -0,0 +1,273 @@
+#include "RtCheck.hpp"
+#include <algorithm>
+#include <iostream>
+
+#if SYNTH_RT_CHECK_ACTIVE
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C"
+{
+    void *__libc_malloc(size_t);
+    void *__libc_calloc(size_t, size_t);
+    void *__libc_realloc(void *, size_t);
+    void *__libc_memalign(size_t, size_t);
+    void __libc_free(void *);
+}
+
+namespace
+{
+    const char *kindNames[RtCheck::NUM_KINDS] = {"allocation", "free", "mutex lock", "blocking call"};
+    const int MAX_RECORDS = 32;
+    const int MAX_FRAMES = 24;
+
+    struct Record
+    {
+        RtCheck::Kind kind;
+        const char *what;
+        int frames;
+        void *stack[MAX_FRAMES];
+    };
+
+    // Plain arrays only: these are written from inside malloc
+    std::atomic<unsigned long> counts[RtCheck::NUM_KINDS];
+    Record records[MAX_RECORDS];
+    std::atomic<int> numRecords{0};
+
+    thread_local int depth = 0;         // Nesting of Scopes on this thread
+    thread_local bool recording = false; // backtrace() may itself allocate
+
+    void violation(RtCheck::Kind kind, const char *what)
+    {
+        if (depth == 0 || recording)
+            return;
+        recording = true;
+        counts[kind].fetch_add(1, std::memory_order_relaxed);
+        // Keep one record per distinct call site
+        void *stack[MAX_FRAMES];
+        int frames = backtrace(stack, MAX_FRAMES);
+        int stored = std::min(numRecords.load(std::memory_order_relaxed), MAX_RECORDS);
+        bool seen = false;
+        for (int i = 0; i < stored && !seen; ++i)
+            seen = records[i].frames == frames && std::equal(stack, stack + frames, records[i].stack);
+        if (!seen)
+        {
+            int slot = numRecords.fetch_add(1, std::memory_order_relaxed);
+            if (slot < MAX_RECORDS)
+            {
+                Record &r = records[slot];
+                r.kind = kind;
+                r.what = what;
+                r.frames = frames;
+                std::copy(stack, stack + frames, r.stack);
+            }
+        }
+        recording = false;
+    }
+
+    // Next definition of an interposed libc function, looked up on first use
+    template <typename Fn>
+    Fn next(Fn &cache, const char *name)
+    {
+        if (!cache)
+            cache = (Fn)dlsym(RTLD_NEXT, name);
+        return cache;
+    }
+
+    // backtrace() loads libgcc on first use; do that now rather than in the callback
+    struct Warmup
+    {
+        Warmup()
+        {
+            void *stack[2];
+            backtrace(stack, 2);
+        }
+    } warmup;
+}
+
+RtCheck::Scope::Scope() { ++depth; }
+RtCheck::Scope::~Scope() { --depth; }
+
+unsigned long RtCheck::violations()
+{
+    unsigned long total = 0;
+    for (const auto &c : counts)
+        total += c.load();
+    return total;
+}
+
+unsigned long RtCheck::count(Kind kind)
+{
+    return counts[kind].load();
+}
+
+void RtCheck::report()
+{
+    std::cerr << "RT check: " << violations() << " violation(s) inside the audio callback\n";
+    for (int k = 0; k < NUM_KINDS; ++k)
+        std::cerr << "  " << kindNames[k] << ": " << counts[k].load() << "\n";
+    int n = std::min(numRecords.load(), MAX_RECORDS);
+    for (int i = 0; i < n; ++i)
+    {
+        std::cerr << "-- #" << i + 1 << " " << kindNames[records[i].kind] << " (" << records[i].what << ")" << std::endl;
+        backtrace_symbols_fd(records[i].stack, records[i].frames, 2);
+    }
+}
+
+void RtCheck::reset()
+{
+    for (auto &c : counts)
+        c.store(0);
+    numRecords.store(0);
+}
+
+// Interposers. Allocations go straight to glibc's implementation; everything
+// else forwards to the next definition in link order.
+extern "C"
+{
+    void *malloc(size_t size)
+    {
+        violation(RtCheck::Alloc, "malloc");
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        violation(RtCheck::Alloc, "calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *ptr, size_t size)
+    {
+        violation(RtCheck::Alloc, "realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void *ptr)
+    {
+        if (ptr)
+            violation(RtCheck::Free, "free");
+        __libc_free(ptr);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t *mutex)
+    {
+        static int (*real)(pthread_mutex_t *);
+        violation(RtCheck::Lock, "pthread_mutex_lock");
+        return next(real, "pthread_mutex_lock")(mutex);
+    }
+
+    int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+    {
+        static int (*real)(pthread_cond_t *, pthread_mutex_t *);
+        violation(RtCheck::Blocking, "pthread_cond_wait");
+        return next(real, "pthread_cond_wait")(cond, mutex);
+    }
+
+    ssize_t read(int fd, void *buf, size_t count)
+    {
+        static ssize_t (*real)(int, void *, size_t);
+        violation(RtCheck::Blocking, "read");
+        return next(real, "read")(fd, buf, count);
+    }
+
+    ssize_t write(int fd, const void *buf, size_t count)
+    {
+        static ssize_t (*real)(int, const void *, size_t);
+        violation(RtCheck::Blocking, "write");
+        return next(real, "write")(fd, buf, count);
+    }
+
+    size_t fwrite(const void *ptr, size_t size, size_t count, FILE *stream)
+    {
+        static size_t (*real)(const void *, size_t, size_t, FILE *);
+        violation(RtCheck::Blocking, "fwrite");
+        return next(real, "fwrite")(ptr, size, count, stream);
+    }
+
+    int nanosleep(const struct timespec *req, struct timespec *rem)
+    {
+        static int (*real)(const struct timespec *, struct timespec *);
+        violation(RtCheck::Blocking, "nanosleep");
+        return next(real, "nanosleep")(req, rem);
+    }
+
+    int clock_nanosleep(clockid_t clock, int flags, const struct timespec *req, struct timespec *rem)
+    {
+        static int (*real)(clockid_t, int, const struct timespec *, struct timespec *);
+        violation(RtCheck::Blocking, "clock_nanosleep");
+        return next(real, "clock_nanosleep")(clock, flags, req, rem);
+    }
+
+    int usleep(useconds_t usec)
+    {
+        static int (*real)(useconds_t);
+        violation(RtCheck::Blocking, "usleep");
+        return next(real, "usleep")(usec);
+    }
+
+    int poll(struct pollfd *fds, nfds_t count, int timeout)
+    {
+        static int (*real)(struct pollfd *, nfds_t, int);
+        violation(RtCheck::Blocking, "poll");
+        return next(real, "poll")(fds, count, timeout);
+    }
+}
+
+// Counted separately from malloc so the report names the C++ call
+void *operator new(size_t size)
+{
+    violation(RtCheck::Alloc, "operator new");
+    if (void *p = __libc_malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(size_t size, std::align_val_t align)
+{
+    violation(RtCheck::Alloc, "operator new (aligned)");
+    if (void *p = __libc_memalign((size_t)align, size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size, std::align_val_t align)
+{
+    return ::operator new(size, align);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr)
+        violation(RtCheck::Free, "operator delete");
+    __libc_free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept { ::operator delete(ptr); }
+void operator delete(void *ptr, size_t) noexcept { ::operator delete(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { ::operator delete(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { ::operator delete(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { ::operator delete(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { ::operator delete(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { ::operator delete(ptr); }
+
+#else
+
+unsigned long RtCheck::violations() { return 0; }
+unsigned long RtCheck::count(Kind) { return 0; }
+void RtCheck::report() { std::cerr << "RT check: not built in (rebuild with -DSYNTH_RT_CHECK on glibc)\n"; }
+void RtCheck::reset() {}
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef> // Defines __GLIBC__
+
+// Real-time safety checker for the audio callback. Built with -DSYNTH_RT_CHECK
+// on glibc, any allocation, mutex lock or blocking call made by a thread while
+// it is inside a Scope is counted and its stack captured; in normal builds
+// Scope is empty and nothing is intercepted.
+#if defined(SYNTH_RT_CHECK) && defined(__GLIBC__)
+#define SYNTH_RT_CHECK_ACTIVE 1
+#else
+#define SYNTH_RT_CHECK_ACTIVE 0
+#endif
+
+namespace RtCheck
+{
+    enum Kind
+    {
+        Alloc,
+        Free,
+        Lock,
+        Blocking,
+        NUM_KINDS
+    };
+
+    constexpr bool available = SYNTH_RT_CHECK_ACTIVE;
+
+    // Marks the current thread as real-time for the lifetime of the object
+#if SYNTH_RT_CHECK_ACTIVE
+    struct Scope
+    {
+        Scope();
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+#else
+    struct Scope
+    {
+        Scope() {}
+    };
+#endif
+
+    unsigned long violations();
+    unsigned long count(Kind kind);
+    // Totals per kind plus one symbolised stack per distinct call site, on stderr
+    void report();
+    void reset();
+}
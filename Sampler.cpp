@@ -0,0 +1,371 @@
+#include "Sampler.hpp"
+#include "Stereo.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <regex>
+
+namespace
+{
+    uint64_t pack(uint32_t gen, uint32_t frame) { return ((uint64_t)gen << 32) | frame; }
+
+    // "060", "C4", "F#2", "Bb-1" at the end of a file stem; C4 = 60
+    int rootFromName(const std::string &stem)
+    {
+        std::smatch m;
+        if (std::regex_search(stem, m, std::regex("(\\d{1,3})$")) && !std::regex_search(stem, std::regex("[A-Ga-g][#b]?-?\\d$")))
+            return std::min(127, std::stoi(m[1]));
+        if (std::regex_search(stem, m, std::regex("([A-Ga-g])([#b]?)(-?\\d)$")))
+        {
+            const int semis[7] = {9, 11, 0, 2, 4, 5, 7}; // A..G
+            int note = semis[std::toupper(m[1].str()[0]) - 'A'];
+            if (m[2] == "#")
+                ++note;
+            else if (m[2] == "b")
+                --note;
+            note += (std::stoi(m[3]) + 1) * 12;
+            return std::max(0, std::min(127, note));
+        }
+        return -1;
+    }
+}
+
+Sampler::Sampler(Arena &arena)
+    : gain(0.5f), release(0.3f), spread(0.0f), synchronous(false), underruns(0),
+      sampleRate(44100.0f), tuning(&Tuning::standard()), noteCounter(0), running(false)
+{
+    std::fill(zoneForNote, zoneForNote + 128, -1);
+    for (Voice &v : voices)
+        v.ring = arena.allocate<float>(RING_FRAMES * 2);
+}
+
+Sampler::~Sampler()
+{
+    stop();
+}
+
+bool Sampler::load(const std::string &directory, std::string &error)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<fs::path> paths;
+    for (const auto &entry : fs::directory_iterator(directory, ec))
+    {
+        std::string ext = entry.path().extension().string();
+        if (ext == ".wav" || ext == ".WAV")
+            paths.push_back(entry.path());
+    }
+    if (ec)
+    {
+        error = "cannot read " + directory;
+        return false;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    zones.clear();
+    zones.reserve(paths.size());
+    for (const fs::path &path : paths)
+    {
+        int root = rootFromName(path.stem().string());
+        if (root < 0)
+            continue;
+        std::unique_ptr<MappedFile> file(new MappedFile());
+        WavFile::Layout layout;
+        if (!file->open(path.string(), error) || !WavFile::parseLayout(file->data(), file->size(), layout, error))
+        {
+            error = path.string() + ": " + error;
+            return false;
+        }
+        if (layout.channels > 8)
+        {
+            error = path.string() + ": too many channels";
+            return false;
+        }
+
+        Zone zone;
+        zone.root = root;
+        zone.layout = layout;
+        zone.data = file->data() + layout.dataOffset;
+        zone.preloadFrames = (uint32_t)std::min<size_t>(layout.frames, (size_t)(PRELOAD_SECONDS * layout.sampleRate));
+        zone.preload.resize((size_t)zone.preloadFrames * 2);
+        decodeStereo(zone, 0, zone.preloadFrames, zone.preload.data());
+        zones.push_back(std::move(zone));
+        files.push_back(std::move(file));
+    }
+    if (zones.empty())
+    {
+        error = directory + ": no WAV files with a note in their name";
+        return false;
+    }
+
+    // Each key plays the zone with the nearest root
+    for (int note = 0; note < 128; ++note)
+    {
+        int best = 0;
+        for (int z = 1; z < (int)zones.size(); ++z)
+        {
+            if (std::abs(zones[z].root - note) < std::abs(zones[best].root - note))
+                best = z;
+        }
+        zoneForNote[note] = best;
+    }
+    return true;
+}
+
+void Sampler::prepare(float sr)
+{
+    sampleRate = sr;
+}
+
+void Sampler::start()
+{
+    if (running)
+        return;
+    running = true;
+    streamerThread = std::thread(&Sampler::streamerLoop, this);
+}
+
+void Sampler::stop()
+{
+    if (!running)
+        return;
+    running = false;
+    streamerThread.join();
+}
+
+void Sampler::decodeStereo(const Zone &zone, uint32_t start, uint32_t count, float *dst)
+{
+    // Decode whole runs of frames at a time, then fold down to stereo
+    const WavFile::Layout &l = zone.layout;
+    const size_t frameBytes = (size_t)l.channels * (l.bits / 8);
+    const uint32_t chunk = std::max(1, 4096 / l.channels);
+    float scratch[4096];
+    while (count > 0)
+    {
+        uint32_t n = std::min(count, chunk);
+        WavFile::decode(zone.data + start * frameBytes, l, (size_t)n * l.channels, scratch);
+        const int right = l.channels > 1 ? 1 : 0;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            dst[2 * i] = scratch[i * l.channels];
+            dst[2 * i + 1] = scratch[i * l.channels + right];
+        }
+        start += n;
+        count -= n;
+        dst += 2 * n;
+    }
+}
+
+void Sampler::fill(Voice &v)
+{
+    uint32_t gen = v.generation.load(std::memory_order_acquire);
+    const Zone *zone = v.streamZone.load(std::memory_order_acquire);
+    if (!zone)
+        return;
+    if (gen != v.streamGen)
+    {
+        v.streamGen = gen;
+        v.fillPos = zone->preloadFrames;
+    }
+
+    uint64_t c = v.consumed.load(std::memory_order_acquire);
+    if ((uint32_t)(c >> 32) != gen)
+        return;
+    uint32_t consumedFrame = (uint32_t)c;
+    uint32_t space = RING_FRAMES - (v.fillPos - consumedFrame);
+    uint32_t remaining = (uint32_t)zone->layout.frames - v.fillPos;
+    uint32_t count = std::min(std::min(space, remaining), (uint32_t)4096);
+    if (count == 0)
+        return;
+
+    // Decode straight into the ring; page faults on the mapping happen here
+    uint32_t slot = v.fillPos % RING_FRAMES;
+    uint32_t first = std::min(count, RING_FRAMES - slot);
+    decodeStereo(*zone, v.fillPos, first, &v.ring[(size_t)slot * 2]);
+    if (count > first)
+        decodeStereo(*zone, v.fillPos + first, count - first, &v.ring[0]);
+
+    // A note-on that reused this voice while we were writing invalidates the data
+    if (v.generation.load(std::memory_order_acquire) != gen)
+        return;
+    v.fillPos += count;
+    v.written.store(pack(gen, v.fillPos), std::memory_order_release);
+}
+
+void Sampler::streamerLoop()
+{
+    while (running)
+    {
+        for (Voice &v : voices)
+            fill(v);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+void Sampler::noteOn(int note, int velocity)
+{
+    if (zones.empty() || note < 0 || note > 127)
+        return;
+    const Zone &zone = zones[zoneForNote[note]];
+    double ratio = tuning->ratio(zone.root, note);
+    if (ratio <= 0.0)
+        return;
+
+    // Free voice first, then the oldest releasing one, then the oldest
+    Voice *target = nullptr;
+    for (Voice &v : voices)
+    {
+        if (!v.zone)
+        {
+            target = &v;
+            break;
+        }
+    }
+    if (!target)
+    {
+        for (Voice &v : voices)
+        {
+            bool better = !target || (v.releasing && !target->releasing) ||
+                          (v.releasing == target->releasing && v.age < target->age);
+            if (better)
+                target = &v;
+        }
+    }
+
+    Voice &v = *target;
+    v.zone = &zone;
+    v.note = note;
+    v.pos = 0.0;
+    v.step = zone.layout.sampleRate / sampleRate * ratio;
+    v.level = gain * velocity / 127.0f;
+    Stereo::panGains(spread * (note - 64) / 64.0f, v.gainL, v.gainR);
+    v.env = 1.0f;
+    v.releasing = false;
+    v.age = ++noteCounter;
+    v.gen = v.generation.load(std::memory_order_relaxed) + 1;
+
+    v.streamZone.store(&zone, std::memory_order_release);
+    v.consumed.store(pack(v.gen, zone.preloadFrames), std::memory_order_release);
+    v.generation.store(v.gen, std::memory_order_release);
+}
+
+void Sampler::noteOff(int note)
+{
+    for (Voice &v : voices)
+    {
+        if (v.zone && v.note == note)
+            v.releasing = true;
+    }
+}
+
+void Sampler::allNotesOff()
+{
+    for (Voice &v : voices)
+    {
+        if (v.zone)
+            v.releasing = true;
+    }
+}
+
+void Sampler::stopVoice(Voice &v)
+{
+    v.zone = nullptr;
+    v.streamZone.store(nullptr, std::memory_order_release);
+    v.generation.store(v.gen + 1, std::memory_order_release);
+}
+
+void Sampler::process(float *left, float *right, int frames)
+{
+    if (synchronous)
+    {
+        for (Voice &v : voices)
+            fill(v);
+    }
+
+    const float releaseStep = 1.0f / std::max(release * sampleRate, 1.0f);
+    for (Voice &v : voices)
+    {
+        if (!v.zone)
+            continue;
+        const Zone &zone = *v.zone;
+        const uint32_t total = (uint32_t)zone.layout.frames;
+
+        // Frames [preloadFrames, available) are in the ring for this note
+        uint64_t w = v.written.load(std::memory_order_acquire);
+        uint32_t available = (uint32_t)(w >> 32) == v.gen ? (uint32_t)w : zone.preloadFrames;
+        bool starved = false;
+
+        for (int i = 0; i < frames; ++i)
+        {
+            uint32_t f = (uint32_t)v.pos;
+            if (f + 1 >= total)
+            {
+                v.env = 0.0f;
+                break;
+            }
+            float frac = (float)(v.pos - f);
+            float l0, r0, l1, r1;
+            if (f + 1 < zone.preloadFrames)
+            {
+                const float *p = &zone.preload[(size_t)f * 2];
+                l0 = p[0];
+                r0 = p[1];
+                l1 = p[2];
+                r1 = p[3];
+            }
+            else if (f + 1 < available)
+            {
+                const float *a = f < zone.preloadFrames ? &zone.preload[(size_t)f * 2] : &v.ring[(size_t)(f % RING_FRAMES) * 2];
+                const float *b = &v.ring[(size_t)((f + 1) % RING_FRAMES) * 2];
+                l0 = a[0];
+                r0 = a[1];
+                l1 = b[0];
+                r1 = b[1];
+            }
+            else
+            {
+                starved = true; // Streamer fell behind: emit silence rather than wait
+                l0 = r0 = l1 = r1 = 0.0f;
+            }
+
+            float g = v.level * v.env;
+            left[i] += g * v.gainL * (l0 + frac * (l1 - l0));
+            right[i] += g * v.gainR * (r0 + frac * (r1 - r0));
+            v.pos += v.step;
+            if (v.releasing)
+            {
+                v.env -= releaseStep;
+                if (v.env <= 0.0f)
+                {
+                    v.env = 0.0f;
+                    break;
+                }
+            }
+        }
+
+        if (starved)
+            ++underruns;
+        if (v.env <= 0.0f)
+        {
+            stopVoice(v);
+            continue;
+        }
+        uint32_t consumedFrame = std::max((uint32_t)v.pos, zone.preloadFrames);
+        v.consumed.store(pack(v.gen, consumedFrame), std::memory_order_release);
+    }
+}
+
+Sampler::Footprint Sampler::footprint() const
+{
+    Footprint fp{0, 0, 0, 0};
+    for (const auto &file : files)
+    {
+        fp.mappedBytes += file->size();
+        fp.residentBytes += file->residentBytes();
+    }
+    for (const Zone &zone : zones)
+        fp.preloadBytes += zone.preload.size() * sizeof(float);
+    fp.ringBytes = (size_t)MAX_VOICES * RING_FRAMES * 2 * sizeof(float);
+    return fp;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Arena.hpp"
+#include "MappedFile.hpp"
+#include "WavFile.hpp"
+#include "Tuning.hpp"
+
+// Multi-sampled instrument played from memory-mapped WAV files. The first
+// PRELOAD_SECONDS of every sample are decoded into RAM at load time; the rest is
+// decoded from the mapping by a streamer thread into a ring buffer per voice, so
+// the audio thread never touches mapped pages and page faults land on the
+// streamer. Files are mapped, not read, so libraries larger than RAM work.
+class Sampler
+{
+public:
+    static constexpr int MAX_VOICES = 16;
+    static constexpr int RING_FRAMES = 16384; // Per voice, stereo
+    static constexpr float PRELOAD_SECONDS = 0.25f;
+
+    struct Footprint
+    {
+        size_t mappedBytes;   // Address space of all mapped files
+        size_t residentBytes; // Mapped pages currently in RAM
+        size_t preloadBytes;
+        size_t ringBytes;
+    };
+
+    float gain;
+    float release;    // Seconds
+    float spread;     // Keyboard pan width: 0 keeps every note centred, 1 spans hard left to right
+    bool synchronous; // Stream inline before each block (offline rendering)
+    std::atomic<unsigned long> underruns; // Blocks where a voice ran past its streamed data
+
+    explicit Sampler(Arena &arena); // Voice rings come from the arena
+    ~Sampler();
+    // Maps every WAV in a directory. Root notes come from the file name:
+    // a trailing MIDI number ("piano_060.wav") or note name ("piano_C4.wav").
+    bool load(const std::string &directory, std::string &error);
+    bool loaded() const { return !zones.empty(); }
+    void prepare(float sampleRate);
+    void start();
+    void stop();
+
+    // Audio thread
+    void noteOn(int note, int velocity);
+    void setTuning(const Tuning *next) { tuning = next; } // Not owned; applies from the next note
+    void noteOff(int note);
+    void allNotesOff();
+    void process(float *left, float *right, int frames); // Adds into the buffers
+
+    Footprint footprint() const;
+
+private:
+    struct Zone
+    {
+        int root;
+        WavFile::Layout layout;
+        const unsigned char *data; // Start of the mapped sample data
+        std::vector<float> preload; // Stereo interleaved
+        uint32_t preloadFrames;
+    };
+
+    struct Voice
+    {
+        // Audio thread
+        const Zone *zone = nullptr;
+        int note = -1;
+        double pos = 0.0;
+        double step = 1.0;
+        float level = 0.0f;
+        float gainL = 1.0f, gainR = 1.0f; // Pan by note position
+        float env = 0.0f;
+        bool releasing = false;
+        uint32_t gen = 0;
+        unsigned long age = 0;
+
+        // Shared: audio writes zone/generation/consumed, streamer writes written.
+        // Positions are packed as (generation << 32) | frame so stale values are ignored.
+        std::atomic<const Zone *> streamZone{nullptr};
+        std::atomic<uint32_t> generation{0};
+        std::atomic<uint64_t> consumed{0};
+        std::atomic<uint64_t> written{0};
+        float *ring = nullptr; // RING_FRAMES stereo frames
+
+        // Streamer thread
+        uint32_t streamGen = 0;
+        uint32_t fillPos = 0;
+    };
+
+    std::vector<std::unique_ptr<MappedFile>> files;
+    std::vector<Zone> zones;
+    int zoneForNote[128];
+    Voice voices[MAX_VOICES];
+    float sampleRate;
+    const Tuning *tuning;
+    unsigned long noteCounter;
+
+    std::atomic<bool> running;
+    std::thread streamerThread;
+
+    void fill(Voice &voice);
+    void streamerLoop();
+    void stopVoice(Voice &voice);
+    static void decodeStereo(const Zone &zone, uint32_t start, uint32_t count, float *dst);
+};
@@ -1,14 +1,102 @@
 #include "Sequencer.hpp"
 #include <algorithm>
+#include <cmath>
 
-Sequencer::Sequencer() : notes(STEPS, -1), lengths(STEPS, 0.25f), currentStep(0), timer(0.0f), playing(false) {}
-void Sequencer::start() { playing = true; currentStep = 0; timer = 0.0f; }
-void Sequencer::stop() { playing = false; }
-void Sequencer::update(float dt) {
-    if (!playing) return;
-    timer += dt;
-    if (timer >= lengths[currentStep]) {
-        timer = 0.0f;
-        currentStep = (currentStep + 1) % STEPS;
+namespace
+{
+    // Order of simultaneous events: a note ends, locks change, then the next note starts
+    int rank(const Event &e)
+    {
+        if (e.type == EventType::NoteOff)
+            return 0;
+        if (e.type == EventType::Controller)
+            return e.value < 0.0f ? 1 : 2;
+        return 3;
+    }
+}
+
+void Sequencer::Step::lock(Param p, float value)
+{
+    lockMask |= 1u << (int)p;
+    locks[(int)p] = std::min(std::max(value, 0.0f), 1.0f);
+}
+
+Sequencer::Sequencer() : bpm(120.0f), stepsPerBeat(4), patterns(MAX_PATTERNS), chain(1, 0) {}
+
+double Sequencer::stepSamples(float sampleRate) const
+{
+    return sampleRate * 60.0 / (bpm * stepsPerBeat);
+}
+
+SequenceTimeline *Sequencer::compile(float sampleRate) const
+{
+    SequenceTimeline *timeline = new SequenceTimeline();
+    const double stepLength = stepSamples(sampleRate);
+    // Times come from the absolute step index so long chains do not drift
+    auto at = [&](long step, double fraction)
+    { return (uint64_t)std::llround((step + fraction) * stepLength); };
+
+    long offset = 0; // First step of the current pattern within the chain
+    for (int index : chain)
+    {
+        const Pattern &pattern = patterns[index];
+        for (const Track &track : pattern.tracks)
+        {
+            if (track.muted)
+                continue;
+            for (int s = 0; s < pattern.length; ++s)
+            {
+                const Step &step = track.steps[s % track.length];
+                const Step &next = track.steps[(s + 1) % track.length];
+                long absolute = offset + s;
+
+                for (int p = 0; p < (int)Param::Count; ++p)
+                {
+                    if (!step.locked((Param)p))
+                        continue;
+                    uint8_t cc = paramController[p];
+                    timeline->events.push_back({at(absolute, 0.0), EventType::Controller, track.channel, cc, 0, step.locks[p]});
+                    // Released when the step ends unless the next step in this pattern holds the same lock
+                    if (s + 1 == pattern.length || !next.locked((Param)p))
+                        timeline->events.push_back({at(absolute + 1, 0.0), EventType::Controller, track.channel, cc, 0, -1.0f});
+                }
+
+                if (step.note >= 0)
+                {
+                    float gate = std::min(std::max(step.gate, 0.01f), 1.0f);
+                    timeline->events.push_back({at(absolute, 0.0), EventType::NoteOn, track.channel, (uint8_t)step.note, step.velocity, 0.0f});
+                    timeline->events.push_back({at(absolute, gate), EventType::NoteOff, track.channel, (uint8_t)step.note, 0, 0.0f});
+                }
+            }
+        }
+        offset += pattern.length;
+    }
+
+    timeline->length = std::max<uint64_t>(at(offset, 0.0), 1);
+    // Anything that lands on the loop point belongs to the start of the next pass
+    for (Event &e : timeline->events)
+    {
+        if (e.time >= timeline->length)
+            e.time -= timeline->length;
+    }
+    std::stable_sort(timeline->events.begin(), timeline->events.end(), [](const Event &a, const Event &b)
+                     { return a.time != b.time ? a.time < b.time : rank(a) < rank(b); });
+    return timeline;
+}
+
+void Sequencer::locate(uint64_t position, float sampleRate, int &pattern, int &step) const
+{
+    long absolute = (long)(position / stepSamples(sampleRate));
+    pattern = chain.empty() ? 0 : chain[0];
+    step = 0;
+    for (int index : chain)
+    {
+        if (absolute < patterns[index].length)
+        {
+            pattern = index;
+            step = (int)absolute;
+            return;
+        }
+        absolute -= patterns[index].length;
     }
 }
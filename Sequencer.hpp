@@ -1,15 +1,62 @@
 #pragma once
+#include <cstdint>
 #include <vector>
-class Sequencer {
+#include "Event.hpp"
+
+// A pattern compiled for playback: every note, gate and parameter lock of a
+// whole chain as one time-sorted array, times relative to the loop start.
+struct SequenceTimeline
+{
+    std::vector<Event> events;
+    uint64_t length; // Loop length in samples
+};
+
+// Multi-track step sequencer. Patterns are edited here on the UI thread and
+// compiled into a SequenceTimeline whenever they change; the audio thread only
+// ever walks the compiled array (see Engine::publishSequence).
+class Sequencer
+{
 public:
-    static constexpr int STEPS = 16;
-    std::vector<int> notes;
-    std::vector<float> lengths;
-    int currentStep;
-    float timer;
-    bool playing;
+    static constexpr int MAX_STEPS = 64;
+    static constexpr int MAX_TRACKS = 8;
+    static constexpr int MAX_PATTERNS = 16;
+
+    struct Step
+    {
+        int8_t note = -1; // -1 = rest
+        uint8_t velocity = 100;
+        float gate = 0.5f;    // Note length as a fraction of the step
+        uint16_t lockMask = 0; // Bit per Param with a value in locks
+        float locks[(int)Param::Count] = {};
+
+        void lock(Param p, float value);
+        void unlock(Param p) { lockMask &= ~(1u << (int)p); }
+        bool locked(Param p) const { return lockMask & (1u << (int)p); }
+    };
+
+    struct Track
+    {
+        int length = 16; // Steps before this track wraps; may differ from the pattern
+        uint8_t channel = 0;
+        bool muted = false;
+        Step steps[MAX_STEPS];
+    };
+
+    struct Pattern
+    {
+        int length = 16; // Steps
+        Track tracks[MAX_TRACKS];
+    };
+
+    float bpm;
+    int stepsPerBeat;
+    std::vector<Pattern> patterns;
+    std::vector<int> chain; // Pattern indices played in order, then looped
+
     Sequencer();
-    void start();
-    void stop();
-    void update(float dt);
+    double stepSamples(float sampleRate) const;
+    // Flat playback array for the whole chain; allocates, so call it off the audio thread
+    SequenceTimeline *compile(float sampleRate) const;
+    // Pattern index and step at a position returned by Engine::sequencePosition()
+    void locate(uint64_t position, float sampleRate, int &pattern, int &step) const;
 };
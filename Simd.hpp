@@ -0,0 +1,15 @@
+#pragma once
+
+// Instruction set for the hand-vectorised loops, picked once at compile time.
+// SYNTH_NEON64 marks AArch64, whose NEON adds the rounding conversions the FM
+// sine needs.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SYNTH_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SYNTH_NEON 1
+#if defined(__aarch64__)
+#define SYNTH_NEON64 1
+#endif
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+#include <cmath>
+
+// Helpers for the stereo signal path: the pan law every voice uses, and the
+// final stage that turns the engine's left/right blocks into host buffers.
+namespace Stereo
+{
+    // Equal-power pan, scaled by sqrt(2) so a centred voice keeps unity gain
+    inline void panGains(float pan, float &left, float &right)
+    {
+        if (pan == 0.0f)
+        {
+            left = right = 1.0f; // Exact, so a centred voice is bit-identical to the mono path
+            return;
+        }
+        pan = std::fmax(-1.0f, std::fmin(1.0f, pan));
+        float angle = (pan + 1.0f) * (float)M_PI * 0.25f;
+        left = std::cos(angle) * (float)M_SQRT2;
+        right = std::sin(angle) * (float)M_SQRT2;
+    }
+
+    // LRLR... from two planar blocks, straight into the host buffer; the
+    // compiler vectorises the plain loop
+    inline void interleave(const float *left, const float *right, float *out, int frames)
+    {
+        for (int i = 0; i < frames; ++i, out += 2)
+        {
+            out[0] = left[i];
+            out[1] = right[i];
+        }
+    }
+}
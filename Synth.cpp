@@ -2,7 +2,7 @@
 #include <cmath>
 
 Synth::Synth() : waveType(WaveForm::Sine), frequency(440.0f), amplitude(0.5f),
-                 baseFrequency(440.0f), baseCutoff(1000.0f), env(), seq(), filter(), lfo(), phase(0.0f) {}
+                 baseFrequency(440.0f), baseCutoff(1000.0f), env(), filter(), lfo(), unison(), fm(), pan(0.0f), controlInterval(1), phase(0.0f) {}
 
 void Synth::setFrequency(float freq)
 {
@@ -10,6 +10,19 @@ void Synth::setFrequency(float freq)
     frequency = freq; // Will be modulated by LFO if enabled
 }
 
+void Synth::noteOn()
+{
+    env.noteOn();
+    unison.retrigger();
+    fm.noteOn();
+}
+
+void Synth::noteOff()
+{
+    env.noteOff();
+    fm.noteOff();
+}
+
 float Synth::process(float dt)
 {
     float envVal = env.process(dt);
@@ -24,8 +37,8 @@ float Synth::process(float dt)
 
     if (lfo.target == LFOTarget::Pitch)
     {
-        // Vibrato: ±50 cents (yaklaşık %3 frekans değişimi)
-        modFrequency = baseFrequency * (1.0f + lfoValue * 0.03f);
+        // Vibrato: ±50 cents, symmetric in pitch
+        modFrequency = baseFrequency * FastMath::exp2<FastMath::Precision::Balanced>(lfoValue * VIBRATO_OCTAVES);
     }
     else if (lfo.target == LFOTarget::Amplitude)
     {
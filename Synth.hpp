@@ -1,9 +1,10 @@
 #pragma once
 #include "WaveForm.hpp"
 #include "Envelope.hpp"
-#include "Sequencer.hpp"
 #include "Filter.hpp"
 #include "LFO.hpp"
+#include "Unison.hpp"
+#include "FM.hpp"
 
 class Synth
 {
@@ -14,11 +15,25 @@ public:
     float baseFrequency; // LFO modülasyonu için orijinal frekans
     float baseCutoff;    // LFO modülasyonu için orijinal cutoff
     Envelope env;
-    Sequencer seq;
     Filter filter;
     LFO lfo;
+    Unison unison;
+    FM fm; // Takes over from waveType and the unison stack while fm.enabled (block path only)
+    float pan; // -1 (left) .. 1 (right)
+    int controlInterval; // Block path: the LFO is evaluated every this many frames and held between
+
+    static constexpr int MAX_BLOCK = 256; // Largest block handed to processBlock
+    static constexpr float VIBRATO_OCTAVES = 50.0f / 1200.0f; // Pitch LFO at full depth: +-50 cents
 
     Synth();
     float process(float dt);
+    void noteOn();
+    void noteOff();
+    // Renders a whole block with a kernel specialised for the current wave/LFO settings
+    template <typename Sample>
+    void processBlock(Sample *out, int frames, float dt);
+    // Stereo: the unison stack keeps its width and the voice is placed by pan
+    template <typename Sample>
+    void processBlock(Sample *left, Sample *right, int frames, float dt);
     void setFrequency(float freq);
 };
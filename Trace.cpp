@@ -0,0 +1,148 @@
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace Trace
+{
+    std::atomic<bool> recording(false);
+
+    namespace
+    {
+        struct Span
+        {
+            const char *name;
+            uint64_t begin, end;
+        };
+
+        // Written only by the thread that claimed it; read by write() after stop()
+        struct Buffer
+        {
+            std::vector<Span> spans;
+            std::atomic<size_t> count{0};
+            std::atomic<const char *> name{nullptr};
+            std::atomic<unsigned long> dropped{0};
+        };
+
+        Buffer buffers[MAX_THREADS];
+        std::atomic<int> claimed(0);
+        std::atomic<unsigned long> unclaimed(0); // Spans from threads past MAX_THREADS
+        std::atomic<bool> started(false);
+        std::chrono::steady_clock::time_point origin;
+
+        thread_local Buffer *mine = nullptr;
+        thread_local const char *threadName = nullptr;
+
+        Buffer *claim()
+        {
+            if (!mine)
+            {
+                int index = claimed.fetch_add(1, std::memory_order_relaxed);
+                if (index >= MAX_THREADS)
+                    return nullptr;
+                mine = &buffers[index];
+                mine->name.store(threadName, std::memory_order_relaxed);
+            }
+            return mine;
+        }
+    }
+
+    bool start(size_t eventsPerThread)
+    {
+        if (started.exchange(true))
+            return false;
+        for (Buffer &b : buffers)
+            b.spans.resize(eventsPerThread);
+        origin = std::chrono::steady_clock::now();
+        recording.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop()
+    {
+        recording.store(false, std::memory_order_relaxed);
+    }
+
+    uint64_t now()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    void nameThread(const char *name)
+    {
+        threadName = name;
+        if (mine)
+            mine->name.store(name, std::memory_order_relaxed);
+    }
+
+    void record(const char *name, uint64_t begin, uint64_t end)
+    {
+        Buffer *b = claim();
+        if (!b)
+        {
+            unclaimed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t n = b->count.load(std::memory_order_relaxed);
+        if (n >= b->spans.size())
+        {
+            b->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        b->spans[n] = {name, begin, end};
+        b->count.store(n + 1, std::memory_order_release);
+    }
+
+    size_t events()
+    {
+        size_t total = 0;
+        for (const Buffer &b : buffers)
+            total += b.count.load(std::memory_order_acquire);
+        return total;
+    }
+
+    unsigned long dropped()
+    {
+        unsigned long total = unclaimed.load(std::memory_order_relaxed);
+        for (const Buffer &b : buffers)
+            total += b.dropped.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    bool write(const std::string &path, std::string &error)
+    {
+        FILE *f = std::fopen(path.c_str(), "w");
+        if (!f)
+        {
+            error = "cannot create " + path;
+            return false;
+        }
+        // Complete ("X") events in microseconds, one tid per claimed buffer
+        std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%lu},\"traceEvents\":[\n", dropped());
+        bool first = true;
+        int threads = std::min(claimed.load(), MAX_THREADS);
+        for (int t = 0; t < threads; ++t)
+        {
+            const Buffer &b = buffers[t];
+            const char *name = b.name.load(std::memory_order_relaxed);
+            std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                         first ? "" : ",\n", t + 1, name ? name : "thread");
+            first = false;
+            size_t n = b.count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const Span &s = b.spans[i];
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", s.name,
+                             t + 1, s.begin / 1000.0, (s.end - s.begin) / 1000.0);
+            }
+        }
+        std::fprintf(f, "\n]}\n");
+        if (std::fclose(f) != 0)
+        {
+            error = "write failed for " + path;
+            return false;
+        }
+        return true;
+    }
+}
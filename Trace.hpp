@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Timeline capture for chasing dropouts. While recording, every Zone appends
+// a begin/end pair to a buffer owned by its thread; buffers are reserved up
+// front by start(), so recording never allocates or locks and the audio
+// thread can be traced too. write() turns the capture into Chrome trace JSON
+// for chrome://tracing or ui.perfetto.dev. When not recording, a Zone costs
+// one well-predicted branch.
+namespace Trace
+{
+    constexpr int MAX_THREADS = 16;
+
+    extern std::atomic<bool> recording;
+    inline bool on() { return recording.load(std::memory_order_acquire); } // Pairs with start()
+
+    // UI thread. Reserves eventsPerThread events for each of MAX_THREADS
+    // threads and starts recording; false if a capture was already taken.
+    bool start(size_t eventsPerThread = 1 << 18);
+    void stop();
+    // After stop(). Events dropped because a buffer filled up are counted in the file and in dropped().
+    bool write(const std::string &path, std::string &error);
+    size_t events();
+    unsigned long dropped();
+
+    // Names the calling thread in the trace; takes a string literal. No branch, no allocation.
+    void nameThread(const char *name);
+
+    uint64_t now(); // Nanoseconds since start()
+    void record(const char *name, uint64_t begin, uint64_t end);
+
+    // Scoped span. next() closes the current span and opens the following one,
+    // so consecutive phases need no nesting; end() closes it early.
+    class Zone
+    {
+    public:
+        explicit Zone(const char *name) : name(name), active(on()), begin(active ? now() : 0) {}
+        ~Zone() { end(); }
+        Zone(const Zone &) = delete;
+        Zone &operator=(const Zone &) = delete;
+
+        void next(const char *following)
+        {
+            if (active)
+            {
+                uint64_t t = now();
+                record(name, begin, t);
+                begin = t;
+            }
+            name = following;
+        }
+        void end()
+        {
+            if (active)
+                record(name, begin, now());
+            active = false;
+        }
+
+    private:
+        const char *name; // String literal
+        bool active;
+        uint64_t begin;
+    };
+}
@@ -0,0 +1,220 @@
+#include "Tuning.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    // Lines that are not '!' comments, trimmed of surrounding whitespace
+    std::vector<std::string> dataLines(const std::string &text)
+    {
+        std::vector<std::string> lines;
+        std::istringstream in(text);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            size_t start = line.find_first_not_of(" \t\r");
+            size_t end = line.find_last_not_of(" \t\r");
+            line = start == std::string::npos ? std::string() : line.substr(start, end - start + 1);
+            if (!line.empty() && line[0] == '!')
+                continue;
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::string firstToken(const std::string &line)
+    {
+        std::istringstream in(line);
+        std::string token;
+        in >> token;
+        return token;
+    }
+
+    bool parseInt(const std::string &line, long &value)
+    {
+        std::string token = firstToken(line);
+        char *end = nullptr;
+        value = std::strtol(token.c_str(), &end, 10);
+        return !token.empty() && *end == '\0';
+    }
+
+    // A pitch line: cents if it has a '.', else a ratio "a/b" or a whole number
+    bool parsePitch(const std::string &line, double &cents)
+    {
+        std::string token = firstToken(line);
+        if (token.empty())
+            return false;
+        char *end = nullptr;
+        if (token.find('.') != std::string::npos)
+        {
+            cents = std::strtod(token.c_str(), &end);
+            return *end == '\0' && std::isfinite(cents);
+        }
+        double num = (double)std::strtoull(token.c_str(), &end, 10), den = 1.0;
+        if (end == token.c_str())
+            return false;
+        if (*end == '/')
+        {
+            const char *start = end + 1;
+            den = (double)std::strtoull(start, &end, 10);
+            if (end == start)
+                return false;
+        }
+        if (*end != '\0' || num <= 0.0 || den <= 0.0)
+            return false;
+        cents = 1200.0 * std::log2(num / den);
+        return true;
+    }
+
+    bool readFile(const std::string &path, std::string &text, std::string &error)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << in.rdbuf();
+        text = buffer.str();
+        return true;
+    }
+
+    long floorDiv(long a, long b)
+    {
+        long q = a / b;
+        return q - ((a % b != 0) && ((a < 0) != (b < 0)) ? 1 : 0);
+    }
+}
+
+Tuning::Tuning() : description("12-TET"), scaleSize(12)
+{
+    for (int n = 0; n < NOTES; ++n)
+        hz[n] = (float)(440.0 * std::exp2((n - 69) / 12.0));
+}
+
+const Tuning &Tuning::standard()
+{
+    static const Tuning equal;
+    return equal;
+}
+
+bool Tuning::load(const std::string &sclPath, const std::string &kbmPath, std::string &error)
+{
+    std::string scl, kbm;
+    if (!readFile(sclPath, scl, error) || (!kbmPath.empty() && !readFile(kbmPath, kbm, error)))
+        return false;
+    if (parse(scl, kbm, error))
+        return true;
+    error = (kbmPath.empty() ? sclPath : sclPath + " + " + kbmPath) + ": " + error;
+    return false;
+}
+
+bool Tuning::parse(const std::string &scl, const std::string &kbm, std::string &error)
+{
+    // Scale: description, degree count, then one pitch per degree; the last one is the period
+    std::vector<std::string> lines = dataLines(scl);
+    long count = 0;
+    if (lines.size() < 2 || !parseInt(lines[1], count) || count < 1 || count > 1024)
+    {
+        error = "no valid note count";
+        return false;
+    }
+    if ((long)lines.size() < 2 + count)
+    {
+        error = "fewer pitches than the note count";
+        return false;
+    }
+    std::vector<double> scale(count);
+    for (long k = 0; k < count; ++k)
+    {
+        if (!parsePitch(lines[2 + k], scale[k]))
+        {
+            error = "bad pitch \"" + lines[2 + k] + "\"";
+            return false;
+        }
+    }
+
+    // Keyboard mapping; the defaults are what Scala assumes without a file
+    long mapSize = 0, first = 0, last = NOTES - 1, middle = 60, reference = 69, octaveDegree = count;
+    double referenceHz = 440.0;
+    std::vector<long> map;
+    if (!kbm.empty())
+    {
+        std::vector<std::string> k;
+        for (const std::string &line : dataLines(kbm))
+        {
+            if (!line.empty())
+                k.push_back(line);
+        }
+        char *end = nullptr;
+        if (k.size() < 7 || !parseInt(k[0], mapSize) || !parseInt(k[1], first) || !parseInt(k[2], last) ||
+            !parseInt(k[3], middle) || !parseInt(k[4], reference) || !parseInt(k[6], octaveDegree))
+        {
+            error = "keyboard mapping needs map size, note range, middle, reference note, frequency and octave degree";
+            return false;
+        }
+        std::string hzToken = firstToken(k[5]);
+        referenceHz = std::strtod(hzToken.c_str(), &end);
+        if (*end != '\0' || !(referenceHz > 0.0) || mapSize < 0 || mapSize > 1024 || octaveDegree < 0 ||
+            octaveDegree > count)
+        {
+            error = "keyboard mapping values out of range";
+            return false;
+        }
+        // Missing entries at the end count as unmapped
+        map.assign(mapSize, -1);
+        for (long m = 0; m < mapSize && 7 + m < (long)k.size(); ++m)
+        {
+            if (firstToken(k[7 + m]) == "x")
+                continue;
+            if (!parseInt(k[7 + m], map[m]) || map[m] < 0)
+            {
+                error = "bad keyboard map entry \"" + k[7 + m] + "\"";
+                return false;
+            }
+        }
+    }
+
+    // Cents of a scale degree above degree 0, across periods
+    auto degreeCents = [&](long degree)
+    {
+        long period = floorDiv(degree, count), step = degree - period * count;
+        return period * scale[count - 1] + (step ? scale[step - 1] : 0.0);
+    };
+    // Cents of a note above the middle note; false if the mapping leaves it out
+    auto noteCents = [&](long note, double &cents)
+    {
+        if (note < first || note > last)
+            return false;
+        long offset = note - middle;
+        if (mapSize == 0)
+        {
+            cents = degreeCents(offset);
+            return true;
+        }
+        long repeat = floorDiv(offset, mapSize), degree = map[offset - repeat * mapSize];
+        if (degree < 0)
+            return false;
+        cents = degreeCents(degree) + repeat * degreeCents(octaveDegree);
+        return true;
+    };
+
+    double referenceCents;
+    if (!noteCents(reference, referenceCents))
+    {
+        error = "the reference note is not mapped";
+        return false;
+    }
+    for (int n = 0; n < NOTES; ++n)
+    {
+        double cents;
+        hz[n] = noteCents(n, cents) ? (float)(referenceHz * std::exp2((cents - referenceCents) / 1200.0)) : 0.0f;
+    }
+    description = lines[0];
+    scaleSize = (int)count;
+    return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+
+// Note-to-frequency table for the synth parts, sampler and grains. Built on
+// the UI thread, either as 12-TET or from a Scala scale (.scl) with an
+// optional keyboard mapping (.kbm). The audio thread only reads it, so a
+// note-on is a lookup and pitch bend is one multiply. Engine::publishTuning
+// swaps it in.
+class Tuning
+{
+public:
+    static constexpr int NOTES = 128;
+
+    Tuning(); // 12-TET, A4 (note 69) = 440 Hz
+    static const Tuning &standard(); // A shared 12-TET table, for players not handed one yet
+
+    // Without a .kbm, Scala's default mapping: degree 0 on note 60, note 69 at 440 Hz.
+    // On failure the tuning is unchanged and error says why.
+    bool load(const std::string &sclPath, const std::string &kbmPath, std::string &error);
+    // The same from file contents; kbm may be empty
+    bool parse(const std::string &scl, const std::string &kbm, std::string &error);
+
+    // 0 for notes the keyboard mapping leaves out; those do not sound
+    float frequency(int note) const { return note >= 0 && note < NOTES ? hz[note] : 0.0f; }
+    bool mapped(int note) const { return frequency(note) > 0.0f; }
+    // Playback rate of `note` for material recorded at `root`; 0 if either is unmapped
+    float ratio(int root, int note) const { return mapped(root) ? frequency(note) / frequency(root) : 0.0f; }
+    const std::string &name() const { return description; }
+    int degrees() const { return scaleSize; } // Notes per period of the scale
+
+private:
+    float hz[NOTES];
+    std::string description;
+    int scaleSize;
+};
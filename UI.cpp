@@ -567,3 +567,102 @@ void LFOTargetSelector::drawTargetSymbol(SDL_Renderer *renderer, int x, int y, i
         break;
     }
 }
+
+
+// ToggleButton implementation
+ToggleButton::ToggleButton(int x_, int y_, int w_, int h_, SDL_Color color_, int symbol_)
+    : x(x_), y(y_), w(w_), h(h_), on(false), color(color_), symbol(symbol_) {}
+
+void ToggleButton::draw(SDL_Renderer *renderer) const
+{
+    SDL_Rect buttonRect = {x, y, w, h};
+
+    // Shadow/depth effect
+    for (int i = 3; i >= 0; i--)
+    {
+        SDL_Rect shadowRect = {x + i, y + i, w - i * 2, h - i * 2};
+        int alpha = 40 - i * 8;
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, alpha);
+        SDL_RenderFillRect(renderer, &shadowRect);
+    }
+
+    SDL_SetRenderDrawColor(renderer, 20, 25, 35, 240);
+    SDL_RenderFillRect(renderer, &buttonRect);
+
+    if (on)
+    {
+        // Lit state - neon glow around the button
+        for (int i = 3; i >= 0; i--)
+        {
+            SDL_Rect glowRect = {x - i, y - i, w + i * 2, h + i * 2};
+            int alpha = 80 - i * 15;
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, alpha);
+            SDL_RenderDrawRect(renderer, &glowRect);
+        }
+        SDL_Rect contentRect = {x + 3, y + 3, w - 6, h - 6};
+        SDL_SetRenderDrawColor(renderer, color.r / 3, color.g / 3, color.b / 3, 220);
+        SDL_RenderFillRect(renderer, &contentRect);
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+    }
+    else
+    {
+        SDL_SetRenderDrawColor(renderer, color.r / 3, color.g / 3, color.b / 3, 255);
+    }
+    drawSymbol(renderer, x + w / 2, y + h / 2);
+
+    // Glass effect border
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 60);
+    SDL_RenderDrawRect(renderer, &buttonRect);
+}
+
+bool ToggleButton::handleEvent(const SDL_Event &event)
+{
+    if (event.type == SDL_MOUSEBUTTONDOWN)
+    {
+        int mx = event.button.x, my = event.button.y;
+        if (mx >= x && mx < x + w && my >= y && my < y + h)
+        {
+            on = !on;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ToggleButton::drawSymbol(SDL_Renderer *renderer, int cx, int cy) const
+{
+    switch (symbol)
+    {
+    case 0: // Delay - decaying repeats
+        for (int i = 0; i < 4; i++)
+        {
+            int barH = 10 - i * 2;
+            SDL_RenderDrawLine(renderer, cx - 6 + i * 4, cy + 5 - barH, cx - 6 + i * 4, cy + 5);
+        }
+        break;
+    case 1: // Chorus - two offset waves
+        for (int i = 0; i < 12; i++)
+        {
+            SDL_RenderDrawPoint(renderer, cx - 6 + i, cy - 2 + (int)(sin(i * 3.14159f / 3) * 3));
+            SDL_RenderDrawPoint(renderer, cx - 6 + i, cy + 3 + (int)(sin(i * 3.14159f / 3 + 1.5f) * 3));
+        }
+        break;
+    case 2: // Reverb - expanding rings
+        for (int r = 2; r <= 6; r += 2)
+        {
+            for (int i = 0; i < 12; i++)
+            {
+                int px = cx + (int)(cos(i * 3.14159f / 6) * r);
+                int py = cy + (int)(sin(i * 3.14159f / 6) * r);
+                SDL_RenderDrawPoint(renderer, px, py);
+            }
+        }
+        break;
+    default: // Record - filled dot
+    {
+        SDL_Rect dot = {cx - 4, cy - 4, 8, 8};
+        SDL_RenderFillRect(renderer, &dot);
+        break;
+    }
+    }
+}
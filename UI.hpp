@@ -51,3 +51,19 @@ public:
 private:
     void drawTargetSymbol(SDL_Renderer *renderer, int x, int y, int type, bool active) const;
 };
+
+class ToggleButton
+{
+public:
+    int x, y, w, h;
+    bool on;
+    SDL_Color color;
+    int symbol; // Glyph drawn in the centre, see drawSymbol
+
+    ToggleButton(int x_, int y_, int w_, int h_, SDL_Color color_, int symbol_);
+    void draw(SDL_Renderer *renderer) const;
+    bool handleEvent(const SDL_Event &event);
+
+private:
+    void drawSymbol(SDL_Renderer *renderer, int cx, int cy) const;
+};
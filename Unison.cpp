@@ -0,0 +1,139 @@
+#include "Unison.hpp"
+#include "Stereo.hpp"
+#include <cmath>
+#include "FastMath.hpp"
+
+namespace
+{
+    inline float wrap(float p)
+    {
+        return p - (float)(int)p; // p is never negative, so truncation is floor
+    }
+
+    // Lane-friendly shapes on a normalised phase; same curves as WaveForm::generate
+    template <WaveForm::Type T>
+    inline float shape(float p)
+    {
+        if constexpr (T == WaveForm::Sine)
+            return FastMath::sin2piPositive(p); // Stacked detuned copies mask its 1e-3 error
+        else if constexpr (T == WaveForm::Square)
+            return 1.0f - 2.0f * (float)(int)(p * 2.0f);
+        else if constexpr (T == WaveForm::Triangle)
+            return 2.0f * std::fabs(2.0f * (p - (float)(int)(p + 0.5f))) - 1.0f;
+        else
+            return 2.0f * (p - (float)(int)(p + 0.5f));
+    }
+}
+
+Unison::Unison(int voices, float detune, float spread)
+    : voices(voices), detune(detune), spread(spread), randomPhase(true),
+      configuredVoices(-1), configuredDetune(0.0f), configuredSpread(0.0f), rngState(0x9E3779B9u)
+{
+    for (int k = 0; k < MAX_VOICES; ++k)
+        phase[k] = 0.0f;
+    configure();
+}
+
+void Unison::configure()
+{
+    if (voices < 1)
+        voices = 1;
+    if (voices > MAX_VOICES)
+        voices = MAX_VOICES;
+
+    // Equal-power pan law, normalised so the stack is as loud as one oscillator
+    float norm = 1.0f / std::sqrt((float)voices);
+    for (int k = 0; k < MAX_VOICES; ++k)
+    {
+        if (k >= voices)
+        {
+            ratio[k] = 1.0f;
+            gainL[k] = gainR[k] = 0.0f;
+            continue;
+        }
+        float offset = voices > 1 ? 2.0f * k / (voices - 1) - 1.0f : 0.0f; // -1..1
+        ratio[k] = std::exp2(offset * detune / 1200.0f);
+        Stereo::panGains(offset * spread, gainL[k], gainR[k]);
+        gainL[k] *= norm;
+        gainR[k] *= norm;
+    }
+    configuredVoices = voices;
+    configuredDetune = detune;
+    configuredSpread = spread;
+}
+
+void Unison::retrigger()
+{
+    for (int k = 0; k < MAX_VOICES; ++k)
+    {
+        if (randomPhase)
+        {
+            rngState ^= rngState << 13;
+            rngState ^= rngState >> 17;
+            rngState ^= rngState << 5;
+            phase[k] = (rngState >> 8) * (1.0f / 16777216.0f);
+        }
+        else
+        {
+            phase[k] = 0.0f;
+        }
+    }
+}
+
+template <WaveForm::Type T, bool PitchMod>
+void Unison::renderLanes(float *left, float *right, int frames, float inc, const float *pitchMul)
+{
+    // Lane count rounded up to a full SSE vector; spare lanes have zero gain
+    const int lanes = (voices + 3) & ~3;
+    alignas(32) float lanePhase[MAX_VOICES];
+    alignas(32) float laneInc[MAX_VOICES];
+    for (int k = 0; k < lanes; ++k)
+    {
+        lanePhase[k] = phase[k];
+        laneInc[k] = inc * ratio[k];
+    }
+
+    for (int i = 0; i < frames; ++i)
+    {
+        float mul = 1.0f;
+        if constexpr (PitchMod)
+            mul = pitchMul[i];
+
+        // Four partial sums, one per SIMD lane, keep the lane loop free of a serial reduction
+        alignas(16) float accL[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        alignas(16) float accR[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int g = 0; g < lanes; g += 4)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                int k = g + j;
+                lanePhase[k] = wrap(lanePhase[k] + laneInc[k] * mul);
+                float s = shape<T>(lanePhase[k]);
+                accL[j] += s * gainL[k];
+                accR[j] += s * gainR[k];
+            }
+        }
+        left[i] = (accL[0] + accL[1]) + (accL[2] + accL[3]);
+        right[i] = (accR[0] + accR[1]) + (accR[2] + accR[3]);
+    }
+
+    for (int k = 0; k < lanes; ++k)
+        phase[k] = lanePhase[k];
+}
+
+template <WaveForm::Type T>
+void Unison::render(float *left, float *right, int frames, float inc, const float *pitchMul)
+{
+    if (voices != configuredVoices || detune != configuredDetune || spread != configuredSpread)
+        configure();
+
+    if (pitchMul)
+        renderLanes<T, true>(left, right, frames, inc, pitchMul);
+    else
+        renderLanes<T, false>(left, right, frames, inc, pitchMul);
+}
+
+template void Unison::render<WaveForm::Sine>(float *, float *, int, float, const float *);
+template void Unison::render<WaveForm::Square>(float *, float *, int, float, const float *);
+template void Unison::render<WaveForm::Triangle>(float *, float *, int, float, const float *);
+template void Unison::render<WaveForm::Saw>(float *, float *, int, float, const float *);
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include "WaveForm.hpp"
+
+// Stack of detuned copies of one oscillator, stored lane-wise (one oscillator per
+// SIMD lane) so the per-frame loop over lanes vectorises. Phases are normalised 0..1.
+class Unison
+{
+public:
+    static constexpr int MAX_VOICES = 16;
+
+    int voices;       // Active oscillators (1 = plain single oscillator)
+    float detune;     // Outermost detune in cents
+    float spread;     // Stereo width 0..1
+    bool randomPhase; // Randomise lane phases on every note-on
+
+    alignas(32) float phase[MAX_VOICES];
+    alignas(32) float ratio[MAX_VOICES]; // Frequency multiplier per lane
+    alignas(32) float gainL[MAX_VOICES];
+    alignas(32) float gainR[MAX_VOICES];
+
+    Unison(int voices = 1, float detune = 20.0f, float spread = 0.8f);
+    void configure(); // Recompute ratios and pan gains after changing voices/detune/spread
+    void retrigger();
+    // inc: base phase increment per frame (cycles), pitchMul: optional per-frame multiplier
+    template <WaveForm::Type T>
+    void render(float *left, float *right, int frames, float inc, const float *pitchMul);
+
+private:
+    int configuredVoices;
+    float configuredDetune, configuredSpread;
+    uint32_t rngState;
+
+    template <WaveForm::Type T, bool PitchMod>
+    void renderLanes(float *left, float *right, int frames, float inc, const float *pitchMul);
+};
@@ -0,0 +1,185 @@
+#include "WavFile.hpp"
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    uint32_t readU32(const unsigned char *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+    uint16_t readU16(const unsigned char *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    void writeU32(unsigned char *p, uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i)
+            p[i] = (unsigned char)(v >> (8 * i));
+    }
+    void writeU16(unsigned char *p, uint16_t v)
+    {
+        p[0] = (unsigned char)v;
+        p[1] = (unsigned char)(v >> 8);
+    }
+}
+
+WavFile::WavFile() : sampleRate(0), channels(0) {}
+
+bool WavFile::parseLayout(const unsigned char *bytes, size_t size, Layout &layout, std::string &error)
+{
+    if (size < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0)
+    {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    bool haveFormat = false;
+    size_t offset = 12;
+    while (offset + 8 <= size)
+    {
+        const unsigned char *chunk = bytes + offset;
+        uint32_t chunkSize = readU32(chunk + 4);
+        size_t body = offset + 8;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0)
+        {
+            if (chunkSize < 16 || body + chunkSize > size)
+                break;
+            layout.format = readU16(bytes + body);
+            layout.channels = readU16(bytes + body + 2);
+            layout.sampleRate = (int)readU32(bytes + body + 4);
+            layout.bits = readU16(bytes + body + 14);
+            if (layout.format == 0xFFFE && chunkSize >= 26)
+                layout.format = readU16(bytes + body + 24); // Sub-format GUID starts with the plain format tag
+            haveFormat = true;
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (!haveFormat || layout.channels <= 0)
+            {
+                error = "data chunk before fmt chunk";
+                return false;
+            }
+            int f = layout.format, b = layout.bits;
+            if (!((f == 1 && (b == 8 || b == 16 || b == 24 || b == 32)) || (f == 3 && b == 32)))
+            {
+                error = "unsupported sample format";
+                return false;
+            }
+            layout.dataOffset = body;
+            layout.dataBytes = std::min<size_t>(chunkSize, size - body); // Tolerate truncated files
+            size_t frameBytes = (size_t)layout.channels * (b / 8);
+            layout.frames = layout.dataBytes / frameBytes;
+            return true;
+        }
+        offset = body + chunkSize + (chunkSize & 1); // Chunks are word aligned
+    }
+
+    error = "no audio data found";
+    return false;
+}
+
+void WavFile::decode(const unsigned char *src, const Layout &layout, size_t count, float *dst)
+{
+    // One loop per format so the conversion loop itself has no branches
+    if (layout.format == 3)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t u = readU32(src + i * 4);
+            std::memcpy(&dst[i], &u, 4);
+        }
+    }
+    else if (layout.bits == 8)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = (src[i] - 128) / 128.0f;
+    }
+    else if (layout.bits == 16)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = (int16_t)readU16(src + i * 2) / 32768.0f;
+    }
+    else if (layout.bits == 24)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const unsigned char *p = src + i * 3;
+            dst[i] = (int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24)) / 2147483648.0f;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = (int32_t)readU32(src + i * 4) / 2147483648.0f;
+    }
+}
+
+bool WavFile::load(const std::string &path, std::string &error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Layout layout;
+    if (!parseLayout(bytes.data(), bytes.size(), layout, error))
+    {
+        error = path + ": " + error;
+        return false;
+    }
+    channels = layout.channels;
+    sampleRate = layout.sampleRate;
+    samples.resize(layout.frames * layout.channels);
+    decode(bytes.data() + layout.dataOffset, layout, samples.size(), samples.data());
+    return true;
+}
+
+bool WavFile::save(const std::string &path, std::string &error) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "cannot create " + path;
+        return false;
+    }
+
+    uint32_t dataBytes = (uint32_t)(samples.size() * sizeof(float));
+    unsigned char header[HEADER_BYTES];
+    writeHeader(header, channels, sampleRate, dataBytes);
+
+    file.write((const char *)header, sizeof(header));
+    file.write((const char *)samples.data(), dataBytes); // Host byte order; all our targets are little-endian
+    if (!file)
+    {
+        error = "write failed for " + path;
+        return false;
+    }
+    return true;
+}
+
+void WavFile::writeHeader(unsigned char *header, int channels, int sampleRate, uint32_t dataBytes)
+{
+    std::memcpy(header, "RIFF", 4);
+    writeU32(header + 4, 36 + dataBytes);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    writeU32(header + 16, 16);
+    writeU16(header + 20, 3); // IEEE float
+    writeU16(header + 22, (uint16_t)channels);
+    writeU32(header + 24, (uint32_t)sampleRate);
+    writeU32(header + 28, (uint32_t)(sampleRate * channels * sizeof(float)));
+    writeU16(header + 32, (uint16_t)(channels * sizeof(float)));
+    writeU16(header + 34, 32);
+    std::memcpy(header + 36, "data", 4);
+    writeU32(header + 40, dataBytes);
+}
+
+std::vector<float> WavFile::channel(int c) const
+{
+    int n = frames();
+    std::vector<float> out(n);
+    for (int i = 0; i < n; ++i)
+        out[i] = samples[(size_t)i * channels + c];
+    return out;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// RIFF/WAVE file held in memory as interleaved floats.
+// Reads 8/16/24/32-bit PCM and 32-bit float, including WAVE_FORMAT_EXTENSIBLE;
+// writes 32-bit float.
+class WavFile
+{
+public:
+    static constexpr int HEADER_BYTES = 44;
+
+    // Where the audio lives inside a file image, so callers can decode straight from mapped memory
+    struct Layout
+    {
+        int format = 0; // 1 = PCM, 3 = float
+        int channels = 0;
+        int sampleRate = 0;
+        int bits = 0;
+        size_t dataOffset = 0;
+        size_t dataBytes = 0;
+        size_t frames = 0;
+    };
+
+    int sampleRate;
+    int channels;
+    std::vector<float> samples; // Interleaved
+
+    WavFile();
+    bool load(const std::string &path, std::string &error);
+    bool save(const std::string &path, std::string &error) const;
+    int frames() const { return channels > 0 ? (int)(samples.size() / channels) : 0; }
+    std::vector<float> channel(int c) const; // De-interleaved copy of one channel
+
+    static bool parseLayout(const unsigned char *bytes, size_t size, Layout &layout, std::string &error);
+    // Converts count interleaved samples starting at src to float
+    static void decode(const unsigned char *src, const Layout &layout, size_t count, float *dst);
+    // Canonical 32-bit float header, for writers that stream the data themselves
+    static void writeHeader(unsigned char *header, int channels, int sampleRate, uint32_t dataBytes);
+};
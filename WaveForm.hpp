@@ -1,10 +1,35 @@
 #pragma once
 #include <SDL2/SDL.h>
 #include <cmath>
+#include "FastMath.hpp"
 
 class WaveForm {
 public:
     enum Type { Sine, Square, Triangle, Saw };
     static float generate(Type type, float phase);
+    // Compile-time variant used by the render kernels: no switch in the inner loop.
+    // Oscillators take libm's sine, which no FastMath tier matches for speed at
+    // its accuracy; the LFO (Control) takes the Fast sine on its 0..2pi phase.
+    template <Type T, bool Control = false>
+    static inline float generate(float phase);
     static void draw(SDL_Renderer* renderer, Type type, float freq, float phase, int x, int y, int w, int h);
 };
+
+template <WaveForm::Type T, bool Control>
+inline float WaveForm::generate(float phase)
+{
+    if constexpr (T == Sine)
+        return Control ? FastMath::sinPositive(phase) : std::sin(phase);
+    else if constexpr (T == Square)
+        return ((Control ? FastMath::sinPositive(phase) : std::sin(phase)) > 0) ? 1.0f : -1.0f;
+    else if constexpr (T == Triangle)
+    {
+        float t = phase / (2.0f * (float)M_PI);
+        return 2.0f * std::abs(2.0f * (t - std::floor(t + 0.5f))) - 1.0f;
+    }
+    else
+    {
+        float t = phase / (2.0f * (float)M_PI);
+        return 2.0f * (t - std::floor(t + 0.5f));
+    }
+}
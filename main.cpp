@@ -12,26 +12,100 @@
 #include "Synth.hpp"
 #include "Filter.hpp"
 #include "LFO.hpp"
+#include "Engine.hpp"
+#include "MidiFile.hpp"
+#include "WavFile.hpp"
+#include "Benchmark.hpp"
+#include "RtCheck.hpp"
+#include "GoldenRender.hpp"
+#include "Stereo.hpp"
+#include "Recorder.hpp"
+#include "LatencyProbe.hpp"
+#include "Tuning.hpp"
+#include "Trace.hpp"
+#include "RealTime.hpp"
+#include "Resampler.hpp"
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <ctime>
+#include <filesystem>
 
 #define SAMPLE_RATE 44100
 #define TWO_PI (3.14159f * 2)
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 300
 
-Synth synth;
+Engine engine;
+Recorder recorder;
+LatencyProbe probe; // Enabled by --latency
+Tuning keyTuning;   // UI copy of the tuning last handed to the engine, for display
+RealTime::Deferred audioPolicy; // Applied by the first audio callback, on the host's thread
+Resampler deviceResampler;      // Engine rate to --device-rate; left unconfigured when they match
+int deviceRate = SAMPLE_RATE;
+
+// Fills frames at the device rate, offset frames into the callback buffer:
+// straight from the engine, or pulled through the resampler. The probe and
+// the recorder see engine frames either way.
+void renderDevice(float *left, float *right, int frames, int offset)
+{
+    if (!deviceResampler.configured())
+    {
+        uint32_t consumed = engine.inboxConsumed();
+        engine.render(left, right, frames);
+        probe.afterRender(consumed, engine.inboxConsumed(), left, right, frames, offset);
+        recorder.push(left, right, frames);
+        return;
+    }
+    int engineOffset = (int)(offset / deviceResampler.ratio()) + deviceResampler.latency();
+    deviceResampler.pull(left, right, frames, [&](float *l, float *r, int n)
+                         {
+        uint32_t consumed = engine.inboxConsumed();
+        engine.render(l, r, n);
+        probe.afterRender(consumed, engine.inboxConsumed(), l, r, n, engineOffset);
+        recorder.push(l, r, n);
+        engineOffset += n; });
+}
+
 int audioCallback(const void *, void *outputBuffer, unsigned long framesPerBuffer,
-                  const PaStreamCallbackTimeInfo *, PaStreamCallbackFlags, void *)
+                  const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags, void *)
 {
+    audioPolicy.applyOnce(); // System calls, so ahead of the checked scope
+    RtCheck::Scope realtime;
+    Trace::nameThread("audio");
+    Trace::Zone zone("audio callback");
+    probe.beginCallback(timeInfo, SAMPLE_RATE);
     float *out = (float *)outputBuffer;
-    for (unsigned long i = 0; i < framesPerBuffer; ++i)
+    float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+    unsigned long done = 0;
+    while (done < framesPerBuffer)
     {
-        float sample = synth.process(1.0f / SAMPLE_RATE);
-        out[i * 2] = sample;
-        out[i * 2 + 1] = sample;
+        unsigned long n = framesPerBuffer - done;
+        if (n > (unsigned long)Synth::MAX_BLOCK)
+            n = Synth::MAX_BLOCK;
+        renderDevice(left, right, (int)n, (int)done);
+        Stereo::interleave(left, right, out + done * 2, (int)n);
+        done += n;
     }
     return paContinue;
 }
 
+// Non-interleaved stream: the engine renders straight into the host's channel buffers, unless resampled
+int audioCallbackPlanar(const void *, void *outputBuffer, unsigned long framesPerBuffer,
+                        const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags, void *)
+{
+    audioPolicy.applyOnce();
+    RtCheck::Scope realtime;
+    Trace::nameThread("audio");
+    Trace::Zone zone("audio callback");
+    probe.beginCallback(timeInfo, SAMPLE_RATE);
+    float **out = (float **)outputBuffer;
+    renderDevice(out[0], out[1], (int)framesPerBuffer, 0);
+    return paContinue;
+}
+
 void drawControlLabel(SDL_Renderer *renderer, int x, int y, const std::string &label)
 {
     // Futuristic neon label with HUD styling
@@ -135,10 +209,701 @@ void drawControlLabel(SDL_Renderer *renderer, int x, int y, const std::string &l
     }
 }
 
+// The whole file through a fresh resampler to rate, with its latency trimmed
+// so the result lines up with the original
+bool resampleWav(WavFile &wav, int rate, std::string &error)
+{
+    Resampler resampler;
+    if (!resampler.configure(wav.sampleRate, rate, 64, 0.9f, error))
+        return false;
+    std::vector<float> left = wav.channel(0), right = wav.channel(1);
+    left.resize(left.size() + resampler.latency(), 0.0f); // Flushes the tail out of the filter
+    right.resize(left.size(), 0.0f);
+    std::vector<float> outL(resampler.maxOutput((int)left.size())), outR(outL.size());
+    int frames = resampler.process(left.data(), right.data(), (int)left.size(), outL.data(), outR.data());
+    int skip = std::min(frames, (int)std::lround(resampler.latency() * resampler.ratio()));
+    wav.samples.clear();
+    for (int i = skip; i < frames; ++i)
+    {
+        wav.samples.push_back(outL[i]);
+        wav.samples.push_back(outR[i]);
+    }
+    wav.sampleRate = rate;
+    return true;
+}
+
+// After startWorkers: what each of target's part workers got from its policy
+void reportWorkers(const Engine &target)
+{
+    if (!target.workerPolicy.requested())
+        return;
+    for (int i = 0; i < target.workers(); ++i)
+    {
+        std::string name = "part worker " + std::to_string(i);
+        std::cout << RealTime::describe(name.c_str(), target.workerPolicy, target.workerStatus(i), i) << "\n";
+    }
+}
+
+// What an offline render plays and how, filled in by the argument parser
+struct RenderOptions
+{
+    std::string midiPath, impulsePath, samplesPath, automationPath, outPath;
+    bool limit = true, softClip = false;
+    int outRate = SAMPLE_RATE;      // Written file's rate, resampled from the engine rate
+    int threads = 0;                // Helper threads rendering synth parts alongside the render thread
+    const Tuning *tuning = nullptr; // Null for 12-TET
+};
+
+// Renders a MIDI file through a private engine as fast as possible, optionally
+// replaying recorded automation from the first sample; no audio device is opened
+int renderOffline(const RenderOptions &options)
+{
+    std::vector<Event> events;
+    std::string error;
+    if (!MidiFile::load(options.midiPath, SAMPLE_RATE, events, error))
+    {
+        std::cerr << "MIDI load failed: " << error << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<Engine> offline(new Engine());
+    offline->prepare(SAMPLE_RATE);
+    offline->convolution.synchronous = true; // Deterministic output, no worker thread
+    if (!options.impulsePath.empty())
+    {
+        WavFile ir;
+        if (!ir.load(options.impulsePath, error))
+        {
+            std::cerr << "Impulse load failed: " << error << "\n";
+            return 1;
+        }
+        offline->convolution.setImpulse(ir.channel(0), ir.channels > 1 ? ir.channel(1) : std::vector<float>(), (float)ir.sampleRate);
+        offline->convolution.enabled = true;
+    }
+    if (!options.samplesPath.empty())
+    {
+        if (!offline->sampler.load(options.samplesPath, error))
+        {
+            std::cerr << "Sample load failed: " << error << "\n";
+            return 1;
+        }
+        offline->sampler.synchronous = true; // Stream inline instead of racing a thread
+    }
+    offline->setTimeline(&events);
+    if (options.tuning)
+        offline->publishTuning(new Tuning(*options.tuning)); // Swapped in by the first render
+    offline->workerPolicy = engine.workerPolicy; // From --rt-policy and --worker-cpus
+    offline->startWorkers(options.threads);
+    reportWorkers(*offline);
+    offline->limiter.enabled = options.limit;
+    offline->limiter.softClip = options.softClip;
+    uint64_t automationLength = 0;
+    if (!options.automationPath.empty())
+    {
+        std::unique_ptr<Automation> lanes(new Automation());
+        if (!lanes->load(options.automationPath, error))
+        {
+            std::cerr << "Automation load failed: " << error << "\n";
+            return 1;
+        }
+        automationLength = lanes->length();
+        offline->publishAutomation(lanes.release());
+        offline->playAutomation(true);
+    }
+
+    // Two extra seconds for the release and effect tails
+    uint64_t end = std::max<uint64_t>(events.empty() ? 0 : events.back().time, automationLength) + 2 * SAMPLE_RATE;
+    WavFile out;
+    out.sampleRate = SAMPLE_RATE;
+    out.channels = 2;
+    out.samples.reserve(end * 2);
+
+    // The limiter's delay is rendered past the end and trimmed from the start, so the file lines up with the MIDI
+    const uint64_t delay = options.limit ? offline->limiter.latency() : 0;
+    float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+    while (offline->time() < end + delay)
+    {
+        uint64_t start = offline->time();
+        int n = (int)std::min<uint64_t>(Synth::MAX_BLOCK, end + delay - start);
+        offline->render(left, right, n);
+        for (int i = (int)std::min<uint64_t>(n, delay - std::min(delay, start)); i < n; ++i)
+        {
+            out.samples.push_back(left[i]);
+            out.samples.push_back(right[i]);
+        }
+    }
+
+    offline->stopWorkers();
+
+    if (options.outRate != SAMPLE_RATE && !resampleWav(out, options.outRate, error))
+    {
+        std::cerr << "Resampling failed: " << error << "\n";
+        return 1;
+    }
+    if (!out.save(options.outPath, error))
+    {
+        std::cerr << "WAV write failed: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Rendered " << events.size() << " events, " << out.frames() / (float)out.sampleRate << " s at "
+              << out.sampleRate << " Hz -> " << options.outPath << "\n";
+    return 0;
+}
+
+// Starts a take in a time-stamped file in the working directory, or ends the current one
+void setRecording(bool on, double preallocateSeconds)
+{
+    std::string error;
+    if (on)
+    {
+        char name[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(name, sizeof(name), "recording_%Y%m%d_%H%M%S.wav", std::localtime(&now));
+        if (recorder.start(name, SAMPLE_RATE, error, preallocateSeconds))
+            std::cout << "Recording to " << name << "\n";
+        else
+            std::cerr << "Recording failed: " << error << "\n";
+        return;
+    }
+    double seconds = recorder.seconds();
+    if (!recorder.stop(error))
+        std::cerr << "Recording failed: " << error << "\n";
+    std::cout << "Recorded " << seconds << " s to " << recorder.filePath() << ", " << recorder.overruns
+              << " overrun(s), " << recorder.droppedFrames << " frame(s) dropped\n";
+}
+
+// UI thread: loads a WAV as the grain source; the audio thread picks it up at its next callback
+bool loadGrainSource(const std::string &path)
+{
+    std::string error;
+    std::unique_ptr<Granular::Source> source(new Granular::Source());
+    if (!source->load(path, error))
+    {
+        std::cerr << "Grain source failed: " << error << "\n";
+        return false;
+    }
+    std::cout << "Grains: " << source->frames / source->sampleRate << " s from " << path << "\n";
+    engine.granular.publishSource(source.release());
+    return true;
+}
+
+// Stops the capture started with Trace::start and writes it as Chrome trace JSON
+void finishTrace(const std::string &path)
+{
+    Trace::stop();
+    std::string error;
+    if (Trace::write(path, error))
+        std::cout << "Trace: " << Trace::events() << " spans, " << Trace::dropped() << " dropped -> " << path << "\n";
+    else
+        std::cerr << "Trace failed: " << error << "\n";
+}
+
+// Thread policies for the audio callback and the part workers from the command
+// line. Workers run one priority step below the callback, so a worker spinning
+// on a shared core cannot hold it off. Any request also prefaults some stack
+// unless --prefault-stack says otherwise.
+bool setThreadPolicies(const std::string &scheduler, int priority, const std::string &audioCpus,
+                       const std::string &workerCpus, int prefaultKb)
+{
+    RealTime::ThreadPolicy audio;
+    if (scheduler == "fifo")
+        audio.scheduler = RealTime::Scheduler::Fifo;
+    else if (scheduler == "rr")
+        audio.scheduler = RealTime::Scheduler::RoundRobin;
+    else if (!scheduler.empty())
+    {
+        std::cerr << "--rt-policy takes fifo or rr, not " << scheduler << "\n";
+        return false;
+    }
+    if (priority < 2 || priority > 99)
+    {
+        std::cerr << "--rt-priority must be 2..99\n";
+        return false;
+    }
+    audio.priority = priority;
+    RealTime::ThreadPolicy worker = audio;
+    worker.priority = priority - 1;
+    if (!audioCpus.empty() && !RealTime::parseCpus(audioCpus, audio.cpus))
+    {
+        std::cerr << "bad CPU list for --audio-cpus: " << audioCpus << "\n";
+        return false;
+    }
+    if (!workerCpus.empty() && !RealTime::parseCpus(workerCpus, worker.cpus))
+    {
+        std::cerr << "bad CPU list for --worker-cpus: " << workerCpus << "\n";
+        return false;
+    }
+    size_t prefault = prefaultKb >= 0 ? (size_t)prefaultKb * 1024 : 0;
+    if (prefaultKb < 0 && (audio.requested() || worker.requested()))
+        prefault = 256 * 1024;
+    audio.prefaultStack = worker.prefaultStack = std::min(prefault, RealTime::MAX_PREFAULT);
+    audioPolicy.set(audio);
+    engine.workerPolicy = worker;
+    return true;
+}
+
+// UI thread: prints the quality steps the governor took since the last call
+// when print is set; returns how many there were
+int drainQualitySteps(bool print)
+{
+    int count = 0;
+    QualityGovernor::Step step;
+    while (engine.quality.nextStep(step))
+    {
+        if (print)
+            std::cout << "Quality: " << (step.to > step.from ? "down" : "up") << " to level " << step.to << " ("
+                      << QualityGovernor::settings(step.to).name << ") at " << step.time / (double)SAMPLE_RATE
+                      << " s, load " << (int)(step.load * 100.0f + 0.5f) << "%\n";
+        ++count;
+    }
+    return count;
+}
+
+// UI thread: loads a Scala scale, and optionally a keyboard mapping, for every player
+bool loadTuning(const std::string &sclPath, const std::string &kbmPath)
+{
+    std::string error;
+    std::unique_ptr<Tuning> tuning(new Tuning());
+    if (!tuning->load(sclPath, kbmPath, error))
+    {
+        std::cerr << "Tuning failed: " << error << "\n";
+        return false;
+    }
+    std::cout << "Tuning: " << tuning->name() << ", " << tuning->degrees() << " notes per period\n";
+    keyTuning = *tuning;
+    engine.publishTuning(tuning.release());
+    return true;
+}
+
+// Two tracks to start from: a 16-step minor arpeggio, and a 6-step track of
+// cutoff/decay locks that drifts against it
+void loadDemoPattern(Sequencer &seq)
+{
+    const int8_t notes[16] = {48, 55, 60, 63, 67, 63, 60, 55, 46, 53, 58, 62, 65, 62, 58, 53};
+    Sequencer::Track &arp = seq.patterns[0].tracks[0];
+    for (int i = 0; i < 16; ++i)
+    {
+        arp.steps[i].note = notes[i];
+        arp.steps[i].velocity = (i % 4 == 0) ? 120 : 90;
+        arp.steps[i].gate = (i % 4 == 0) ? 0.8f : 0.4f;
+    }
+    Sequencer::Track &locks = seq.patterns[0].tracks[1];
+    locks.length = 6;
+    locks.steps[0].lock(Param::Cutoff, 0.9f);
+    locks.steps[2].lock(Param::Cutoff, 0.3f);
+    locks.steps[3].lock(Param::Decay, 0.8f);
+    locks.steps[4].lock(Param::Cutoff, 0.6f);
+}
+
+// Device rate other than the engine's: designs the filter, then prints its
+// latency and what converting one second costs, timed on a copy fed silence
+bool configureDeviceRate(int rate)
+{
+    std::string error;
+    if (!deviceResampler.configure(SAMPLE_RATE, rate, 64, 0.9f, error))
+    {
+        std::cerr << "Device rate: " << error << "\n";
+        return false;
+    }
+    deviceRate = rate;
+    Resampler timing = deviceResampler;
+    float left[Synth::MAX_BLOCK], right[Synth::MAX_BLOCK];
+    auto silence = [](float *l, float *r, int n)
+    {
+        std::fill(l, l + n, 0.0f);
+        std::fill(r, r + n, 0.0f);
+    };
+    auto start = std::chrono::steady_clock::now();
+    for (int done = 0; done < rate; done += Synth::MAX_BLOCK)
+        timing.pull(left, right, Synth::MAX_BLOCK, silence);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Device rate: " << SAMPLE_RATE << " -> " << rate << " Hz, " << deviceResampler.taps() << " taps, "
+              << (deviceResampler.exact() ? std::to_string(deviceResampler.phases()) + " exact phases"
+                                          : "interpolated between " + std::to_string(deviceResampler.phases()) + " phases")
+              << ", " << 1000.0 * deviceResampler.latencySeconds() << " ms latency, " << 1e9 * seconds / rate
+              << " ns/frame (" << 100.0 * seconds << "% of a core)\n";
+    return true;
+}
+
+// Drives both audio callbacks through a scripted session under the real-time checker:
+// every waveform and LFO target, unison, FM algorithms, all effects, convolution with a live
+// impulse swap, a note/pitch-bend timeline, a sequencer that is re-published
+// while it plays, the arpeggiator fed from the live event queue, knob automation
+// replayed and re-published, a recording of the whole session, the latency
+// probe tracking the live notes, two more parts rendered on a helper
+// thread, a dense grain cloud, tuning swaps under held notes, a quality
+// governor tuned to step up and down all the time, the master limiter with its
+// 2x clipper switched in and out, and the output resampled to a 48 kHz device
+// (or --device-rate), all traced, with the audio and worker stacks prefaulted.
+// Fails on any violation.
+int runRtCheck(const std::string &samplesPath)
+{
+    if (!RtCheck::available)
+    {
+        RtCheck::report();
+        return 2;
+    }
+
+    std::vector<Event> events;
+    for (int i = 0; i < 40; ++i)
+    {
+        uint64_t t = (uint64_t)i * SAMPLE_RATE / 5;
+        uint8_t note = (uint8_t)(48 + (i * 7) % 24);
+        events.push_back({t, EventType::NoteOn, 0, note, 100, 0.0f});
+        events.push_back({t + SAMPLE_RATE / 10, EventType::PitchBend, 0, 0, 0, (i % 5 - 2) / 2.0f});
+        events.push_back({t + SAMPLE_RATE / 7, EventType::NoteOff, 0, note, 0, 0.0f});
+    }
+    events.push_back({(uint64_t)9 * SAMPLE_RATE, EventType::Controller, 0, 123, 0, 0.0f});
+    std::sort(events.begin(), events.end(), [](const Event &a, const Event &b)
+              { return a.time < b.time; });
+
+    std::vector<float> irL(SAMPLE_RATE), irR(SAMPLE_RATE);
+    for (int i = 0; i < SAMPLE_RATE; ++i)
+    {
+        float decay = std::exp(-6.9f * i / SAMPLE_RATE);
+        irL[i] = std::sin(i * 0.37f) * decay;
+        irR[i] = std::cos(i * 0.53f) * decay;
+    }
+
+    engine.prepare(SAMPLE_RATE);
+    engine.limiter.softClip = true; // Changes the latency, so set once rather than between callbacks
+    if (!deviceResampler.configured() && !configureDeviceRate(48000))
+        return 1;
+    engine.convolution.start();
+    engine.convolution.setImpulse(irL, irR, SAMPLE_RATE);
+    engine.convolution.enabled = true;
+    std::string error;
+    if (!samplesPath.empty())
+    {
+        if (!engine.sampler.load(samplesPath, error))
+        {
+            std::cerr << "Sample load failed: " << error << "\n";
+            return 1;
+        }
+        engine.sampler.start();
+    }
+    // Stack prefaulting on top of whatever the command line asked for; the
+    // policy is applied by the first callback, outside the checked scope
+    RealTime::ThreadPolicy audio = audioPolicy.get();
+    if (audio.prefaultStack == 0)
+        audio.prefaultStack = 64 * 1024;
+    audioPolicy.set(audio);
+    if (engine.workerPolicy.prefaultStack == 0)
+        engine.workerPolicy.prefaultStack = 64 * 1024;
+    Synth &synth = engine.synth;
+    synth.unison.voices = 7;
+    synth.unison.configure();
+    synth.lfo.enabled = true;
+    // Bass and pad parts on channels 1 and 2, rendered by a helper thread
+    engine.parts[1].patch.waveType = WaveForm::Saw;
+    engine.parts[1].polyphony = 2;
+    engine.parts[2].patch.waveType = WaveForm::Triangle;
+    engine.parts[2].patch.unison.voices = 3;
+    engine.parts[2].patch.unison.configure();
+    engine.parts[2].polyphony = 3;
+    engine.startWorkers(1);
+    reportWorkers(engine);
+    // Thresholds either side of a typical load here, so every level gets visited
+    engine.quality.enabled = true;
+    engine.quality.degradeAbove = engine.quality.restoreBelow = 0.05f;
+    engine.quality.restoreAfter = 2;
+    int qualitySteps = 0;
+    // A dense grain cloud on channel 3, from a source built here and swapped mid-run
+    auto grainSource = [](float hz)
+    {
+        Granular::Source *source = new Granular::Source();
+        source->frames = SAMPLE_RATE * 2;
+        source->left.resize(source->frames);
+        source->right.resize(source->frames);
+        for (int i = 0; i < source->frames; ++i)
+        {
+            source->left[i] = 0.5f * std::sin(i * hz * 2.0f * (float)M_PI / SAMPLE_RATE);
+            source->right[i] = 0.5f * std::sin(i * hz * 3.0f * (float)M_PI / SAMPLE_RATE);
+        }
+        return source;
+    };
+    engine.granular.publishSource(grainSource(220.0f));
+    engine.granular.part = 3;
+    engine.granular.density = 2000.0f;
+    engine.granular.size = 0.2f;
+    engine.granular.pitchSpray = 7.0f;
+    int peakGrains = 0;
+    Tuning edo19;
+    std::string scl19 = "19-EDO\n19\n";
+    for (int k = 1; k <= 19; ++k)
+        scl19 += std::to_string(1200.0 * k / 19) + "\n";
+    if (!edo19.parse(scl19, "", error))
+    {
+        std::cerr << "Tuning failed: " << error << "\n";
+        return 1;
+    }
+    engine.setTimeline(&events);
+    Sequencer seq;
+    loadDemoPattern(seq);
+    engine.publishSequence(seq.compile(SAMPLE_RATE));
+    engine.playSequence(true);
+    Automation sweep;
+    for (int i = 0; i < 400; ++i)
+    {
+        sweep.record((uint64_t)i * SAMPLE_RATE / 100, Param::Cutoff, 0.5f + 0.5f * std::sin(i * 0.05f));
+        sweep.record((uint64_t)i * SAMPLE_RATE / 100, Param::LfoRate, (i % 20) / 20.0f);
+    }
+    engine.publishAutomation(new Automation(sweep));
+    engine.playAutomation(true);
+    probe.enabled = true;
+    std::string takePath = (std::filesystem::temp_directory_path() / "synth_rt_check.wav").string();
+    if (!recorder.start(takePath, SAMPLE_RATE, error, 10.0))
+    {
+        std::cerr << "Recording failed: " << error << "\n";
+        return 1;
+    }
+
+    // Odd buffer size so callbacks straddle the synth block size
+    const unsigned long frames = 300;
+    std::vector<float> out(frames * 2);
+    float *planar[2] = {out.data(), out.data() + frames};
+    const uint64_t end = (uint64_t)10 * SAMPLE_RATE;
+    int step = 0;
+    std::string tracePath = (std::filesystem::temp_directory_path() / "synth_rt_check.json").string();
+    Trace::start(1 << 16);
+    RtCheck::reset();
+    while (engine.time() < end)
+    {
+        // Parameter changes happen between callbacks, as the UI thread would make them
+        if (engine.time() >= (uint64_t)step * SAMPLE_RATE / 2)
+        {
+            synth.waveType = (WaveForm::Type)(step % 4);
+            synth.lfo.target = (LFOTarget)(step / 4 % 4);
+            synth.lfo.waveform = (WaveForm::Type)(step / 2 % 4);
+            synth.fm.enabled = step % 3 == 1;
+            synth.fm.algorithm = step % FM::NUM_ALGORITHMS;
+            engine.effects.delay.enabled = step % 2 == 0;
+            engine.effects.chorus.enabled = step % 3 != 0;
+            engine.effects.reverb.enabled = step % 4 != 1;
+            if (step == 10)
+                engine.convolution.setImpulse(irR, irL, SAMPLE_RATE);
+            // Edit under playback: move a note and re-publish
+            seq.patterns[0].tracks[0].steps[step % 16].note = (int8_t)(60 + step % 12);
+            seq.bpm = 100.0f + 10.0f * (step % 5);
+            engine.publishSequence(seq.compile(SAMPLE_RATE));
+            engine.arp.enabled = step >= 6 && step < 16;
+            engine.arp.mode = (Arpeggiator::Mode)(step % 4);
+            engine.arp.octaves = 1 + step % 3;
+            auto now = LatencyProbe::Clock::now();
+            probe.markInput(now, now, engine.inboxPosted());
+            engine.postEvent({0, EventType::NoteOn, 0, (uint8_t)(50 + step), 100, 0.0f});
+            engine.postEvent({0, EventType::NoteOff, 0, (uint8_t)(49 + step), 0, 0.0f});
+            engine.postEvent({0, EventType::NoteOn, 1, (uint8_t)(36 + step % 12), 100, 0.0f});
+            for (int n = 0; n < 4; ++n) // One more than the part's polyphony, so it steals
+                engine.postEvent({0, EventType::NoteOn, 2, (uint8_t)(60 + step % 5 + n * 4), 90, 0.0f});
+            if (step % 3 == 2)
+                engine.postEvent({0, EventType::Controller, 2, 123, 0, 0.0f});
+            engine.postEvent({0, EventType::NoteOn, 3, (uint8_t)(48 + step % 24), 100, 0.0f});
+            engine.postEvent({0, EventType::NoteOff, 3, (uint8_t)(47 + step % 24), 0, 0.0f});
+            if (step == 12)
+                engine.granular.publishSource(grainSource(330.0f));
+            if (step % 5 == 2)
+                engine.publishTuning(new Tuning(step % 10 == 2 ? edo19 : Tuning()));
+            engine.setParam(Param::Pan, (step % 5 - 2) / 2.0f);
+            engine.sampler.spread = (step % 3) / 2.0f;
+            engine.limiter.enabled = step % 9 != 8;
+            if (step % 7 == 3)
+                engine.publishAutomation(new Automation(sweep));
+            engine.playAutomation(step % 5 != 4);
+            ++step;
+        }
+        // Both output layouts, as a host would call them
+        if (step % 2)
+            audioCallback(nullptr, out.data(), frames, nullptr, 0, nullptr);
+        else
+            audioCallbackPlanar(nullptr, planar, frames, nullptr, 0, nullptr);
+        peakGrains = std::max(peakGrains, engine.granular.grains());
+        qualitySteps += drainQualitySteps(false);
+    }
+    engine.stopWorkers();
+    engine.sampler.stop();
+    engine.convolution.stop();
+    setRecording(false, 0.0);
+    std::filesystem::remove(takePath);
+    finishTrace(tracePath);
+    std::filesystem::remove(tracePath);
+    std::vector<LatencyProbe::Measurement> latencies;
+    probe.collect(latencies);
+    std::cout << "Latency probe: " << latencies.size() << " note(s) measured\n";
+    std::cout << "Grains: " << peakGrains << " at most, " << engine.granular.dropped << " dropped\n";
+    std::cout << "Quality: " << engine.quality.degradations << " step(s) down, " << engine.quality.restorations
+              << " up, " << qualitySteps << " logged\n";
+    RealTime::Status audioStatus;
+    if (audioPolicy.applied(audioStatus))
+        std::cout << RealTime::describe("audio callback", audioPolicy.get(), audioStatus) << "\n";
+
+    unsigned long hits = RtCheck::violations();
+    RtCheck::report();
+    std::cout << "Rendered " << end / (float)SAMPLE_RATE << " s in " << frames << "-frame callbacks: "
+              << (hits ? "FAIL" : "OK") << "\n";
+    return hits ? 1 : 0;
+}
+
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+        return runBenchmarks(SAMPLE_RATE);
+    if (argc > 1 && std::string(argv[1]) == "--golden")
+    {
+        // Optional: --golden <min SNR dB> <min SNR dB for square/saw>
+        double minSnrDb = argc > 2 ? std::atof(argv[2]) : 60.0;
+        double edgeSnrDb = argc > 3 ? std::atof(argv[3]) : 30.0;
+        return runGoldenRenders(SAMPLE_RATE, minSnrDb, edgeSnrDb);
+    }
+
+    RenderOptions options; // Paths, output stage and threads; live playback reads them too
+    std::string grainsPath, sclPath, kbmPath, tracePath;
+    double recordPrealloc = 0.0; // Seconds of file space reserved when a recording starts
+    bool planar = false;
+    std::string rtScheduler, audioCpus, workerCpus;
+    int rtPriority = 70, prefaultKb = -1;
+    bool lockMemory = false;
+    bool adaptiveQuality = true; // Live playback only; offline renders always run at full quality
+    float degradeAbove = engine.quality.degradeAbove, restoreBelow = engine.quality.restoreBelow;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--planar") // Non-interleaved output, for hosts that prefer it
+            planar = true;
+        if (std::string(argv[i]) == "--latency") // Measure click- and key-to-sound latency, report on exit
+            probe.enabled = true;
+        if (std::string(argv[i]) == "--mlock") // Keep every page resident, including the engine arena
+            lockMemory = true;
+        if (std::string(argv[i]) == "--fixed-quality") // Never trade fidelity for headroom
+            adaptiveQuality = false;
+        if (std::string(argv[i]) == "--no-limiter") // Master output may pass full scale; no added latency
+            options.limit = false;
+        if (std::string(argv[i]) == "--soft-clip") // Round off peaks ahead of the master limiter, oversampled 2x
+            options.softClip = true;
+    }
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--ir")
+            options.impulsePath = argv[i + 1];
+        else if (arg == "--midi")
+            options.midiPath = argv[i + 1];
+        else if (arg == "--samples")
+            options.samplesPath = argv[i + 1];
+        else if (arg == "--render")
+            options.outPath = argv[i + 1];
+        else if (arg == "--automation")
+            options.automationPath = argv[i + 1];
+        else if (arg == "--record-prealloc")
+            recordPrealloc = std::atof(argv[i + 1]);
+        else if (arg == "--grains")
+            grainsPath = argv[i + 1];
+        else if (arg == "--threads")
+            options.threads = std::atoi(argv[i + 1]);
+        else if (arg == "--scl")
+        {
+            sclPath = argv[i + 1];
+            options.tuning = &keyTuning; // Loaded below, before any render
+        }
+        else if (arg == "--kbm") // Keyboard mapping for the --scl scale
+            kbmPath = argv[i + 1];
+        else if (arg == "--trace") // Chrome trace JSON of callbacks, UI frames and engine stages
+            tracePath = argv[i + 1];
+        else if (arg == "--rt-policy") // fifo or rr, for the audio callback and part workers
+            rtScheduler = argv[i + 1];
+        else if (arg == "--rt-priority")
+            rtPriority = std::atoi(argv[i + 1]);
+        else if (arg == "--audio-cpus") // e.g. 2 or 2,3: cores the audio callback may run on
+            audioCpus = argv[i + 1];
+        else if (arg == "--worker-cpus") // e.g. 4-7: worker i gets one core, round robin
+            workerCpus = argv[i + 1];
+        else if (arg == "--prefault-stack") // KB of stack each configured thread touches up front
+            prefaultKb = std::atoi(argv[i + 1]);
+        else if (arg == "--degrade-above") // Share of the buffer period a render may take before quality drops
+            degradeAbove = (float)std::atof(argv[i + 1]);
+        else if (arg == "--restore-below") // Share it must stay under for quality to come back
+            restoreBelow = (float)std::atof(argv[i + 1]);
+        else if (arg == "--device-rate") // e.g. 48000: the stream runs there, resampled from the engine rate
+            deviceRate = options.outRate = std::atoi(argv[i + 1]);
+    }
+    if (!setThreadPolicies(rtScheduler, rtPriority, audioCpus, workerCpus, prefaultKb))
+        return 1;
+    if (deviceRate != SAMPLE_RATE && !configureDeviceRate(deviceRate))
+        return 1;
+    if (lockMemory)
+    {
+        // The arena is already touched by its constructor, so it is resident from here on
+        std::string report;
+        RealTime::lockMemory(report);
+        std::cout << report << "\n";
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--rt-check")
+            return runRtCheck(options.samplesPath);
+    }
+    if (!sclPath.empty() && !loadTuning(sclPath, kbmPath))
+        return 1;
+    if (!options.outPath.empty())
+    {
+        if (options.midiPath.empty())
+        {
+            std::cerr << "--render needs --midi <file>\n";
+            return 1;
+        }
+        // Offline, this thread stands in for the audio callback
+        if (audioPolicy.get().requested())
+            std::cout << RealTime::describe("render", audioPolicy.get(), RealTime::apply(audioPolicy.get())) << "\n";
+        Trace::nameThread("render");
+        if (!tracePath.empty())
+            Trace::start();
+        int result = renderOffline(options);
+        if (!tracePath.empty())
+            finishTrace(tracePath);
+        return result;
+    }
+
+    Synth &synth = engine.synth;
+    static std::vector<Event> midiEvents; // Must outlive the audio stream
+    if (!options.midiPath.empty())
+    {
+        std::string error;
+        if (MidiFile::load(options.midiPath, SAMPLE_RATE, midiEvents, error))
+        {
+            std::cout << "MIDI: " << midiEvents.size() << " events\n";
+            engine.setTimeline(&midiEvents);
+        }
+        else
+        {
+            std::cerr << "MIDI load failed: " << error << "\n";
+        }
+    }
+
     Envelope env;
     Sequencer seq;
+    loadDemoPattern(seq);
+    engine.publishSequence(seq.compile(SAMPLE_RATE));
+
+    // Knob automation: T records a take of these knobs, L replays the last one
+    const Param automated[] = {Param::Volume, Param::Cutoff, Param::LfoRate, Param::Attack,
+                               Param::Decay, Param::Sustain, Param::Release};
+    Automation take;
+    bool recordingAutomation = false;
+    uint64_t takeStart = 0;
+    std::vector<LatencyProbe::Measurement> latencies;
+    // Computer keys play keyNote on part 0 through the event queue; the arrows move it by semitones.
+    // timestamp is the key event's SDL time, for the latency probe.
+    int keyNote = 69, heldKeyNote = -1;
+    auto playKeyNote = [&](int note, uint32_t timestamp)
+    {
+        if (probe.enabled)
+        {
+            auto handled = LatencyProbe::Clock::now();
+            auto input = handled - std::chrono::milliseconds(SDL_GetTicks() - timestamp);
+            probe.markInput(input, handled, engine.inboxPosted());
+        }
+        engine.postEvent({0, EventType::NoteOn, 0, (uint8_t)note, 100, 0.0f});
+        heldKeyNote = note;
+    };
     // Daha organize layout - label'lar için yer bırakıyoruz
     int margin = 20;
     int topMargin = 40; // Label'lar için üst boşluk
@@ -150,6 +915,14 @@ int main(int argc, char *argv[])
     Slider volumeSlider(margin, topMargin, sliderWidth, sliderHeight, 0, 100, 50, "Volume");
     Slider filterSlider(margin, topMargin + spacing, sliderWidth, sliderHeight, 100, 5000, 1000, "Filter");
     WaveSelector waveSelector(margin + sliderWidth + 20, topMargin, 100, spacing + sliderHeight);
+    Slider unisonSlider(margin, topMargin + spacing * 2, sliderWidth, sliderHeight, 1, Unison::MAX_VOICES, 1, "Unison");
+
+    // Efekt anahtarları - delay, chorus, reverb
+    int fxX = margin + sliderWidth + 20;
+    ToggleButton delayButton(fxX, topMargin + spacing * 2, 30, sliderHeight, {255, 160, 40, 255}, 0);
+    ToggleButton chorusButton(fxX + 35, topMargin + spacing * 2, 30, sliderHeight, {200, 80, 255, 255}, 1);
+    ToggleButton reverbButton(fxX + 70, topMargin + spacing * 2, 30, sliderHeight, {40, 220, 255, 255}, 2);
+    ToggleButton recordButton(fxX, topMargin + spacing * 3, 30, 20, {255, 50, 50, 255}, 3);
 
     // Orta sütun - LFO kontrolleri
     int midCol = WINDOW_WIDTH / 2 - 80;
@@ -165,6 +938,46 @@ int main(int argc, char *argv[])
     Slider sustainSlider(rightCol, topMargin + spacing * 2, sliderWidth, sliderHeight, 0, 100, 80, "Sustain");
     Slider releaseSlider(rightCol, topMargin + spacing * 3, sliderWidth, sliderHeight, 1, 500, 200, "Release");
 
+    engine.prepare(SAMPLE_RATE);
+    engine.quality.enabled = adaptiveQuality;
+    engine.quality.degradeAbove = degradeAbove;
+    engine.quality.restoreBelow = std::min(restoreBelow, degradeAbove);
+    engine.limiter.enabled = options.limit;
+    engine.limiter.softClip = options.softClip;
+    if (options.limit)
+        std::cout << "Limiter: " << engine.limiter.latency() << " frames ("
+                  << 1000.0 * engine.limiter.latency() / SAMPLE_RATE << " ms) latency"
+                  << (options.softClip ? ", soft clip at 2x" : "") << "\n";
+    engine.startWorkers(options.threads);
+    std::cout << "Engine: " << engine.memoryBytes() / 1048576.0 << " MB reserved, " << engine.workers()
+              << " part render thread(s)\n";
+    reportWorkers(engine);
+    engine.convolution.start();
+    if (!options.impulsePath.empty())
+    {
+        // Loaded and transformed on the loader thread; the audio thread picks it up when ready
+        engine.convolution.loadAsync(options.impulsePath);
+        engine.convolution.enabled = true;
+    }
+    if (!grainsPath.empty() && loadGrainSource(grainsPath))
+        engine.granular.part = 0;
+    if (!options.samplesPath.empty())
+    {
+        std::string error;
+        if (engine.sampler.load(options.samplesPath, error))
+        {
+            Sampler::Footprint fp = engine.sampler.footprint();
+            std::cout << "Samples: " << fp.mappedBytes / 1048576.0 << " MB mapped, "
+                      << fp.residentBytes / 1048576.0 << " MB resident, "
+                      << (fp.preloadBytes + fp.ringBytes) / 1048576.0 << " MB preload+rings\n";
+            engine.sampler.start();
+        }
+        else
+        {
+            std::cerr << "Sample load failed: " << error << "\n";
+        }
+    }
+
     PaError err = Pa_Initialize();
     if (err != paNoError)
     {
@@ -175,10 +988,10 @@ int main(int argc, char *argv[])
     PaStream *stream;
     err = Pa_OpenDefaultStream(&stream,
                                0, 2,
-                               paFloat32,
-                               SAMPLE_RATE,
+                               planar ? paFloat32 | paNonInterleaved : paFloat32,
+                               deviceRate,
                                256,
-                               audioCallback,
+                               planar ? audioCallbackPlanar : audioCallback,
                                nullptr);
     if (err != paNoError)
     {
@@ -187,6 +1000,11 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (const PaStreamInfo *info = Pa_GetStreamInfo(stream))
+        probe.outputLatency = info->outputLatency;
+
+    if (!tracePath.empty())
+        Trace::start();
     err = Pa_StartStream(stream);
     if (err != paNoError)
     {
@@ -238,8 +1056,6 @@ int main(int argc, char *argv[])
 
     float displayPhase = 0.0f; // Canlı dalga için faz
     int activeKey = -1;
-    const float noteFreqs[14] = {
-        261.63f, 277.18f, 293.66f, 311.13f, 329.63f, 349.23f, 369.99f, 392.00f, 415.30f, 440.00f, 466.16f, 493.88f, 523.25f, 0.0f};
 
     // Piyano konumu - Alt kısımda, daha büyük
     int pianoX = margin;
@@ -249,9 +1065,22 @@ int main(int argc, char *argv[])
     Piano piano;
 
     std::cout << "Sağ/Sol ok tuşları ile frekansı değiştir. ESC ile çık.\n";
+    std::cout << "Space: sequencer, A: arpeggiator, M: arp mode, Up/Down: arp octaves\n";
+    std::cout << "F: FM on/off, G: FM algorithm, J: grains on/off, K: granulate the last recording\n";
 
+    Trace::nameThread("ui");
+    bool audioReported = !audioPolicy.get().requested();
     while (running)
     {
+        Trace::Zone frame("ui frame");
+        RealTime::Status audioStatus;
+        if (!audioReported && audioPolicy.applied(audioStatus))
+        {
+            std::cout << RealTime::describe("audio callback", audioPolicy.get(), audioStatus) << "\n";
+            audioReported = true;
+        }
+        drainQualitySteps(true);
+        Trace::Zone phase("poll events");
         while (SDL_PollEvent(&event))
         {
             if (event.type == SDL_QUIT)
@@ -264,29 +1093,92 @@ int main(int argc, char *argv[])
                     running = false;
                     break;
                 case SDLK_RIGHT:
-                    synth.baseFrequency += 10.0f;
-                    if (synth.baseFrequency > 2000.0f)
-                        synth.baseFrequency = 2000.0f;
-                    synth.setFrequency(synth.baseFrequency);
-                    std::cout << "Frekans: " << synth.baseFrequency << " Hz\n";
-                    synth.env.noteOn();
-                    break;
                 case SDLK_LEFT:
-                    synth.baseFrequency -= 10.0f;
-                    if (synth.baseFrequency < 100.0f)
-                        synth.baseFrequency = 100.0f;
-                    synth.setFrequency(synth.baseFrequency);
+                    keyNote += event.key.keysym.sym == SDLK_RIGHT ? 1 : -1;
+                    keyNote = std::max(43, std::min(keyNote, 95));
+                    synth.setFrequency(keyTuning.frequency(keyNote)); // Drives the waveform display
                     std::cout << "Frekans: " << synth.baseFrequency << " Hz\n";
-                    synth.env.noteOn();
+                    playKeyNote(keyNote, event.key.timestamp);
+                    break;
+                case SDLK_SPACE:
+                    engine.playSequence(!engine.sequencePlaying());
+                    std::cout << (engine.sequencePlaying() ? "Sequencer: play\n" : "Sequencer: stop\n");
+                    break;
+                case SDLK_r:
+                    recordButton.on = !recordButton.on;
+                    break;
+                case SDLK_t:
+                    recordingAutomation = !recordingAutomation;
+                    if (recordingAutomation)
+                    {
+                        engine.playAutomation(false); // Record what the hands do, not the last take
+                        take.clear();
+                        takeStart = engine.sharedTime();
+                        std::cout << "Automation: recording\n";
+                    }
+                    else
+                    {
+                        std::string error;
+                        if (!take.save("automation.gsa", error))
+                            std::cerr << "Automation save failed: " << error << "\n";
+                        std::cout << "Automation: " << take.points() << " points in " << take.bytes() << " bytes, "
+                                  << take.length() / (float)SAMPLE_RATE << " s -> automation.gsa\n";
+                        engine.publishAutomation(new Automation(take));
+                    }
+                    break;
+                case SDLK_l:
+                    engine.playAutomation(!engine.automationPlaying());
+                    std::cout << (engine.automationPlaying() ? "Automation: replay\n" : "Automation: off\n");
+                    break;
+                case SDLK_f:
+                    synth.fm.enabled = !synth.fm.enabled;
+                    std::cout << "FM: " << (synth.fm.enabled ? FM::ALGORITHM_NAMES[synth.fm.algorithm] : "off") << "\n";
+                    break;
+                case SDLK_g:
+                    synth.fm.algorithm = (synth.fm.algorithm + 1) % FM::NUM_ALGORITHMS;
+                    std::cout << "FM algorithm: " << FM::ALGORITHM_NAMES[synth.fm.algorithm] << "\n";
+                    break;
+                case SDLK_j:
+                    engine.granular.part = engine.granular.part < 0 ? 0 : -1;
+                    std::cout << "Grains: " << (engine.granular.part < 0 ? "off\n" : "on\n");
+                    break;
+                case SDLK_k:
+                    // Granulate the last take
+                    if (recorder.recording())
+                        std::cout << "Grains: stop the recording first\n";
+                    else if (recorder.filePath().empty())
+                        std::cout << "Grains: nothing recorded yet\n";
+                    else if (loadGrainSource(recorder.filePath()))
+                        engine.granular.part = 0;
+                    break;
+                case SDLK_a:
+                    engine.arp.enabled = !engine.arp.enabled;
+                    std::cout << "Arpeggiator: " << (engine.arp.enabled ? "on\n" : "off\n");
+                    break;
+                case SDLK_m:
+                {
+                    const char *modeNames[4] = {"up", "down", "random", "as played"};
+                    int mode = ((int)engine.arp.mode + 1) % 4;
+                    engine.arp.mode = (Arpeggiator::Mode)mode;
+                    std::cout << "Arpeggiator mode: " << modeNames[mode] << "\n";
+                    break;
+                }
+                case SDLK_UP:
+                case SDLK_DOWN:
+                    engine.arp.octaves += event.key.keysym.sym == SDLK_UP ? 1 : -1;
+                    engine.arp.octaves = std::max(1, std::min(engine.arp.octaves, Arpeggiator::MAX_OCTAVES));
+                    std::cout << "Arpeggiator octaves: " << engine.arp.octaves << "\n";
                     break;
                 default:
-                    synth.env.noteOn();
+                    if (!event.key.repeat)
+                        playKeyNote(keyNote, event.key.timestamp);
                     break;
                 }
             }
-            if (event.type == SDL_KEYUP)
+            if (event.type == SDL_KEYUP && heldKeyNote >= 0)
             {
-                synth.env.noteOff();
+                engine.postEvent({0, EventType::NoteOff, 0, (uint8_t)heldKeyNote, 0, 0.0f});
+                heldKeyNote = -1;
             }
             if (event.type == SDL_MOUSEBUTTONDOWN)
             {
@@ -296,11 +1188,28 @@ int main(int argc, char *argv[])
                 if (key != -1)
                 {
                     activeKey = key;
-                    if (noteFreqs[key] > 0.0f)
+                    // The last key slot is not a note; keys the tuning leaves out stay silent
+                    if (key < Piano::NUM_KEYS - 1 && keyTuning.mapped(60 + key))
                     {
-                        synth.setFrequency(noteFreqs[key]);
-                        std::cout << "Nota: " << key << " Frekans: " << synth.baseFrequency << " Hz\n";
-                        synth.env.noteOn();
+                        if (probe.enabled)
+                        {
+                            // SDL stamps events in whole milliseconds on its own tick clock
+                            auto handled = LatencyProbe::Clock::now();
+                            auto input = handled - std::chrono::milliseconds(SDL_GetTicks() - event.button.timestamp);
+                            probe.markInput(input, handled, engine.inboxPosted());
+                        }
+                        // Same event path as the sequencer and MIDI files, so the arpeggiator sees it
+                        engine.postEvent({0, EventType::NoteOn, 0, (uint8_t)(60 + key), 100, 0.0f});
+                        std::cout << "Nota: " << key << " Frekans: " << keyTuning.frequency(60 + key) << " Hz\n";
+                        if (engine.sequencePlaying())
+                        {
+                            // Live step entry: the key replaces the note on the step now playing
+                            int pattern, step;
+                            seq.locate(engine.sequencePosition(), SAMPLE_RATE, pattern, step);
+                            Sequencer::Track &track = seq.patterns[pattern].tracks[0];
+                            track.steps[step % track.length].note = (int8_t)(60 + key);
+                            engine.publishSequence(seq.compile(SAMPLE_RATE));
+                        }
                     }
                 }
                 // UI kontrolleri - sadece ilk bulan handle etsin
@@ -313,6 +1222,21 @@ int main(int argc, char *argv[])
                 else if (waveSelector.handleEvent(event))
                 {
                 }
+                else if (unisonSlider.handleEvent(event))
+                {
+                }
+                else if (delayButton.handleEvent(event))
+                {
+                }
+                else if (chorusButton.handleEvent(event))
+                {
+                }
+                else if (reverbButton.handleEvent(event))
+                {
+                }
+                else if (recordButton.handleEvent(event))
+                {
+                }
                 else if (lfoRateSlider.handleEvent(event))
                 {
                 }
@@ -340,12 +1264,14 @@ int main(int argc, char *argv[])
             }
             if (event.type == SDL_MOUSEBUTTONUP)
             {
+                if (activeKey >= 0)
+                    engine.postEvent({0, EventType::NoteOff, 0, (uint8_t)(60 + activeKey), 0, 0.0f});
                 activeKey = -1;
-                synth.env.noteOff();
 
                 // Tüm slider'ları durdur
                 volumeSlider.dragging = false;
                 filterSlider.dragging = false;
+                unisonSlider.dragging = false;
                 lfoRateSlider.dragging = false;
                 lfoDepthSlider.dragging = false;
                 attackSlider.dragging = false;
@@ -362,6 +1288,9 @@ int main(int argc, char *argv[])
                 else if (filterSlider.handleEvent(event))
                 {
                 }
+                else if (unisonSlider.handleEvent(event))
+                {
+                }
                 else if (lfoRateSlider.handleEvent(event))
                 {
                 }
@@ -384,30 +1313,44 @@ int main(int argc, char *argv[])
         }
 
         // UI değerlerini synth'e aktar
-        synth.amplitude = volumeSlider.value / 100.0f;
+        phase.next("param push");
+        engine.setParam(Param::Volume, volumeSlider.value / 100.0f);
         synth.waveType = waveSelector.currentWave;
+        synth.unison.voices = unisonSlider.value;
+        engine.effects.delay.enabled = delayButton.on;
+        engine.effects.chorus.enabled = chorusButton.on;
+        engine.effects.reverb.enabled = reverbButton.on;
+        if (recordButton.on != recorder.recording())
+            setRecording(recordButton.on, recordPrealloc);
+        recordButton.on = recorder.recording(); // Stays off if the file could not be created
 
         // ADSR envelope parametrelerini güncelle
-        synth.env.attack = attackSlider.value / 1000.0f; // ms to seconds
-        synth.env.decay = decaySlider.value / 1000.0f;
-        synth.env.sustain = sustainSlider.value / 100.0f; // 0-1 range
-        synth.env.release = releaseSlider.value / 1000.0f;
+        engine.setParam(Param::Attack, attackSlider.value / 1000.0f); // ms to seconds
+        engine.setParam(Param::Decay, decaySlider.value / 1000.0f);
+        engine.setParam(Param::Sustain, sustainSlider.value / 100.0f); // 0-1 range
+        engine.setParam(Param::Release, releaseSlider.value / 1000.0f);
 
         // Filter parametrelerini güncelle
-        synth.baseCutoff = filterSlider.value;
-        if (synth.lfo.target != LFOTarget::Filter)
-        {
-            synth.filter.setCutoff(filterSlider.value);
-        }
+        // The engine applies it to the filter, under any sequencer lock
+        engine.setParam(Param::Cutoff, filterSlider.value);
 
         // LFO parametrelerini güncelle
-        synth.lfo.rate = lfoRateSlider.value;
-        synth.lfo.depth = lfoDepthSlider.value / 100.0f;
+        engine.setParam(Param::LfoRate, lfoRateSlider.value);
+        engine.setParam(Param::LfoDepth, lfoDepthSlider.value / 100.0f);
+        if (recordingAutomation)
+        {
+            // Stamped where the engine will apply the change, so replay lands on the same sample
+            uint64_t t = engine.sharedTime() - takeStart;
+            for (Param p : automated)
+                take.record(t, p, (engine.getParam(p) - paramMin[(int)p]) / (paramMax[(int)p] - paramMin[(int)p]));
+        }
+        engine.arp.bpm = seq.bpm; // Arpeggio and sequencer share one tempo
         synth.lfo.waveform = lfoWaveSelector.currentWave;
         synth.lfo.target = lfoTargetSelector.currentTarget;
         synth.lfo.enabled = (synth.lfo.target != LFOTarget::None);
 
         // Futuristic dark gradient background
+        phase.next("draw background");
         for (int y = 0; y < WINDOW_HEIGHT; y++)
         {
             float ratio = (float)y / WINDOW_HEIGHT;
@@ -489,6 +1432,7 @@ int main(int argc, char *argv[])
                            waveBackground.x + waveBackground.w, waveBackground.y + 10);
 
         // Enhanced waveform visualization
+        phase.next("draw widgets");
         WaveForm::draw(renderer, synth.waveType, synth.baseFrequency, displayPhase,
                        waveBackground.x + 8, waveBackground.y + 8,
                        waveBackground.w - 16, waveBackground.h - 16);
@@ -499,6 +1443,8 @@ int main(int argc, char *argv[])
         drawControlLabel(renderer, volumeSlider.x, volumeSlider.y - 25, "VOLUME");
         drawControlLabel(renderer, filterSlider.x, filterSlider.y - 25, "FILTER");
         drawControlLabel(renderer, waveSelector.x, waveSelector.y - 25, "WAVE");
+        drawControlLabel(renderer, unisonSlider.x, unisonSlider.y - 25, "UNISON");
+        drawControlLabel(renderer, delayButton.x, delayButton.y - 25, "FX");
 
         drawControlLabel(renderer, lfoRateSlider.x, lfoRateSlider.y - 25, "LFO RATE");
         drawControlLabel(renderer, lfoDepthSlider.x, lfoDepthSlider.y - 25, "LFO DEPTH");
@@ -514,6 +1460,11 @@ int main(int argc, char *argv[])
         volumeSlider.draw(renderer);
         filterSlider.draw(renderer);
         waveSelector.draw(renderer);
+        unisonSlider.draw(renderer);
+        delayButton.draw(renderer);
+        chorusButton.draw(renderer);
+        reverbButton.draw(renderer);
+        recordButton.draw(renderer);
 
         // LFO kontrollerini çiz
         lfoRateSlider.draw(renderer);
@@ -530,13 +1481,24 @@ int main(int argc, char *argv[])
         // Piyano çiz (altta)
         piano.draw(renderer, pianoX, pianoY, pianoWidth, pianoHeight, activeKey);
 
+        phase.next("present");
         SDL_RenderPresent(renderer);
+        phase.end();
 
         // Dalga animasyonu için fazı güncelle
         displayPhase += TWO_PI * synth.baseFrequency / SAMPLE_RATE * 256;
         if (displayPhase >= TWO_PI)
             displayPhase -= TWO_PI;
 
+        if (probe.enabled)
+        {
+            size_t first = latencies.size();
+            probe.collect(latencies);
+            for (size_t i = first; i < latencies.size(); ++i)
+                std::cout << "Latency: " << latencies[i].totalMs << " ms (queue " << latencies[i].queueMs
+                          << ", dispatch " << latencies[i].dispatchMs << ", output " << latencies[i].outputMs << ")\n";
+        }
+
         SDL_Delay(16); // Yaklaşık 60 FPS
     }
 
@@ -547,6 +1509,24 @@ int main(int argc, char *argv[])
     Pa_StopStream(stream);
     Pa_CloseStream(stream);
     Pa_Terminate();
+    engine.stopWorkers();
+    if (!tracePath.empty())
+        finishTrace(tracePath);
+    if (recorder.recording())
+        setRecording(false, 0.0);
+    if (probe.enabled)
+    {
+        LatencyProbe::report(latencies);
+        std::cout << probe.missed() << " note(s) never became audible\n";
+    }
+    drainQualitySteps(true);
+    if (engine.quality.degradations)
+        std::cout << "Quality: " << engine.quality.degradations << " step(s) down, " << engine.quality.restorations
+                  << " up, " << engine.quality.unlogged << " not logged\n";
+    engine.sampler.stop();
+    engine.convolution.stop();
+    if (RtCheck::violations())
+        RtCheck::report();
 
     return 0;
 }
\ No newline at end of file